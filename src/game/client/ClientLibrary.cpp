@@ -32,6 +32,8 @@
 
 #include "prediction/ClientPredictionSystem.h"
 
+#include "rendering/StudioAnimationCache.h"
+
 #include "sound/ClientSoundReplacementSystem.h"
 #include "sound/IGameSoundSystem.h"
 #include "sound/IMusicSystem.h"
@@ -85,6 +87,8 @@ void ClientLibrary::VidInit()
     g_ClientPrediction.Reset();
 
     CL_TempEntInit();
+
+    R_StudioClearAnimationCache();
 }
 
 void ClientLibrary::PostInitialize()
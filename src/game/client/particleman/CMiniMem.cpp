@@ -13,20 +13,54 @@
  *
  ****/
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
 #include "hud.h"
 #include "particleman.h"
 #include "particleman_internal.h"
 #include "CMiniMem.h"
 
+/**
+ *    @brief Below this many visible particles a comparison sort is faster than a radix sort.
+ */
+constexpr std::size_t RadixSortThreshold = 256;
+
+constexpr int RadixBits = 11;
+constexpr std::uint32_t RadixBuckets = 1 << RadixBits;
+constexpr int RadixPasses = ( 32 + RadixBits - 1 ) / RadixBits;
+
+std::size_t CMiniMem::GetHeaderSize( std::size_t alignment )
+{
+    // Keep the particle aligned by padding the header up to the alignment.
+    return ( sizeof( AllocationHeader ) + alignment - 1 ) & ~( alignment - 1 );
+}
+
+CMiniMem::AllocationHeader* CMiniMem::GetHeader( void* memory )
+{
+    return reinterpret_cast<AllocationHeader*>( reinterpret_cast<std::byte*>( memory ) - sizeof( AllocationHeader ) );
+}
+
 void* CMiniMem::Allocate( std::size_t sizeInBytes, std::size_t alignment )
 {
-    auto particle = reinterpret_cast<CBaseParticle*>( _pool.allocate( sizeInBytes, alignment ) );
+    alignment = std::max( alignment, alignof( AllocationHeader ) );
+
+    const std::size_t headerSize = GetHeaderSize( alignment );
 
-    if( nullptr != particle )
+    auto memory = reinterpret_cast<std::byte*>( _pool.allocate( headerSize + sizeInBytes, alignment ) );
+
+    if( nullptr == memory )
     {
-        _particles.push_back( particle );
+        return nullptr;
     }
 
+    auto particle = reinterpret_cast<CBaseParticle*>( memory + headerSize );
+
+    GetHeader( particle )->Index = _particles.size();
+    _particles.push_back( particle );
+
     return particle;
 }
 
@@ -37,9 +71,19 @@ void CMiniMem::Deallocate( void* memory, std::size_t sizeInBytes, std::size_t al
         return;
     }
 
-    _particles.erase( std::find( _particles.begin(), _particles.end(), memory ) );
+    alignment = std::max( alignment, alignof( AllocationHeader ) );
+
+    // Move the last particle into the removed particle's slot.
+    const std::size_t index = GetHeader( memory )->Index;
+
+    auto last = _particles.back();
+    _particles[index] = last;
+    GetHeader( last )->Index = index;
+    _particles.pop_back();
 
-    _pool.deallocate( memory, sizeInBytes, alignment );
+    const std::size_t headerSize = GetHeaderSize( alignment );
+
+    _pool.deallocate( reinterpret_cast<std::byte*>( memory ) - headerSize, headerSize + sizeInBytes, alignment );
 }
 
 void CMiniMem::Shutdown()
@@ -58,73 +102,143 @@ CMiniMem* CMiniMem::Instance()
     return _instance;
 }
 
-void CMiniMem::ProcessAll()
+void CMiniMem::SortDrawList()
 {
-    const float time = gEngfuncs.GetClientTime();
+    const std::size_t count = _drawList.size();
 
-    // Clear list of visible particles.
-    _visibleParticles = 0;
+    if( count < RadixSortThreshold )
+    {
+        std::sort( _drawList.begin(), _drawList.end(), []( const auto& lhs, const auto& rhs )
+            { return lhs.Key < rhs.Key; } );
+        return;
+    }
 
-    // Divide the particle list in two: the list of visible particles and the list of invisible particles.
-    // Remove any particles that have died.
-    std::size_t invisibleCount = 0;
+    _sortBuffer.resize( count );
 
-    for( std::size_t i = 0; i < ( _particles.size() - invisibleCount ); )
+    auto source = _drawList.data();
+    auto destination = _sortBuffer.data();
+
+    for( int pass = 0; pass < RadixPasses; ++pass )
     {
-        auto effect = _particles[i];
+        const int shift = pass * RadixBits;
 
-        if( !IsGamePaused() )
+        std::uint32_t offsets[RadixBuckets]{};
+
+        for( std::size_t i = 0; i < count; ++i )
         {
-            effect->Think( time );
+            ++offsets[( source[i].Key >> shift ) & ( RadixBuckets - 1 )];
         }
 
-        if( 0 != effect->m_flDieTime && time >= effect->m_flDieTime )
+        // Skip passes where every key has the same digit.
+        if( offsets[( source[0].Key >> shift ) & ( RadixBuckets - 1 )] == count )
         {
-            effect->Die();
-            delete effect;
-
-            // Don't do this! operator delete removes the effect from the list.
-            //_particles.erase(_particles.begin() + i);
             continue;
         }
 
-        if( effect->CheckVisibility() )
-        {
-            auto player = gEngfuncs.GetLocalPlayer();
-            effect->SetPlayerDistance( ( player->origin - effect->m_vOrigin ).LengthSquared() );
+        std::uint32_t total = 0;
 
-            ++_visibleParticles;
+        for( auto& offset : offsets )
+        {
+            const std::uint32_t bucketCount = offset;
+            offset = total;
+            total += bucketCount;
         }
-        else
+
+        for( std::size_t i = 0; i < count; ++i )
         {
-            if( i + invisibleCount < _particles.size() )
-            {
-                // There is an effect we haven't checked yet.
-                // Put the invisible effect at the end of the list and check the other effect next.
-                std::swap( _particles[i], _particles[_particles.size() - 1 - invisibleCount] );
-                ++invisibleCount;
-                continue;
-            }
-            // No more unchecked effects in the list.
+            destination[offsets[( source[i].Key >> shift ) & ( RadixBuckets - 1 )]++] = source[i];
         }
 
-        ++i;
+        std::swap( source, destination );
     }
 
-    std::sort( _particles.begin(), _particles.begin() + _visibleParticles, []( const auto& lhs, const auto& rhs )
+    if( source != _drawList.data() )
+    {
+        std::copy( source, source + count, _drawList.data() );
+    }
+}
+
+void CMiniMem::ProcessAll()
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    const float time = gEngfuncs.GetClientTime();
+
+    const auto thinkStart = Clock::now();
+
+    // Clear list of visible particles.
+    _visibleParticles = 0;
+    _drawList.clear();
+
+    if( !IsGamePaused() )
+    {
+        // Particles created while thinking are added to the end and will think this frame too.
+        for( std::size_t i = 0; i < _particles.size(); ++i )
         {
-            //Particles are ordered farthest to nearest so they can be drawn in order.
-            const float lhsDistance = lhs->GetPlayerDistance();
-            const float rhsDistance = rhs->GetPlayerDistance();
+            _particles[i]->Think( time );
+        }
+    }
+
+    const auto cullStart = Clock::now();
+
+    const std::size_t count = _particles.size();
+
+    _dead.resize( count );
 
-            return lhsDistance > rhsDistance; } );
+    const Vector playerOrigin = gEngfuncs.GetLocalPlayer()->origin;
 
-    for( std::size_t i = 0; i < _visibleParticles; ++i )
+    for( std::size_t i = 0; i < count; ++i )
     {
         auto effect = _particles[i];
-        effect->Draw();
+
+        _dead[i] = ( 0 != effect->m_flDieTime && time >= effect->m_flDieTime ) ? 1 : 0;
+
+        if( 0 != _dead[i] || !effect->CheckVisibility() )
+        {
+            continue;
+        }
+
+        const float distance = ( playerOrigin - effect->m_vOrigin ).LengthSquared();
+
+        effect->SetPlayerDistance( distance );
+
+        // Distances are never negative so the bits sort in the same order as the values.
+        // Invert them so particles are ordered farthest to nearest and can be drawn in order.
+        _drawList.push_back( DrawEntry{~std::bit_cast<std::uint32_t>( distance ), effect} );
+    }
+
+    // Remove particles that have died. Go backwards so particles moved into the freed slots have already been checked.
+    for( std::size_t i = count; i-- > 0; )
+    {
+        if( 0 != _dead[i] )
+        {
+            auto effect = _particles[i];
+            effect->Die();
+            delete effect;
+        }
     }
 
+    _visibleParticles = _drawList.size();
+
+    const auto sortStart = Clock::now();
+
+    SortDrawList();
+
+    const auto drawStart = Clock::now();
+
+    for( const auto& entry : _drawList )
+    {
+        entry.Particle->Draw();
+    }
+
+    const auto drawEnd = Clock::now();
+
+    _stats.Think = Milliseconds( cullStart - thinkStart ).count();
+    _stats.Cull = Milliseconds( sortStart - cullStart ).count();
+    _stats.Sort = Milliseconds( drawStart - sortStart ).count();
+    _stats.Draw = Milliseconds( drawEnd - drawStart ).count();
+
     g_flOldTime = time;
 }
 
@@ -203,16 +317,16 @@ int CMiniMem::ApplyForce( Vector vOrigin, Vector vDirection, float flRadius, flo
 void CMiniMem::Reset()
 {
     _visibleParticles = 0;
+    _drawList.clear();
 
-    for( auto particle : _particles )
+    // operator delete removes the particle from the list.
+    while( !_particles.empty() )
     {
+        auto particle = _particles.back();
         particle->Die();
         delete particle;
     }
 
-    // Cleared by CBaseParticle::operator delete
-    //_particles.clear();
-
     // Wipe away previously allocated memory so maps with loads of particles don't eat up memory forever.
     _pool.release();
     _particles.shrink_to_fit();
@@ -2,6 +2,7 @@
 
 #include "Platform.h"
 
+#include <cstdint>
 #include <memory_resource>
 #include <vector>
 
@@ -9,12 +10,41 @@ class CBaseParticle;
 
 #define TRIANGLE_FPS 30
 
+/**
+ *    @brief Time spent in each stage of the last call to @c CMiniMem::ProcessAll, in milliseconds.
+ */
+struct ParticleFrameStats
+{
+    double Think = 0;
+    double Cull = 0;
+    double Sort = 0;
+    double Draw = 0;
+
+    double Total() const { return Think + Cull + Sort + Draw; }
+};
+
 /**
  *    @brief Simple allocator that uses a chunk-based pool to serve requests.
+ *    @details Live particles are kept in a dense list. Each allocation stores the particle's index in that list
+ *    in front of the particle so it can be removed in constant time by swapping the last particle into its place.
+ *
+ *    The state used to cull and sort particles is copied into separate arrays each frame
+ *    so those passes can run over contiguous memory.
  */
 class CMiniMem
 {
 private:
+    struct AllocationHeader
+    {
+        std::size_t Index;
+    };
+
+    struct DrawEntry
+    {
+        std::uint32_t Key;
+        CBaseParticle* Particle;
+    };
+
     static inline CMiniMem* _instance = nullptr;
 
     std::pmr::unsynchronized_pool_resource _pool;
@@ -22,11 +52,33 @@ private:
     std::vector<CBaseParticle*> _particles;
     std::size_t _visibleParticles = 0;
 
+    // Whether each particle in _particles died this frame. Only valid during ProcessAll.
+    std::vector<std::uint8_t> _dead;
+
+    // Visible particles, sorted farthest to nearest.
+    std::vector<DrawEntry> _drawList;
+    std::vector<DrawEntry> _sortBuffer;
+
+    ParticleFrameStats _stats;
+
 protected:
     // private constructor and destructor.
     CMiniMem() = default;
     ~CMiniMem() = default;
 
+private:
+    static std::size_t GetHeaderSize( std::size_t alignment );
+
+    /**
+     *    @brief Gets the header stored in front of a particle.
+     */
+    static AllocationHeader* GetHeader( void* memory );
+
+    /**
+     *    @brief Sorts @c _drawList by key using a radix sort.
+     */
+    void SortDrawList();
+
 public:
     void* Allocate( std::size_t sizeInBytes, std::size_t alignment = alignof( std::max_align_t ) );
 
@@ -44,4 +96,6 @@ public:
 
     std::size_t GetTotalParticles() { return _particles.size(); }
     std::size_t GetDrawnParticles() { return _visibleParticles; }
+
+    const ParticleFrameStats& GetFrameStats() const { return _stats; }
 };
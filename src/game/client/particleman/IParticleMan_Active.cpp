@@ -13,6 +13,7 @@
  *
  ****/
 
+#include <algorithm>
 #include <vector>
 
 #include "hud.h"
@@ -28,6 +29,92 @@ static cvar_t* cl_pmanstats = nullptr;
 
 static std::vector<ForceMember> g_pForceList;
 
+/**
+ *    @brief Accumulates frame times while a stress test started by @c pman_stress is running.
+ */
+struct ParticleStressTest
+{
+    bool Active = false;
+    int ParticleCount = 0;
+    float EndTime = 0;
+    int Frames = 0;
+    ParticleFrameStats Totals;
+};
+
+static ParticleStressTest g_StressTest;
+
+static void ParticleStress()
+{
+    const int count = gEngfuncs.Cmd_Argc() > 1 ? std::max( 1, atoi( gEngfuncs.Cmd_Argv( 1 ) ) ) : 1000;
+    const float duration = gEngfuncs.Cmd_Argc() > 2 ? std::max( 0.1f, static_cast<float>( atof( gEngfuncs.Cmd_Argv( 2 ) ) ) ) : 5.f;
+
+    auto player = gEngfuncs.GetLocalPlayer();
+
+    if( !g_pParticleMan || !player )
+    {
+        gEngfuncs.Con_Printf( "pman_stress: must be in a map\n" );
+        return;
+    }
+
+    auto sprite = const_cast<model_t*>( gEngfuncs.GetSpritePointer( gEngfuncs.pfnSPR_Load( "sprites/steam1.spr" ) ) );
+
+    if( !sprite )
+    {
+        gEngfuncs.Con_Printf( "pman_stress: couldn't load sprite\n" );
+        return;
+    }
+
+    const float time = gEngfuncs.GetClientTime();
+    const Vector origin = player->origin + Vector{0, 0, 64};
+
+    for( int i = 0; i < count; ++i )
+    {
+        auto particle = g_pParticleMan->CreateParticle( origin, g_vecZero, sprite, 4, 255, "pman_stress" );
+
+        const Vector direction{gEngfuncs.pfnRandomFloat( -1, 1 ), gEngfuncs.pfnRandomFloat( -1, 1 ), gEngfuncs.pfnRandomFloat( 0, 1 )};
+
+        particle->m_vVelocity = direction.Normalize() * gEngfuncs.pfnRandomFloat( 50, 300 );
+        particle->m_flGravity = 0.5f;
+        particle->m_flDieTime = time + duration;
+        particle->m_iRendermode = kRenderTransAdd;
+        particle->SetLightFlag( LIGHT_NONE );
+        particle->SetCullFlag( CULL_FRUSTUM_SPHERE | CULL_PVS );
+        particle->SetRenderFlag( RENDER_FACEPLAYER );
+    }
+
+    g_StressTest = {.Active = true, .ParticleCount = count, .EndTime = time + duration};
+
+    gEngfuncs.Con_Printf( "pman_stress: spawned %d particles for %.1f seconds\n", count, duration );
+}
+
+static void UpdateStressTest( const ParticleFrameStats& stats )
+{
+    if( !g_StressTest.Active )
+    {
+        return;
+    }
+
+    ++g_StressTest.Frames;
+    g_StressTest.Totals.Think += stats.Think;
+    g_StressTest.Totals.Cull += stats.Cull;
+    g_StressTest.Totals.Sort += stats.Sort;
+    g_StressTest.Totals.Draw += stats.Draw;
+
+    if( gEngfuncs.GetClientTime() < g_StressTest.EndTime )
+    {
+        return;
+    }
+
+    g_StressTest.Active = false;
+
+    const double frames = g_StressTest.Frames;
+    const auto& totals = g_StressTest.Totals;
+
+    gEngfuncs.Con_Printf( "pman_stress: %d particles, %d frames: %.3f ms/frame (think %.3f, cull %.3f, sort %.3f, draw %.3f)\n",
+        g_StressTest.ParticleCount, g_StressTest.Frames, totals.Total() / frames,
+        totals.Think / frames, totals.Cull / frames, totals.Sort / frames, totals.Draw / frames );
+}
+
 EXPOSE_INTERFACE( IParticleMan_Active, IParticleMan, PARTICLEMAN_INTERFACE );
 
 IParticleMan_Active::IParticleMan_Active()
@@ -64,6 +151,8 @@ void IParticleMan_Active::SetUp( cl_enginefunc_t* pEnginefuncs )
     // std::memcpy(&gEngfuncs, pEnginefuncs, sizeof(gEngfuncs));
 
     cl_pmanstats = gEngfuncs.pfnRegisterVariable( "cl_pmanstats", "0", 0 );
+
+    gEngfuncs.pfnAddCommand( "pman_stress", ParticleStress );
 }
 
 CBaseParticle* IParticleMan_Active::CreateParticle( Vector org, Vector normal, model_t* sprite, float size, float brightness, const char* classname )
@@ -81,6 +170,7 @@ void IParticleMan_Active::ResetParticles()
 {
     CMiniMem::Instance()->Reset();
     g_pForceList.clear();
+    g_StressTest.Active = false;
 }
 
 void IParticleMan_Active::SetVariables( float flGravity, Vector vViewAngles )
@@ -128,10 +218,13 @@ void IParticleMan_Active::Update()
 
     memory->ProcessAll();
 
+    UpdateStressTest( memory->GetFrameStats() );
+
     if( nullptr != cl_pmanstats && cl_pmanstats->value == 1 )
     {
         // TODO: engine doesn't support printing size_t, use local printf
         gEngfuncs.Con_NPrintf( 15, "Number of Particles: %d", static_cast<int>( CMiniMem::Instance()->GetTotalParticles() ) );
         gEngfuncs.Con_NPrintf( 16, "Particles Drawn: %d", static_cast<int>( CMiniMem::Instance()->GetDrawnParticles() ) );
+        gEngfuncs.Con_NPrintf( 17, "Particle Time: %.3f ms", memory->GetFrameStats().Total() );
     }
 }
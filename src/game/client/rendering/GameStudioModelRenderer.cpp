@@ -16,6 +16,7 @@
 
 #include "r_studioint.h"
 
+#include "StudioBoneSetup.h"
 #include "StudioModelRenderer.h"
 #include "GameStudioModelRenderer.h"
 #include "Exports.h"
@@ -75,6 +76,23 @@ R_StudioInit
 void R_StudioInit()
 {
     g_StudioRenderer.Init();
+
+    gEngfuncs.pfnAddCommand( "r_studio_anim_cache_stats", []()
+        {
+            const auto& stats = g_StudioRenderer.m_AnimationCache.GetStats();
+
+            Con_Printf( "%zu animations decoded using %.2f MB\n", stats.AnimationCount, stats.Bytes / ( 1024.0 * 1024.0 ) );
+            Con_Printf( "%llu hits, %llu misses, %llu evictions\n",
+                static_cast<unsigned long long>( stats.Hits ), static_cast<unsigned long long>( stats.Misses ),
+                static_cast<unsigned long long>( stats.Evictions ) ); } );
+
+    gEngfuncs.pfnAddCommand( "r_studio_bone_benchmark", []()
+        { StudioBenchmarkBoneSetup( gEngfuncs.Cmd_Argc() > 1 ? atoi( gEngfuncs.Cmd_Argv( 1 ) ) : 10000 ); } );
+}
+
+void R_StudioClearAnimationCache()
+{
+    g_StudioRenderer.m_AnimationCache.Clear();
 }
 
 // The simple drawing interface we'll pass back to the engine
@@ -0,0 +1,250 @@
+//========= Copyright © 1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <algorithm>
+#include <cstring>
+
+#include "hud.h"
+#include "StudioAnimationCache.h"
+
+/**
+ *    @brief Finds the span of values containing @p frame.
+ *    @param[in,out] k The frame to find. Set to the offset of the frame in the span.
+ */
+static const mstudioanimvalue_t* FindAnimValueSpan( const mstudioanimvalue_t* panimvalue, int& k )
+{
+    // DEBUG
+    if( panimvalue->num.total < panimvalue->num.valid )
+        k = 0;
+
+    while( panimvalue->num.total <= k )
+    {
+        k -= panimvalue->num.total;
+        panimvalue += panimvalue->num.valid + 1;
+        // DEBUG
+        if( panimvalue->num.total < panimvalue->num.valid )
+            k = 0;
+    }
+
+    return panimvalue;
+}
+
+void StudioDecodeRotationValues( const mstudioanimvalue_t* panimvalue, int frame, short& value1, short& value2 )
+{
+    int k = frame;
+
+    panimvalue = FindAnimValueSpan( panimvalue, k );
+
+    // Bah, missing blend!
+    if( panimvalue->num.valid > k )
+    {
+        value1 = panimvalue[k + 1].value;
+
+        if( panimvalue->num.valid > k + 1 )
+        {
+            value2 = panimvalue[k + 2].value;
+        }
+        else
+        {
+            if( panimvalue->num.total > k + 1 )
+                value2 = value1;
+            else
+                value2 = panimvalue[panimvalue->num.valid + 2].value;
+        }
+    }
+    else
+    {
+        value1 = panimvalue[panimvalue->num.valid].value;
+
+        if( panimvalue->num.total > k + 1 )
+        {
+            value2 = value1;
+        }
+        else
+        {
+            value2 = panimvalue[panimvalue->num.valid + 2].value;
+        }
+    }
+}
+
+bool StudioDecodePositionValues( const mstudioanimvalue_t* panimvalue, int frame, short& value1, short& value2 )
+{
+    int k = frame;
+
+    // find span of values that includes the frame we want
+    panimvalue = FindAnimValueSpan( panimvalue, k );
+
+    // if we're inside the span
+    if( panimvalue->num.valid > k )
+    {
+        value1 = panimvalue[k + 1].value;
+
+        // and there's more data in the span
+        if( panimvalue->num.valid > k + 1 )
+        {
+            value2 = panimvalue[k + 2].value;
+            return true;
+        }
+    }
+    else
+    {
+        value1 = panimvalue[panimvalue->num.valid].value;
+
+        // are we at the end of the repeating values section and there's another section with data?
+        if( panimvalue->num.total <= k + 1 )
+        {
+            value2 = panimvalue[panimvalue->num.valid + 2].value;
+            return true;
+        }
+    }
+
+    value2 = value1;
+    return false;
+}
+
+const DecodedBoneFrame* StudioAnimationCache::Get( const studiohdr_t* header, const mstudioseqdesc_t* pseqdesc, const mstudioanim_t* panim )
+{
+    if( m_Budget == 0 || pseqdesc->seqgroup != 0 || pseqdesc->numframes <= 0 )
+    {
+        return nullptr;
+    }
+
+    const int numFrames = pseqdesc->numframes;
+    const int numBones = header->numbones;
+
+    if( auto it = m_Animations.find( panim ); it != m_Animations.end() )
+    {
+        auto& animation = it->second;
+
+        if( IsSameModel( animation, header ) && animation.NumFrames == numFrames && animation.NumBones == numBones )
+        {
+            ++m_Stats.Hits;
+            animation.LastUsed = ++m_UseCounter;
+            return animation.Frames.data();
+        }
+
+        // A different model was loaded at the same address.
+        m_Stats.Bytes -= GetAnimationSize( animation.NumFrames, animation.NumBones );
+        m_Animations.erase( it );
+    }
+
+    ++m_Stats.Misses;
+
+    const std::size_t size = GetAnimationSize( numFrames, numBones );
+
+    if( size > m_Budget )
+    {
+        return nullptr;
+    }
+
+    EvictUntilFits( size );
+
+    auto& animation = m_Animations[panim];
+
+    animation.Header = header;
+    animation.HeaderLength = header->length;
+    std::memcpy( animation.ModelName, header->name, sizeof( animation.ModelName ) );
+    animation.NumFrames = numFrames;
+    animation.NumBones = numBones;
+    animation.LastUsed = ++m_UseCounter;
+
+    Decode( animation, panim );
+
+    m_Stats.Bytes += size;
+    m_Stats.AnimationCount = m_Animations.size();
+
+    return animation.Frames.data();
+}
+
+void StudioAnimationCache::SetBudget( std::size_t bytes )
+{
+    if( m_Budget == bytes )
+    {
+        return;
+    }
+
+    m_Budget = bytes;
+
+    if( m_Budget == 0 )
+    {
+        Clear();
+        return;
+    }
+
+    EvictUntilFits( 0 );
+}
+
+void StudioAnimationCache::Clear()
+{
+    m_Animations.clear();
+    m_Stats.AnimationCount = 0;
+    m_Stats.Bytes = 0;
+}
+
+std::size_t StudioAnimationCache::GetAnimationSize( int numFrames, int numBones )
+{
+    return static_cast<std::size_t>( numFrames ) * numBones * sizeof( DecodedBoneFrame );
+}
+
+bool StudioAnimationCache::IsSameModel( const Animation& animation, const studiohdr_t* header )
+{
+    return animation.Header == header
+        && animation.HeaderLength == header->length
+        && std::memcmp( animation.ModelName, header->name, sizeof( animation.ModelName ) ) == 0;
+}
+
+void StudioAnimationCache::Decode( Animation& animation, const mstudioanim_t* panim )
+{
+    animation.Frames.resize( static_cast<std::size_t>( animation.NumFrames ) * animation.NumBones );
+
+    for( int bone = 0; bone < animation.NumBones; ++bone )
+    {
+        const auto& anim = panim[bone];
+
+        for( int frame = 0; frame < animation.NumFrames; ++frame )
+        {
+            auto& decoded = animation.Frames[static_cast<std::size_t>( frame ) * animation.NumBones + bone];
+
+            decoded = {};
+
+            for( int j = 0; j < 3; ++j )
+            {
+                if( anim.offset[j + 3] != 0 )
+                {
+                    auto panimvalue = reinterpret_cast<const mstudioanimvalue_t*>( reinterpret_cast<const byte*>( &anim ) + anim.offset[j + 3] );
+                    StudioDecodeRotationValues( panimvalue, frame, decoded.Rotation[j][0], decoded.Rotation[j][1] );
+                }
+
+                if( anim.offset[j] != 0 )
+                {
+                    auto panimvalue = reinterpret_cast<const mstudioanimvalue_t*>( reinterpret_cast<const byte*>( &anim ) + anim.offset[j] );
+
+                    if( StudioDecodePositionValues( panimvalue, frame, decoded.Position[j][0], decoded.Position[j][1] ) )
+                    {
+                        decoded.PositionBlend |= 1 << j;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void StudioAnimationCache::EvictUntilFits( std::size_t additionalBytes )
+{
+    while( !m_Animations.empty() && m_Stats.Bytes + additionalBytes > m_Budget )
+    {
+        auto oldest = std::min_element( m_Animations.begin(), m_Animations.end(), []( const auto& lhs, const auto& rhs )
+            { return lhs.second.LastUsed < rhs.second.LastUsed; } );
+
+        m_Stats.Bytes -= GetAnimationSize( oldest->second.NumFrames, oldest->second.NumBones );
+        ++m_Stats.Evictions;
+
+        m_Animations.erase( oldest );
+    }
+
+    m_Stats.AnimationCount = m_Animations.size();
+}
@@ -0,0 +1,113 @@
+//========= Copyright © 1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "studio.h"
+
+/**
+ *    @brief Animation values for one bone in one frame, as read from the compressed animation data.
+ *    @details Values are stored as-is so bone setup produces the same results as decoding the animation directly.
+ */
+struct DecodedBoneFrame
+{
+    short Rotation[3][2];
+    short Position[3][2];
+
+    // Bit n is set if position channel n blends between its two values.
+    std::uint8_t PositionBlend;
+};
+
+/**
+ *    @brief Finds the rotation values for @p frame in a compressed animation value stream.
+ */
+void StudioDecodeRotationValues( const mstudioanimvalue_t* panimvalue, int frame, short& value1, short& value2 );
+
+/**
+ *    @brief Finds the position values for @p frame in a compressed animation value stream.
+ *    @return Whether the position blends between the two values.
+ */
+bool StudioDecodePositionValues( const mstudioanimvalue_t* panimvalue, int frame, short& value1, short& value2 );
+
+/**
+ *    @brief Decodes whole animations on first use so bone setup can look up each frame directly.
+ *    @details Only animations stored in the model itself are cached. Animations in sequence group files
+ *    can be evicted by the engine at any time.
+ *    Least recently used animations are evicted to stay within the memory budget.
+ */
+class StudioAnimationCache final
+{
+public:
+    struct Stats
+    {
+        std::size_t AnimationCount = 0;
+        std::size_t Bytes = 0;
+        std::uint64_t Hits = 0;
+        std::uint64_t Misses = 0;
+        std::uint64_t Evictions = 0;
+    };
+
+    /**
+     *    @brief Gets the decoded frames for an animation, decoding it if needed.
+     *    @param panim The animation data for the first bone.
+     *    @return Frames indexed by <tt>frame * numbones + bone</tt>, or @c nullptr if the animation can't be cached.
+     */
+    const DecodedBoneFrame* Get( const studiohdr_t* header, const mstudioseqdesc_t* pseqdesc, const mstudioanim_t* panim );
+
+    /**
+     *    @brief Sets the memory budget. Animations are evicted immediately if the cache is over the new budget.
+     */
+    void SetBudget( std::size_t bytes );
+
+    /**
+     *    @brief Must be called whenever models are unloaded since animations are looked up by address.
+     */
+    void Clear();
+
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    struct Animation
+    {
+        // Model headers can be freed and another model loaded at the same address mid-map,
+        // so the header an animation was decoded from is checked on every lookup.
+        const studiohdr_t* Header = nullptr;
+        int HeaderLength = 0;
+        char ModelName[sizeof( studiohdr_t::name )]{};
+
+        int NumFrames = 0;
+        int NumBones = 0;
+        std::vector<DecodedBoneFrame> Frames;
+        std::uint64_t LastUsed = 0;
+    };
+
+    static std::size_t GetAnimationSize( int numFrames, int numBones );
+
+    static bool IsSameModel( const Animation& animation, const studiohdr_t* header );
+
+    static void Decode( Animation& animation, const mstudioanim_t* panim );
+
+    void EvictUntilFits( std::size_t additionalBytes );
+
+private:
+    std::unordered_map<const mstudioanim_t*, Animation> m_Animations;
+
+    std::size_t m_Budget = 0;
+    std::uint64_t m_UseCounter = 0;
+
+    Stats m_Stats;
+};
+
+/**
+ *    @brief Clears the studio renderer's animation cache. Called when models may have been unloaded.
+ */
+void R_StudioClearAnimationCache();
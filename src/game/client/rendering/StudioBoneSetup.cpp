@@ -0,0 +1,460 @@
+//========= Copyright © 1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "hud.h"
+#include "com_model.h"
+#include "studio.h"
+#include "r_studioint.h"
+
+#include "StudioAnimationCache.h"
+#include "StudioBoneSetup.h"
+
+#if STUDIO_BONES_SSE2
+#include <emmintrin.h>
+#endif
+
+extern engine_studio_api_t IEngineStudio;
+
+void StudioSlerpBonesScalar( vec4_t q1[], float pos1[][3], const vec4_t q2[], const float pos2[][3], float s, int numBones )
+{
+    const float s1 = 1.0 - s;
+
+    for( int i = 0; i < numBones; i++ )
+    {
+        // QuaternionSlerp can flip the sign of its second argument.
+        vec4_t q3;
+        vec4_t q4 = {q2[i][0], q2[i][1], q2[i][2], q2[i][3]};
+
+        QuaternionSlerp( q1[i], q4, s, q3 );
+        q1[i][0] = q3[0];
+        q1[i][1] = q3[1];
+        q1[i][2] = q3[2];
+        q1[i][3] = q3[3];
+        pos1[i][0] = pos1[i][0] * s1 + pos2[i][0] * s;
+        pos1[i][1] = pos1[i][1] * s1 + pos2[i][1] * s;
+        pos1[i][2] = pos1[i][2] * s1 + pos2[i][2] * s;
+    }
+}
+
+void StudioBoneMatricesScalar( const vec4_t q[], const float pos[][3], float matrices[][3][4], int numBones )
+{
+    for( int i = 0; i < numBones; i++ )
+    {
+        vec4_t quaternion = {q[i][0], q[i][1], q[i][2], q[i][3]};
+
+        QuaternionMatrix( quaternion, matrices[i] );
+
+        matrices[i][0][3] = pos[i][0];
+        matrices[i][1][3] = pos[i][1];
+        matrices[i][2][3] = pos[i][2];
+    }
+}
+
+#if STUDIO_BONES_SSE2
+
+void StudioSlerpBonesBatched( vec4_t q1[], float pos1[][3], const vec4_t q2[], const float pos2[][3], float s, int numBones )
+{
+    const float s1 = 1.0 - s;
+
+    const __m128 signMask = _mm_set1_ps( -0.0f );
+    const __m128 vs = _mm_set1_ps( s );
+    const __m128 vs1 = _mm_set1_ps( s1 );
+
+    int i = 0;
+
+    for( ; i + 4 <= numBones; i += 4 )
+    {
+        // Transpose so each register holds one component of 4 bones.
+        __m128 px = _mm_loadu_ps( q1[i] );
+        __m128 py = _mm_loadu_ps( q1[i + 1] );
+        __m128 pz = _mm_loadu_ps( q1[i + 2] );
+        __m128 pw = _mm_loadu_ps( q1[i + 3] );
+        _MM_TRANSPOSE4_PS( px, py, pz, pw );
+
+        __m128 qx = _mm_loadu_ps( q2[i] );
+        __m128 qy = _mm_loadu_ps( q2[i + 1] );
+        __m128 qz = _mm_loadu_ps( q2[i + 2] );
+        __m128 qw = _mm_loadu_ps( q2[i + 3] );
+        _MM_TRANSPOSE4_PS( qx, qy, qz, qw );
+
+        // decide if one of the quaternions is backwards
+        const auto diffSquared = []( __m128 a, __m128 b )
+        {
+            const __m128 d = _mm_sub_ps( a, b );
+            return _mm_mul_ps( d, d );
+        };
+
+        const auto sumSquared = []( __m128 a, __m128 b )
+        {
+            const __m128 d = _mm_add_ps( a, b );
+            return _mm_mul_ps( d, d );
+        };
+
+        const __m128 a = _mm_add_ps( _mm_add_ps( diffSquared( px, qx ), diffSquared( py, qy ) ), _mm_add_ps( diffSquared( pz, qz ), diffSquared( pw, qw ) ) );
+        const __m128 b = _mm_add_ps( _mm_add_ps( sumSquared( px, qx ), sumSquared( py, qy ) ), _mm_add_ps( sumSquared( pz, qz ), sumSquared( pw, qw ) ) );
+        const __m128 flip = _mm_and_ps( _mm_cmpgt_ps( a, b ), signMask );
+
+        qx = _mm_xor_ps( qx, flip );
+        qy = _mm_xor_ps( qy, flip );
+        qz = _mm_xor_ps( qz, flip );
+        qw = _mm_xor_ps( qw, flip );
+
+        const __m128 cosom = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, qx ), _mm_mul_ps( py, qy ) ), _mm_add_ps( _mm_mul_ps( pz, qz ), _mm_mul_ps( pw, qw ) ) );
+
+        alignas( 16 ) float cosoms[4];
+        alignas( 16 ) float sclp[4];
+        alignas( 16 ) float sclq[4];
+        bool opposite[4];
+
+        _mm_store_ps( cosoms, cosom );
+
+        // There's no vector acos or sin, so compute the scales per bone.
+        for( int lane = 0; lane < 4; ++lane )
+        {
+            const float c = cosoms[lane];
+
+            opposite[lane] = ( 1.0 + c ) <= 0.000001;
+
+            if( opposite[lane] )
+            {
+                sclp[lane] = sclq[lane] = 0;
+            }
+            else if( ( 1.0 - c ) > 0.000001 )
+            {
+                const float omega = acos( c );
+                const float sinom = sin( omega );
+                sclp[lane] = sin( ( 1.0 - s ) * omega ) / sinom;
+                sclq[lane] = sin( s * omega ) / sinom;
+            }
+            else
+            {
+                sclp[lane] = 1.0 - s;
+                sclq[lane] = s;
+            }
+        }
+
+        const __m128 vp = _mm_load_ps( sclp );
+        const __m128 vq = _mm_load_ps( sclq );
+
+        __m128 rx = _mm_add_ps( _mm_mul_ps( vp, px ), _mm_mul_ps( vq, qx ) );
+        __m128 ry = _mm_add_ps( _mm_mul_ps( vp, py ), _mm_mul_ps( vq, qy ) );
+        __m128 rz = _mm_add_ps( _mm_mul_ps( vp, pz ), _mm_mul_ps( vq, qz ) );
+        __m128 rw = _mm_add_ps( _mm_mul_ps( vp, pw ), _mm_mul_ps( vq, qw ) );
+        _MM_TRANSPOSE4_PS( rx, ry, rz, rw );
+
+        const __m128 results[4] = {rx, ry, rz, rw};
+
+        for( int lane = 0; lane < 4; ++lane )
+        {
+            if( opposite[lane] )
+            {
+                // Rare enough to leave to the scalar version.
+                StudioSlerpBonesScalar( q1 + i + lane, pos1 + i + lane, q2 + i + lane, pos2 + i + lane, s, 1 );
+            }
+            else
+            {
+                _mm_storeu_ps( q1[i + lane], results[lane] );
+            }
+        }
+
+        // Positions of 4 bones are 12 contiguous floats. Opposite lanes were already blended above.
+        float* out = pos1[i];
+        const float* in = pos2[i];
+
+        alignas( 16 ) float blended[12];
+
+        for( int j = 0; j < 12; j += 4 )
+        {
+            _mm_store_ps( blended + j, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( out + j ), vs1 ), _mm_mul_ps( _mm_loadu_ps( in + j ), vs ) ) );
+        }
+
+        for( int lane = 0; lane < 4; ++lane )
+        {
+            if( !opposite[lane] )
+            {
+                std::memcpy( out + lane * 3, blended + lane * 3, sizeof( float ) * 3 );
+            }
+        }
+    }
+
+    StudioSlerpBonesScalar( q1 + i, pos1 + i, q2 + i, pos2 + i, s, numBones - i );
+}
+
+void StudioBoneMatricesBatched( const vec4_t q[], const float pos[][3], float matrices[][3][4], int numBones )
+{
+    const __m128 one = _mm_set1_ps( 1.f );
+    const __m128 two = _mm_set1_ps( 2.f );
+
+    int i = 0;
+
+    for( ; i + 4 <= numBones; i += 4 )
+    {
+        __m128 x = _mm_loadu_ps( q[i] );
+        __m128 y = _mm_loadu_ps( q[i + 1] );
+        __m128 z = _mm_loadu_ps( q[i + 2] );
+        __m128 w = _mm_loadu_ps( q[i + 3] );
+        _MM_TRANSPOSE4_PS( x, y, z, w );
+
+        const __m128 x2 = _mm_mul_ps( two, x );
+        const __m128 y2 = _mm_mul_ps( two, y );
+        const __m128 z2 = _mm_mul_ps( two, z );
+
+        const __m128 xx = _mm_mul_ps( x2, x );
+        const __m128 yy = _mm_mul_ps( y2, y );
+        const __m128 zz = _mm_mul_ps( z2, z );
+        const __m128 xy = _mm_mul_ps( x2, y );
+        const __m128 xz = _mm_mul_ps( x2, z );
+        const __m128 yz = _mm_mul_ps( y2, z );
+        const __m128 wx = _mm_mul_ps( x2, w );
+        const __m128 wy = _mm_mul_ps( y2, w );
+        const __m128 wz = _mm_mul_ps( z2, w );
+
+        // Each register holds one matrix element of 4 bones. Transposing a row of elements
+        // together with the positions produces the matching row of each bone's matrix.
+        __m128 m00 = _mm_sub_ps( _mm_sub_ps( one, yy ), zz );
+        __m128 m01 = _mm_sub_ps( xy, wz );
+        __m128 m02 = _mm_add_ps( xz, wy );
+        __m128 m03 = _mm_setr_ps( pos[i][0], pos[i + 1][0], pos[i + 2][0], pos[i + 3][0] );
+
+        __m128 m10 = _mm_add_ps( xy, wz );
+        __m128 m11 = _mm_sub_ps( _mm_sub_ps( one, xx ), zz );
+        __m128 m12 = _mm_sub_ps( yz, wx );
+        __m128 m13 = _mm_setr_ps( pos[i][1], pos[i + 1][1], pos[i + 2][1], pos[i + 3][1] );
+
+        __m128 m20 = _mm_sub_ps( xz, wy );
+        __m128 m21 = _mm_add_ps( yz, wx );
+        __m128 m22 = _mm_sub_ps( _mm_sub_ps( one, xx ), yy );
+        __m128 m23 = _mm_setr_ps( pos[i][2], pos[i + 1][2], pos[i + 2][2], pos[i + 3][2] );
+
+        _MM_TRANSPOSE4_PS( m00, m01, m02, m03 );
+        _MM_TRANSPOSE4_PS( m10, m11, m12, m13 );
+        _MM_TRANSPOSE4_PS( m20, m21, m22, m23 );
+
+        const __m128 rows[3][4] = {{m00, m01, m02, m03}, {m10, m11, m12, m13}, {m20, m21, m22, m23}};
+
+        for( int lane = 0; lane < 4; ++lane )
+        {
+            for( int row = 0; row < 3; ++row )
+            {
+                _mm_storeu_ps( matrices[i + lane][row], rows[row][lane] );
+            }
+        }
+    }
+
+    StudioBoneMatricesScalar( q + i, pos + i, matrices + i, numBones - i );
+}
+
+void StudioConcatTransforms( const float in1[3][4], const float in2[3][4], float out[3][4] )
+{
+    const __m128 row0 = _mm_loadu_ps( in2[0] );
+    const __m128 row1 = _mm_loadu_ps( in2[1] );
+    const __m128 row2 = _mm_loadu_ps( in2[2] );
+
+    // Picks up the translation of in1.
+    const __m128 translation = _mm_setr_ps( 0, 0, 0, 1 );
+
+    for( int i = 0; i < 3; ++i )
+    {
+        const __m128 result = _mm_add_ps(
+            _mm_add_ps( _mm_mul_ps( _mm_set1_ps( in1[i][0] ), row0 ), _mm_mul_ps( _mm_set1_ps( in1[i][1] ), row1 ) ),
+            _mm_add_ps( _mm_mul_ps( _mm_set1_ps( in1[i][2] ), row2 ), _mm_mul_ps( _mm_set1_ps( in1[i][3] ), translation ) ) );
+
+        _mm_storeu_ps( out[i], result );
+    }
+}
+
+#else
+
+void StudioSlerpBonesBatched( vec4_t q1[], float pos1[][3], const vec4_t q2[], const float pos2[][3], float s, int numBones )
+{
+    StudioSlerpBonesScalar( q1, pos1, q2, pos2, s, numBones );
+}
+
+void StudioBoneMatricesBatched( const vec4_t q[], const float pos[][3], float matrices[][3][4], int numBones )
+{
+    StudioBoneMatricesScalar( q, pos, matrices, numBones );
+}
+
+void StudioConcatTransforms( const float in1[3][4], const float in2[3][4], float out[3][4] )
+{
+    ConcatTransforms( const_cast<float( * )[4]>( in1 ), const_cast<float( * )[4]>( in2 ), out );
+}
+
+#endif
+
+namespace
+{
+struct BenchmarkPose
+{
+    vec4_t Q[MAXSTUDIOBONES];
+    float Pos[MAXSTUDIOBONES][3];
+};
+
+struct BenchmarkResult
+{
+    float Transforms[MAXSTUDIOBONES][3][4];
+};
+}
+
+/**
+ *    @brief Decodes the first frame of @p sequence. Uses the default pose if the animation is stored in a sequence group file.
+ */
+static void StudioDecodeBenchmarkPose( studiohdr_t* header, int sequence, BenchmarkPose& pose )
+{
+    const auto pbones = reinterpret_cast<mstudiobone_t*>( reinterpret_cast<byte*>( header ) + header->boneindex );
+    const auto pseqdesc = reinterpret_cast<mstudioseqdesc_t*>( reinterpret_cast<byte*>( header ) + header->seqindex ) + sequence;
+
+    const mstudioanim_t* panim = nullptr;
+
+    if( pseqdesc->seqgroup == 0 )
+    {
+        panim = reinterpret_cast<mstudioanim_t*>( reinterpret_cast<byte*>( header ) + pseqdesc->animindex );
+    }
+
+    for( int i = 0; i < header->numbones; ++i )
+    {
+        const auto& bone = pbones[i];
+        Vector angles;
+
+        for( int j = 0; j < 3; ++j )
+        {
+            angles[j] = bone.value[j + 3];
+            pose.Pos[i][j] = bone.value[j];
+
+            if( !panim )
+            {
+                continue;
+            }
+
+            short value1, value2;
+
+            if( panim[i].offset[j + 3] != 0 )
+            {
+                StudioDecodeRotationValues( reinterpret_cast<const mstudioanimvalue_t*>( reinterpret_cast<const byte*>( &panim[i] ) + panim[i].offset[j + 3] ), 0, value1, value2 );
+                angles[j] += value1 * bone.scale[j + 3];
+            }
+
+            if( panim[i].offset[j] != 0 )
+            {
+                StudioDecodePositionValues( reinterpret_cast<const mstudioanimvalue_t*>( reinterpret_cast<const byte*>( &panim[i] ) + panim[i].offset[j] ), 0, value1, value2 );
+                pose.Pos[i][j] += value1 * bone.scale[j];
+            }
+        }
+
+        AngleQuaternion( angles, pose.Q[i] );
+    }
+}
+
+template <typename Function>
+static double StudioTimeBoneSetup( int iterations, Function&& function )
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for( int i = 0; i < iterations; ++i )
+    {
+        function();
+    }
+
+    const std::chrono::duration<double, std::micro> duration = std::chrono::high_resolution_clock::now() - start;
+
+    return duration.count() / iterations;
+}
+
+void StudioBenchmarkBoneSetup( int iterations )
+{
+    iterations = std::max( 1, iterations );
+
+    Con_Printf( "Bone setup benchmark, %d iterations (%s)\n", iterations, STUDIO_BONES_SSE2 ? "SSE2" : "no SSE2, batched path is scalar" );
+
+    auto from = std::make_unique<BenchmarkPose>();
+    auto to = std::make_unique<BenchmarkPose>();
+    auto work = std::make_unique<BenchmarkPose>();
+    auto matrices = std::make_unique<BenchmarkResult>();
+    auto scalar = std::make_unique<BenchmarkResult>();
+    auto batched = std::make_unique<BenchmarkResult>();
+
+    for( const char* modelName : {"models/player.mdl", "models/scientist.mdl"} )
+    {
+        model_t* model = IEngineStudio.Mod_ForName( modelName, 0 );
+
+        if( !model )
+        {
+            Con_Printf( "%s: not found\n", modelName );
+            continue;
+        }
+
+        const auto header = static_cast<studiohdr_t*>( IEngineStudio.Mod_Extradata( model ) );
+
+        if( !header || header->numbones <= 0 || header->numbones > MAXSTUDIOBONES || header->numseq <= 0 )
+        {
+            Con_Printf( "%s: not a valid studio model\n", modelName );
+            continue;
+        }
+
+        const int numBones = header->numbones;
+        const auto pbones = reinterpret_cast<mstudiobone_t*>( reinterpret_cast<byte*>( header ) + header->boneindex );
+
+        StudioDecodeBenchmarkPose( header, 0, *from );
+        StudioDecodeBenchmarkPose( header, header->numseq / 2, *to );
+
+        // Blend two poses and build the hierarchy the same way StudioSetupBones does.
+        const auto run = [&]( auto slerp, auto buildMatrices, auto concat, BenchmarkResult& result )
+        {
+            *work = *from;
+
+            slerp( work->Q, work->Pos, to->Q, to->Pos, 0.35f, numBones );
+            buildMatrices( work->Q, work->Pos, matrices->Transforms, numBones );
+
+            for( int i = 0; i < numBones; ++i )
+            {
+                const int parent = pbones[i].parent;
+
+                if( parent >= 0 && parent < numBones )
+                {
+                    concat( result.Transforms[parent], matrices->Transforms[i], result.Transforms[i] );
+                }
+                else
+                {
+                    std::memcpy( result.Transforms[i], matrices->Transforms[i], sizeof( result.Transforms[i] ) );
+                }
+            }
+        };
+
+        const auto scalarConcat = []( float in1[3][4], float in2[3][4], float out[3][4] )
+        {
+            ConcatTransforms( in1, in2, out );
+        };
+
+        const double scalarTime = StudioTimeBoneSetup( iterations, [&]()
+            { run( StudioSlerpBonesScalar, StudioBoneMatricesScalar, scalarConcat, *scalar ); } );
+
+        const double batchedTime = StudioTimeBoneSetup( iterations, [&]()
+            { run( StudioSlerpBonesBatched, StudioBoneMatricesBatched, StudioConcatTransforms, *batched ); } );
+
+        float maxDifference = 0;
+
+        for( int i = 0; i < numBones; ++i )
+        {
+            for( int j = 0; j < 3; ++j )
+            {
+                for( int k = 0; k < 4; ++k )
+                {
+                    maxDifference = std::max( maxDifference, std::abs( scalar->Transforms[i][j][k] - batched->Transforms[i][j][k] ) );
+                }
+            }
+        }
+
+        Con_Printf( "%s (%d bones): scalar %.3f us, batched %.3f us (%.2fx), max difference %g\n",
+            modelName, numBones, scalarTime, batchedTime, batchedTime > 0 ? scalarTime / batchedTime : 0.0, maxDifference );
+    }
+}
@@ -0,0 +1,47 @@
+//========= Copyright © 1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#pragma once
+
+#include "mathlib.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define STUDIO_BONES_SSE2 1
+#else
+#define STUDIO_BONES_SSE2 0
+#endif
+
+/**
+ *    @brief Blends @p q1 and @p pos1 towards @p q2 and @p pos2 one bone at a time using the mathlib functions.
+ *    @details Used as the reference for the batched version.
+ */
+void StudioSlerpBonesScalar( vec4_t q1[], float pos1[][3], const vec4_t q2[], const float pos2[][3], float s, int numBones );
+
+/**
+ *    @brief Blends @p q1 and @p pos1 towards @p q2 and @p pos2, 4 bones at a time if SSE2 is available.
+ */
+void StudioSlerpBonesBatched( vec4_t q1[], float pos1[][3], const vec4_t q2[], const float pos2[][3], float s, int numBones );
+
+/**
+ *    @brief Builds the local matrix of each bone one bone at a time using the mathlib functions.
+ */
+void StudioBoneMatricesScalar( const vec4_t q[], const float pos[][3], float matrices[][3][4], int numBones );
+
+/**
+ *    @brief Builds the local matrix of each bone, 4 bones at a time if SSE2 is available.
+ */
+void StudioBoneMatricesBatched( const vec4_t q[], const float pos[][3], float matrices[][3][4], int numBones );
+
+/**
+ *    @brief Same as @c ConcatTransforms, using SSE2 if available.
+ */
+void StudioConcatTransforms( const float in1[3][4], const float in2[3][4], float out[3][4] );
+
+/**
+ *    @brief Times the scalar and batched bone setup on the stock player and scientist models.
+ */
+void StudioBenchmarkBoneSetup( int iterations );
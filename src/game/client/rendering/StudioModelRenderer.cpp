@@ -12,6 +12,7 @@
 
 #include "r_studioint.h"
 
+#include "StudioBoneSetup.h"
 #include "StudioModelRenderer.h"
 #include "GameStudioModelRenderer.h"
 
@@ -62,6 +63,7 @@ void CStudioModelRenderer::Init()
     m_pCvarHiModels = IEngineStudio.GetCvar( "cl_himodels" );
     m_pCvarDeveloper = IEngineStudio.GetCvar( "developer" );
     m_pCvarDrawEntities = IEngineStudio.GetCvar( "r_drawentities" );
+    m_pCvarAnimCacheBudget = gEngfuncs.pfnRegisterVariable( "r_studio_anim_cache", "16", FCVAR_ARCHIVE );
 
     m_pChromeSprite = IEngineStudio.GetChromeSprite();
 
@@ -88,6 +90,7 @@ CStudioModelRenderer::CStudioModelRenderer()
     m_pCvarHiModels = nullptr;
     m_pCvarDeveloper = nullptr;
     m_pCvarDrawEntities = nullptr;
+    m_pCvarAnimCacheBudget = nullptr;
     m_pChromeSprite = nullptr;
     m_pStudioModelCount = nullptr;
     m_pModelsDrawn = nullptr;
@@ -184,16 +187,16 @@ void CStudioModelRenderer::StudioCalcBoneAdj( float dadt, float* adj, const byte
 
 /*
 ====================
-StudioCalcBoneQuaterion
+StudioBoneQuaternionFromValues
 
+Shared by the decoder and the animation cache so both produce the same result.
 ====================
 */
-void CStudioModelRenderer::StudioCalcBoneQuaterion( int frame, float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* q )
+static void StudioBoneQuaternionFromValues( const short values[3][2], float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* q )
 {
-    int j, k;
+    int j;
     vec4_t q1, q2;
     Vector angle1, angle2;
-    mstudioanimvalue_t* panimvalue;
 
     for( j = 0; j < 3; j++ )
     {
@@ -203,50 +206,8 @@ void CStudioModelRenderer::StudioCalcBoneQuaterion( int frame, float s, mstudiob
         }
         else
         {
-            panimvalue = ( mstudioanimvalue_t* )( ( byte* )panim + panim->offset[j + 3] );
-            k = frame;
-            // DEBUG
-            if( panimvalue->num.total < panimvalue->num.valid )
-                k = 0;
-            while( panimvalue->num.total <= k )
-            {
-                k -= panimvalue->num.total;
-                panimvalue += panimvalue->num.valid + 1;
-                // DEBUG
-                if( panimvalue->num.total < panimvalue->num.valid )
-                    k = 0;
-            }
-            // Bah, missing blend!
-            if( panimvalue->num.valid > k )
-            {
-                angle1[j] = panimvalue[k + 1].value;
-
-                if( panimvalue->num.valid > k + 1 )
-                {
-                    angle2[j] = panimvalue[k + 2].value;
-                }
-                else
-                {
-                    if( panimvalue->num.total > k + 1 )
-                        angle2[j] = angle1[j];
-                    else
-                        angle2[j] = panimvalue[panimvalue->num.valid + 2].value;
-                }
-            }
-            else
-            {
-                angle1[j] = panimvalue[panimvalue->num.valid].value;
-                if( panimvalue->num.total > k + 1 )
-                {
-                    angle2[j] = angle1[j];
-                }
-                else
-                {
-                    angle2[j] = panimvalue[panimvalue->num.valid + 2].value;
-                }
-            }
-            angle1[j] = pbone->value[j + 3] + angle1[j] * pbone->scale[j + 3];
-            angle2[j] = pbone->value[j + 3] + angle2[j] * pbone->scale[j + 3];
+            angle1[j] = pbone->value[j + 3] + values[j][0] * pbone->scale[j + 3];
+            angle2[j] = pbone->value[j + 3] + values[j][1] * pbone->scale[j + 3];
         }
 
         if( pbone->bonecontroller[j + 3] != -1 )
@@ -270,63 +231,27 @@ void CStudioModelRenderer::StudioCalcBoneQuaterion( int frame, float s, mstudiob
 
 /*
 ====================
-StudioCalcBonePosition
+StudioBonePositionFromValues
 
+Shared by the decoder and the animation cache so both produce the same result.
 ====================
 */
-void CStudioModelRenderer::StudioCalcBonePosition( int frame, float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* pos )
+static void StudioBonePositionFromValues( const short values[3][2], int blend, float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* pos )
 {
-    int j, k;
-    mstudioanimvalue_t* panimvalue;
+    int j;
 
     for( j = 0; j < 3; j++ )
     {
         pos[j] = pbone->value[j]; // default;
         if( panim->offset[j] != 0 )
         {
-            panimvalue = ( mstudioanimvalue_t* )( ( byte* )panim + panim->offset[j] );
-            /*
-            if (i == 0 && j == 0)
-                Con_DPrintf("%d  %d:%d  %f\n", frame, panimvalue->num.valid, panimvalue->num.total, s );
-            */
-
-            k = frame;
-            // DEBUG
-            if( panimvalue->num.total < panimvalue->num.valid )
-                k = 0;
-            // find span of values that includes the frame we want
-            while( panimvalue->num.total <= k )
+            if( ( blend & ( 1 << j ) ) != 0 )
             {
-                k -= panimvalue->num.total;
-                panimvalue += panimvalue->num.valid + 1;
-                // DEBUG
-                if( panimvalue->num.total < panimvalue->num.valid )
-                    k = 0;
-            }
-            // if we're inside the span
-            if( panimvalue->num.valid > k )
-            {
-                // and there's more data in the span
-                if( panimvalue->num.valid > k + 1 )
-                {
-                    pos[j] += ( panimvalue[k + 1].value * ( 1.0 - s ) + s * panimvalue[k + 2].value ) * pbone->scale[j];
-                }
-                else
-                {
-                    pos[j] += panimvalue[k + 1].value * pbone->scale[j];
-                }
+                pos[j] += ( values[j][0] * ( 1.0 - s ) + s * values[j][1] ) * pbone->scale[j];
             }
             else
             {
-                // are we at the end of the repeating values section and there's another section with data?
-                if( panimvalue->num.total <= k + 1 )
-                {
-                    pos[j] += ( panimvalue[panimvalue->num.valid].value * ( 1.0 - s ) + s * panimvalue[panimvalue->num.valid + 2].value ) * pbone->scale[j];
-                }
-                else
-                {
-                    pos[j] += panimvalue[panimvalue->num.valid].value * pbone->scale[j];
-                }
+                pos[j] += values[j][0] * pbone->scale[j];
             }
         }
         if( pbone->bonecontroller[j] != -1 && adj )
@@ -336,6 +261,55 @@ void CStudioModelRenderer::StudioCalcBonePosition( int frame, float s, mstudiobo
     }
 }
 
+/*
+====================
+StudioCalcBoneQuaterion
+
+====================
+*/
+void CStudioModelRenderer::StudioCalcBoneQuaterion( int frame, float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* q )
+{
+    short values[3][2]{};
+
+    for( int j = 0; j < 3; j++ )
+    {
+        if( panim->offset[j + 3] != 0 )
+        {
+            auto panimvalue = ( mstudioanimvalue_t* )( ( byte* )panim + panim->offset[j + 3] );
+            StudioDecodeRotationValues( panimvalue, frame, values[j][0], values[j][1] );
+        }
+    }
+
+    StudioBoneQuaternionFromValues( values, s, pbone, panim, adj, q );
+}
+
+/*
+====================
+StudioCalcBonePosition
+
+====================
+*/
+void CStudioModelRenderer::StudioCalcBonePosition( int frame, float s, mstudiobone_t* pbone, mstudioanim_t* panim, float* adj, float* pos )
+{
+    short values[3][2]{};
+    int blend = 0;
+
+    for( int j = 0; j < 3; j++ )
+    {
+        if( panim->offset[j] != 0 )
+        {
+            auto panimvalue = ( mstudioanimvalue_t* )( ( byte* )panim + panim->offset[j] );
+
+            if( StudioDecodePositionValues( panimvalue, frame, values[j][0], values[j][1] ) )
+            {
+                blend |= 1 << j;
+            }
+        }
+    }
+
+    StudioBonePositionFromValues( values, blend, s, pbone, panim, adj, pos );
+}
+
 /*
 ====================
 StudioSlerpBones
@@ -344,28 +318,12 @@ StudioSlerpBones
 */
 void CStudioModelRenderer::StudioSlerpBones( vec4_t q1[], float pos1[][3], vec4_t q2[], float pos2[][3], float s )
 {
-    int i;
-    vec4_t q3;
-    float s1;
-
     if( s < 0 )
         s = 0;
     else if( s > 1.0 )
         s = 1.0;
 
-    s1 = 1.0 - s;
-
-    for( i = 0; i < m_pStudioHeader->numbones; i++ )
-    {
-        QuaternionSlerp( q1[i], q2[i], s, q3 );
-        q1[i][0] = q3[0];
-        q1[i][1] = q3[1];
-        q1[i][2] = q3[2];
-        q1[i][3] = q3[3];
-        pos1[i][0] = pos1[i][0] * s1 + pos2[i][0] * s;
-        pos1[i][1] = pos1[i][1] * s1 + pos2[i][1] * s;
-        pos1[i][2] = pos1[i][2] * s1 + pos2[i][2] * s;
-    }
+    StudioSlerpBonesBatched( q1, pos1, q2, pos2, s, m_pStudioHeader->numbones );
 }
 
 /*
@@ -535,7 +493,7 @@ void CStudioModelRenderer::StudioSetUpTransform( bool trivial_accept )
 
     if( 0 == IEngineStudio.IsHardware() )
     {
-        static float viewmatrix[3][4];
+        float viewmatrix[3][4]{};
 
         VectorCopy( m_vRight, viewmatrix[0] );
         VectorCopy( m_vUp, viewmatrix[1] );
@@ -638,13 +596,34 @@ void CStudioModelRenderer::StudioCalcRotations( float pos[][3], vec4_t* q, mstud
 
     StudioCalcBoneAdj( dadt, adj, m_pCurrentEntity->curstate.controller, m_pCurrentEntity->latched.prevcontroller, m_pCurrentEntity->mouth.mouthopen );
 
-    for( i = 0; i < m_pStudioHeader->numbones; i++, pbone++, panim++ )
+    const DecodedBoneFrame* decoded = nullptr;
+
+    if( m_pCvarAnimCacheBudget )
+    {
+        m_AnimationCache.SetBudget( static_cast<std::size_t>( std::max( 0.f, m_pCvarAnimCacheBudget->value ) * 1024 * 1024 ) );
+        decoded = m_AnimationCache.Get( m_pStudioHeader, pseqdesc, panim );
+    }
+
+    if( decoded )
     {
-        StudioCalcBoneQuaterion( frame, s, pbone, panim, adj, q[i] );
+        decoded += frame * m_pStudioHeader->numbones;
 
-        StudioCalcBonePosition( frame, s, pbone, panim, adj, pos[i] );
-        // if (0 && i == 0)
-        //    Con_DPrintf("%d %d %d %d\n", m_pCurrentEntity->curstate.sequence, frame, j, k );
+        for( i = 0; i < m_pStudioHeader->numbones; i++, pbone++, panim++, decoded++ )
+        {
+            StudioBoneQuaternionFromValues( decoded->Rotation, s, pbone, panim, adj, q[i] );
+            StudioBonePositionFromValues( decoded->Position, decoded->PositionBlend, s, pbone, panim, adj, pos[i] );
+        }
+    }
+    else
+    {
+        for( i = 0; i < m_pStudioHeader->numbones; i++, pbone++, panim++ )
+        {
+            StudioCalcBoneQuaterion( frame, s, pbone, panim, adj, q[i] );
+
+            StudioCalcBonePosition( frame, s, pbone, panim, adj, pos[i] );
+            // if (0 && i == 0)
+            //    Con_DPrintf("%d %d %d %d\n", m_pCurrentEntity->curstate.sequence, frame, j, k );
+        }
     }
 
     if( ( pseqdesc->motiontype & STUDIO_X ) != 0 )
@@ -812,16 +791,15 @@ void CStudioModelRenderer::StudioSetupBones()
     mstudioseqdesc_t* pseqdesc;
     mstudioanim_t* panim;
 
-    static float pos[MAXSTUDIOBONES][3];
-    static vec4_t q[MAXSTUDIOBONES];
-    float bonematrix[3][4];
-
-    static float pos2[MAXSTUDIOBONES][3];
-    static vec4_t q2[MAXSTUDIOBONES];
-    static float pos3[MAXSTUDIOBONES][3];
-    static vec4_t q3[MAXSTUDIOBONES];
-    static float pos4[MAXSTUDIOBONES][3];
-    static vec4_t q4[MAXSTUDIOBONES];
+    auto& pos = m_BoneScratch.Pos;
+    auto& q = m_BoneScratch.Q;
+    auto& pos2 = m_BoneScratch.Pos2;
+    auto& q2 = m_BoneScratch.Q2;
+    auto& pos3 = m_BoneScratch.Pos3;
+    auto& q3 = m_BoneScratch.Q3;
+    auto& pos4 = m_BoneScratch.Pos4;
+    auto& q4 = m_BoneScratch.Q4;
+    auto& bonematrices = m_BoneScratch.Matrices;
 
     if( m_pCurrentEntity->curstate.sequence >= m_pStudioHeader->numseq )
     {
@@ -891,8 +869,8 @@ void CStudioModelRenderer::StudioSetupBones()
         ( m_pCurrentEntity->latched.prevsequence < m_pStudioHeader->numseq ) )
     {
         // blend from last sequence
-        static float pos1b[MAXSTUDIOBONES][3];
-        static vec4_t q1b[MAXSTUDIOBONES];
+        auto& pos1b = m_BoneScratch.Pos1b;
+        auto& q1b = m_BoneScratch.Q1b;
         float s;
 
         if( m_pCurrentEntity->latched.prevsequence >= m_pStudioHeader->numseq )
@@ -987,21 +965,18 @@ void CStudioModelRenderer::StudioSetupBones()
         }
     }
 
+    StudioBoneMatricesBatched( q, pos, bonematrices, m_pStudioHeader->numbones );
+
     for( i = 0; i < m_pStudioHeader->numbones; i++ )
     {
         const int parent = pbones[i].parent;
-
-        QuaternionMatrix( q[i], bonematrix );
-
-        bonematrix[0][3] = pos[i][0];
-        bonematrix[1][3] = pos[i][1];
-        bonematrix[2][3] = pos[i][2];
+        auto& bonematrix = bonematrices[i];
 
         if( parent == -1 )
         {
             if( 0 != IEngineStudio.IsHardware() )
             {
-                ConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_pbonetransform )[i] );
+                StudioConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_pbonetransform )[i] );
 
                 // MatrixCopy should be faster...
                 // ConcatTransforms ((*m_protationmatrix), bonematrix, (*m_plighttransform)[i]);
@@ -1009,8 +984,8 @@ void CStudioModelRenderer::StudioSetupBones()
             }
             else
             {
-                ConcatTransforms( ( *m_paliastransform ), bonematrix, ( *m_pbonetransform )[i] );
-                ConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_plighttransform )[i] );
+                StudioConcatTransforms( ( *m_paliastransform ), bonematrix, ( *m_pbonetransform )[i] );
+                StudioConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_plighttransform )[i] );
             }
 
             // Apply client-side effects to the transformation matrix
@@ -1018,8 +993,8 @@ void CStudioModelRenderer::StudioSetupBones()
         }
         else if( parent >= 0 && parent < m_pStudioHeader->numbones )
         {
-            ConcatTransforms( ( *m_pbonetransform )[parent], bonematrix, ( *m_pbonetransform )[i] );
-            ConcatTransforms( ( *m_plighttransform )[parent], bonematrix, ( *m_plighttransform )[i] );
+            StudioConcatTransforms( ( *m_pbonetransform )[parent], bonematrix, ( *m_pbonetransform )[i] );
+            StudioConcatTransforms( ( *m_plighttransform )[parent], bonematrix, ( *m_plighttransform )[i] );
         }
     }
 }
@@ -1064,9 +1039,9 @@ void CStudioModelRenderer::StudioMergeBones( model_t* subModel )
     mstudioseqdesc_t* pseqdesc;
     mstudioanim_t* panim;
 
-    static float pos[MAXSTUDIOBONES][3];
-    float bonematrix[3][4];
-    static vec4_t q[MAXSTUDIOBONES];
+    auto& pos = m_BoneScratch.Pos;
+    auto& q = m_BoneScratch.Q;
+    auto& bonematrices = m_BoneScratch.Matrices;
 
     if( m_pCurrentEntity->curstate.sequence >= m_pStudioHeader->numseq )
     {
@@ -1087,6 +1062,7 @@ void CStudioModelRenderer::StudioMergeBones( model_t* subModel )
 
     pbones = ( mstudiobone_t* )( ( byte* )m_pStudioHeader + m_pStudioHeader->boneindex );
 
+    StudioBoneMatricesBatched( q, pos, bonematrices, m_pStudioHeader->numbones );
 
     for( i = 0; i < m_pStudioHeader->numbones; i++ )
     {
@@ -1101,17 +1077,13 @@ void CStudioModelRenderer::StudioMergeBones( model_t* subModel )
         }
         if( j >= m_nCachedBones )
         {
-            QuaternionMatrix( q[i], bonematrix );
-
-            bonematrix[0][3] = pos[i][0];
-            bonematrix[1][3] = pos[i][1];
-            bonematrix[2][3] = pos[i][2];
+            auto& bonematrix = bonematrices[i];
 
             if( pbones[i].parent == -1 )
             {
                 if( 0 != IEngineStudio.IsHardware() )
                 {
-                    ConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_pbonetransform )[i] );
+                    StudioConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_pbonetransform )[i] );
 
                     // MatrixCopy should be faster...
                     // ConcatTransforms ((*m_protationmatrix), bonematrix, (*m_plighttransform)[i]);
@@ -1119,8 +1091,8 @@ void CStudioModelRenderer::StudioMergeBones( model_t* subModel )
                 }
                 else
                 {
-                    ConcatTransforms( ( *m_paliastransform ), bonematrix, ( *m_pbonetransform )[i] );
-                    ConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_plighttransform )[i] );
+                    StudioConcatTransforms( ( *m_paliastransform ), bonematrix, ( *m_pbonetransform )[i] );
+                    StudioConcatTransforms( ( *m_protationmatrix ), bonematrix, ( *m_plighttransform )[i] );
                 }
 
                 // Apply client-side effects to the transformation matrix
@@ -1128,8 +1100,8 @@ void CStudioModelRenderer::StudioMergeBones( model_t* subModel )
             }
             else
             {
-                ConcatTransforms( ( *m_pbonetransform )[pbones[i].parent], bonematrix, ( *m_pbonetransform )[i] );
-                ConcatTransforms( ( *m_plighttransform )[pbones[i].parent], bonematrix, ( *m_plighttransform )[i] );
+                StudioConcatTransforms( ( *m_pbonetransform )[pbones[i].parent], bonematrix, ( *m_pbonetransform )[i] );
+                StudioConcatTransforms( ( *m_plighttransform )[pbones[i].parent], bonematrix, ( *m_plighttransform )[i] );
             }
         }
     }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "StudioAnimationCache.h"
+
 /*
 ====================
 CStudioModelRenderer
@@ -116,6 +118,11 @@ public:
     cvar_t* m_pCvarDeveloper;
     // Draw entities bone hit boxes, etc?
     cvar_t* m_pCvarDrawEntities;
+    // Memory budget for decoded animations in megabytes, 0 to decode every frame
+    cvar_t* m_pCvarAnimCacheBudget;
+
+    // Decoded animations used by StudioCalcRotations
+    StudioAnimationCache m_AnimationCache;
 
     // The entity which we are currently rendering.
     cl_entity_t* m_pCurrentEntity;
@@ -156,6 +163,25 @@ public:
     float m_rgCachedBoneTransform[MAXSTUDIOBONES][3][4];
     float m_rgCachedLightTransform[MAXSTUDIOBONES][3][4];
 
+    // Scratch space for bone setup
+    struct BoneScratch
+    {
+        float Pos[MAXSTUDIOBONES][3];
+        vec4_t Q[MAXSTUDIOBONES];
+        float Pos1b[MAXSTUDIOBONES][3];
+        vec4_t Q1b[MAXSTUDIOBONES];
+        float Pos2[MAXSTUDIOBONES][3];
+        vec4_t Q2[MAXSTUDIOBONES];
+        float Pos3[MAXSTUDIOBONES][3];
+        vec4_t Q3[MAXSTUDIOBONES];
+        float Pos4[MAXSTUDIOBONES][3];
+        vec4_t Q4[MAXSTUDIOBONES];
+        // Local transform of each bone
+        float Matrices[MAXSTUDIOBONES][3][4];
+    };
+
+    BoneScratch m_BoneScratch;
+
     // Software renderer scale factors
     float m_fSoftwareXScale, m_fSoftwareYScale;
 
@@ -13,6 +13,7 @@
  *
  ****/
 
+#include <algorithm>
 #include <exception>
 #include <type_traits>
 
@@ -211,6 +212,16 @@ bool GameSoundSystem::Create( std::shared_ptr<spdlog::logger> logger )
     m_SoundCache = std::make_unique<SoundCache>( m_CacheLogger );
     m_Sentences = std::make_unique<SentencesSystem>( m_SentencesLogger, m_SoundCache.get() );
 
+    m_AsyncLoad = g_ConCommands.CreateCVar( "snd_async_load", "1", FCVAR_ARCHIVE );
+    m_UploadBudget = g_ConCommands.CreateCVar( "snd_upload_budget", "2", FCVAR_ARCHIVE );
+    g_ConCommands.CreateCommand( "snd_loader_stats", [this]( const auto& )
+        { PrintLoaderStats(); } );
+
+    m_CacheFormat = g_ConCommands.CreateCVar( "snd_cache_format", "2", FCVAR_ARCHIVE );
+    m_CacheBudget = g_ConCommands.CreateCVar( "snd_cache_budget", "256", FCVAR_ARCHIVE );
+    g_ConCommands.CreateCommand( "snd_cache_stats", [this]( const auto& )
+        { PrintCacheStats(); } );
+
     m_HRTFEnabled = g_ConCommands.CreateCVar( "snd_hrtf_enabled", "0", FCVAR_ARCHIVE );
     m_HRTFImplementation = g_ConCommands.CreateCVar( "snd_hrtf_implementation", "", FCVAR_ARCHIVE );
     g_ConCommands.CreateCommand( "snd_hrtf_list_implementations", [this]( const auto& )
@@ -256,6 +267,15 @@ void GameSoundSystem::HandleNetworkDataBlock( NetworkDataBlock& block )
             // TODO: avoid constructing multiple strings here
             m_PrecacheMap.push_back( m_SoundCache->FindName( fileName.get<std::string>().c_str() ) );
         }
+
+        // Start decoding precached sounds now so they're ready before they're first played.
+        if( m_AsyncLoad->value != 0 )
+        {
+            for( const auto index : m_PrecacheMap )
+            {
+                m_SoundCache->QueueLoad( index );
+            }
+        }
     }
     else if( block.Name == "Sentences" )
     {
@@ -272,6 +292,16 @@ void GameSoundSystem::Update()
 
     ++m_CurrentGameFrame;
 
+    m_SoundCache->SetSampleFormat( static_cast<SampleFormat>( std::clamp( static_cast<int>( m_CacheFormat->value ),
+        static_cast<int>( SampleFormat::Float32 ), static_cast<int>( SampleFormat::Native ) ) ) );
+    m_SoundCache->SetMemoryBudget( static_cast<std::size_t>( std::max( 0.f, m_CacheBudget->value ) * 1024 * 1024 ) );
+
+    m_SoundCache->Update( std::chrono::duration<double, std::milli>( std::max( 0.f, m_UploadBudget->value ) ) );
+
+    EvictUnusedSounds();
+
+    StartDeferredSounds();
+
     if( m_SupportsHRTF )
     {
         if( const bool hrtfEnabled = m_HRTFEnabled->value != 0; m_CachedHRTFEnabled != hrtfEnabled )
@@ -414,36 +444,26 @@ void GameSoundSystem::StartSound( int entityIndex, int channelIndex, SoundData&&
         return;
     }
 
-    if( !std::visit( [&, this]( auto&& sound )
-            {
-            using T = std::decay_t<decltype( sound )>;
-
-            if constexpr ( std::is_same_v<T, SoundIndex> )
-            {
-                if( !sound.IsValid() )
-                {
-                    return false;
-                }
-
-                auto& soundData = *m_SoundCache->GetSound( sound );
-
-                return m_SoundCache->LoadSound( soundData );
-            }
-            else if constexpr ( std::is_same_v<T, SentenceChannel> )
-            {
-                return m_Sentences->GetSentence( sound.Sentence ) != nullptr;
-            }
-            else
-            {
-                static_assert( always_false_v<T>, "StartSound does not handle all sound types" );
-            }
+    switch( GetSoundReadiness( sound ) )
+    {
+    case SoundReadiness::Invalid: return;
 
-            return false; },
-            sound ) )
+    case SoundReadiness::Loading:
     {
+        // Nothing can be playing a sound that hasn't loaded yet, so just make sure it won't start later on.
+        if( ( flags & SND_STOP ) != 0 )
+        {
+            CancelDeferredSounds( entityIndex, channelIndex );
+            return;
+        }
+
+        DeferSound( entityIndex, channelIndex, std::move( sound ), origin, volume, attenuation, pitch, flags );
         return;
     }
 
+    case SoundReadiness::Ready: break;
+    }
+
     if( ( flags & ( SND_STOP | SND_CHANGE_VOL | SND_CHANGE_PITCH ) ) != 0 )
     {
         if( AlterChannel( entityIndex, channelIndex, sound, volume, pitch, flags ) )
@@ -463,6 +483,9 @@ void GameSoundSystem::StartSound( int entityIndex, int channelIndex, SoundData&&
         return;
     }
 
+    // This sound replaces anything that was still waiting to play on this channel.
+    CancelDeferredSounds( entityIndex, channelIndex );
+
     Channel* newChannel = FindOrCreateChannel( entityIndex, channelIndex );
 
     const std::string_view soundOrSentence = GetSoundName( sound );
@@ -485,6 +508,7 @@ void GameSoundSystem::StartSound( int entityIndex, int channelIndex, SoundData&&
 void GameSoundSystem::StopAllSounds()
 {
     m_Channels.clear();
+    m_DeferredSounds.clear();
 }
 
 void GameSoundSystem::MsgFunc_EmitSound( const char* pszName, BufferReader& reader )
@@ -641,6 +665,238 @@ void GameSoundSystem::SetVolume()
     alListenerf( AL_GAIN, m_Volume->value );
 }
 
+void GameSoundSystem::PrintLoaderStats()
+{
+    const auto stats = m_SoundCache->GetStats();
+
+    Con_Printf( "Sound loader: %s\n", m_AsyncLoad->value != 0 ? "asynchronous" : "synchronous" );
+    Con_Printf( "Decode queue depth: %zu (peak %zu)\n", stats.QueueDepth, stats.PeakQueueDepth );
+    Con_Printf( "Waiting for upload: %zu\n", stats.PendingUploads );
+    Con_Printf( "Decoded: %llu, failed: %llu\n",
+        static_cast<unsigned long long>( stats.DecodedCount ), static_cast<unsigned long long>( stats.FailedCount ) );
+    Con_Printf( "Worst decode time: %.2f ms\n", stats.WorstDecodeTime.count() * 1000 );
+    Con_Printf( "Worst upload time in a frame: %.2f ms\n", stats.WorstUploadTime.count() * 1000 );
+    Con_Printf( "Sounds waiting to play: %zu\n", m_DeferredSounds.size() );
+    Con_Printf( "Delayed sounds: %llu, dropped: %llu\n",
+        static_cast<unsigned long long>( m_DeferredSoundCount ), static_cast<unsigned long long>( m_DroppedSoundCount ) );
+    Con_Printf( "Worst start delay: %.2f ms\n", m_WorstStartDelay.count() * 1000 );
+}
+
+void GameSoundSystem::PrintCacheStats()
+{
+    static constexpr const char* FormatNames[] = {"32 bit float", "16 bit", "native"};
+
+    const auto& stats = m_SoundCache->GetCacheStats();
+
+    constexpr double bytesPerMegabyte = 1024 * 1024;
+
+    Con_Printf( "Sample format: %s\n", FormatNames[static_cast<int>( m_SoundCache->GetSampleFormat() )] );
+    Con_Printf( "Loaded sounds: %zu\n", stats.LoadedCount );
+    Con_Printf( "Buffer memory: %.2f MB\n", stats.BufferBytes / bytesPerMegabyte );
+    Con_Printf( "Sample memory: %.2f MB\n", stats.SampleBytes / bytesPerMegabyte );
+
+    if( const auto budget = m_SoundCache->GetMemoryBudget(); budget > 0 )
+    {
+        Con_Printf( "Budget: %.2f MB\n", budget / bytesPerMegabyte );
+    }
+    else
+    {
+        Con_Printf( "Budget: unlimited\n" );
+    }
+
+    Con_Printf( "Evicted sounds: %llu\n", static_cast<unsigned long long>( stats.EvictedCount ) );
+}
+
+void GameSoundSystem::EvictUnusedSounds()
+{
+    if( !m_SoundCache->IsOverBudget() )
+    {
+        return;
+    }
+
+    std::vector<SoundIndex> soundsInUse;
+
+    const auto addSound = [&, this]( const SoundData& sound )
+    {
+        std::visit( [&, this]( auto&& sound )
+            {
+                using T = std::decay_t<decltype( sound )>;
+
+                if constexpr ( std::is_same_v<T, SoundIndex> )
+                {
+                    soundsInUse.push_back( sound );
+                }
+                else if constexpr ( std::is_same_v<T, SentenceChannel> )
+                {
+                    // Keep all words so the rest of the sentence doesn't have to be reloaded.
+                    if( const auto sentence = m_Sentences->GetSentence( sound.Sentence ); sentence )
+                    {
+                        for( const auto& word : sentence->Words )
+                        {
+                            soundsInUse.push_back( word.Index );
+                        }
+                    }
+                }
+                else
+                {
+                    static_assert( always_false_v<T>, "EvictUnusedSounds does not handle all sound types" );
+                } },
+            sound );
+    };
+
+    for( const auto& channel : m_Channels )
+    {
+        addSound( channel.Sound );
+    }
+
+    for( const auto& deferred : m_DeferredSounds )
+    {
+        addSound( deferred.Sound );
+    }
+
+    m_SoundCache->EvictUnusedSounds( soundsInUse );
+}
+
+GameSoundSystem::SoundReadiness GameSoundSystem::GetSoundReadiness( const SoundData& sound )
+{
+    const bool async = m_AsyncLoad->value != 0;
+
+    return std::visit( [&, this]( auto&& sound )
+        {
+            using T = std::decay_t<decltype( sound )>;
+
+            if constexpr ( std::is_same_v<T, SoundIndex> )
+            {
+                if( !sound.IsValid() )
+                {
+                    return SoundReadiness::Invalid;
+                }
+
+                auto& soundData = *m_SoundCache->GetSound( sound );
+
+                if( !async )
+                {
+                    return m_SoundCache->LoadSound( soundData ) ? SoundReadiness::Ready : SoundReadiness::Invalid;
+                }
+
+                if( soundData.LoadState == SoundLoadState::Failed )
+                {
+                    return SoundReadiness::Invalid;
+                }
+
+                return m_SoundCache->RequestSound( sound ) ? SoundReadiness::Ready : SoundReadiness::Loading;
+            }
+            else if constexpr ( std::is_same_v<T, SentenceChannel> )
+            {
+                const auto sentence = m_Sentences->GetSentence( sound.Sentence );
+
+                if( !sentence )
+                {
+                    return SoundReadiness::Invalid;
+                }
+
+                if( !async )
+                {
+                    // Words are loaded as they are played.
+                    return SoundReadiness::Ready;
+                }
+
+                // Request all words up front so the sentence doesn't stall between words.
+                // Words that failed to load are skipped during playback like before.
+                bool ready = true;
+
+                for( const auto& word : sentence->Words )
+                {
+                    if( auto wordSound = m_SoundCache->GetSound( word.Index );
+                        wordSound && wordSound->LoadState != SoundLoadState::Failed && !m_SoundCache->RequestSound( word.Index ) )
+                    {
+                        ready = false;
+                    }
+                }
+
+                return ready ? SoundReadiness::Ready : SoundReadiness::Loading;
+            }
+            else
+            {
+                static_assert( always_false_v<T>, "GetSoundReadiness does not handle all sound types" );
+            }
+
+            return SoundReadiness::Invalid; },
+        sound );
+}
+
+void GameSoundSystem::DeferSound( int entityIndex, int channelIndex, SoundData&& sound,
+    const Vector& origin, float volume, float attenuation, int pitch, int flags )
+{
+    m_Logger->trace( "Delaying \"{}\" until it has loaded: Entity {}, channel {}", GetSoundName( sound ), entityIndex, channelIndex );
+
+    CancelDeferredSounds( entityIndex, channelIndex );
+
+    ++m_DeferredSoundCount;
+
+    m_DeferredSounds.push_back( DeferredSound{
+        entityIndex, channelIndex, std::move( sound ), origin, volume, attenuation, pitch, flags,
+        std::chrono::high_resolution_clock::now()} );
+}
+
+void GameSoundSystem::CancelDeferredSounds( int entityIndex, int channelIndex )
+{
+    // These channels don't replace sounds playing on them.
+    if( channelIndex == CHAN_AUTO || channelIndex == CHAN_STATIC )
+    {
+        return;
+    }
+
+    std::erase_if( m_DeferredSounds, [&]( const auto& deferred )
+        { return deferred.EntityIndex == entityIndex && deferred.ChannelIndex == channelIndex; } );
+}
+
+void GameSoundSystem::StartDeferredSounds()
+{
+    if( m_DeferredSounds.empty() )
+    {
+        return;
+    }
+
+    const auto now = std::chrono::high_resolution_clock::now();
+
+    // Starting a sound can defer it again, so work on a separate list.
+    auto deferredSounds = std::move( m_DeferredSounds );
+    m_DeferredSounds.clear();
+
+    for( auto& deferred : deferredSounds )
+    {
+        const auto delay = now - deferred.StartTime;
+
+        switch( GetSoundReadiness( deferred.Sound ) )
+        {
+        case SoundReadiness::Invalid: break;
+
+        case SoundReadiness::Loading:
+        {
+            if( delay > MaxDeferredSoundDelay )
+            {
+                m_Logger->debug( "Dropped \"{}\": still loading after {} seconds", GetSoundName( deferred.Sound ), MaxDeferredSoundDelay.count() );
+                ++m_DroppedSoundCount;
+                break;
+            }
+
+            m_DeferredSounds.push_back( std::move( deferred ) );
+            break;
+        }
+
+        case SoundReadiness::Ready:
+        {
+            m_WorstStartDelay = std::max<std::chrono::duration<double>>( m_WorstStartDelay, delay );
+
+            StartSound( deferred.EntityIndex, deferred.ChannelIndex, std::move( deferred.Sound ),
+                deferred.Origin, deferred.Volume, deferred.Attenuation, deferred.Pitch, deferred.Flags );
+            break;
+        }
+        }
+    }
+}
+
 std::string_view GameSoundSystem::GetSoundName( const SoundData& sound ) const
 {
     return std::visit( [&, this]( auto&& sound )
@@ -806,6 +1062,12 @@ bool GameSoundSystem::SetupChannel( Channel& channel, int entityIndex, int chann
 
                 alSourcei( channel.Source.Id, AL_BUFFER, soundData.Buffer.Id );
                 alSourcei( channel.Source.Id, AL_LOOPING, soundData.IsLooping ? AL_TRUE : AL_FALSE );
+
+                // Sounds on these channels move mouths, which needs the samples.
+                if( channelIndex == CHAN_VOICE || channelIndex == CHAN_STREAM )
+                {
+                    m_SoundCache->RequestSamples( sound, m_AsyncLoad->value != 0 );
+                }
             }
             else if constexpr ( std::is_same_v<T, SentenceChannel> )
             {
@@ -869,7 +1131,7 @@ bool GameSoundSystem::SetupChannel( Channel& channel, int entityIndex, int chann
                     alGetBufferi( soundData.Buffer.Id, AL_SIZE, &size );
 
                     // Need to convert the frequency to bytes for this to work.
-                    const ALint sampleSizeInBytes = channels * sizeof(float);
+                    const ALint sampleSizeInBytes = channels * soundData.BytesPerSample;
                     const ALint sampleRateInBytes = frequency * sampleSizeInBytes;
 
                     ALint skip = static_cast<ALint>( gEngfuncs.pfnRandomLong( 0, (int)( 0.1 * sampleRateInBytes ) ) );
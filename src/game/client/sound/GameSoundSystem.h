@@ -16,6 +16,8 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -35,6 +37,35 @@ namespace sound
 {
 class GameSoundSystem final : public IGameSoundSystem
 {
+private:
+    /**
+     *    @brief Sounds that are still loading are held back for at most this long before being dropped.
+     */
+    static constexpr std::chrono::seconds MaxDeferredSoundDelay{1};
+
+    enum class SoundReadiness
+    {
+        Invalid = 0,
+        Loading,
+        Ready
+    };
+
+    /**
+     *    @brief A sound that was started while its data was still being loaded.
+     */
+    struct DeferredSound
+    {
+        int EntityIndex{0};
+        int ChannelIndex{0};
+        SoundData Sound;
+        Vector Origin;
+        float Volume{0};
+        float Attenuation{0};
+        int Pitch{0};
+        int Flags{0};
+        std::chrono::high_resolution_clock::time_point StartTime;
+    };
+
 public:
     ~GameSoundSystem() override;
 
@@ -72,6 +103,30 @@ private:
 
     void SetVolume();
 
+    void PrintLoaderStats();
+
+    void PrintCacheStats();
+
+    /**
+     *    @brief Evicts sounds from the cache if it's over its memory budget, keeping sounds that are in use.
+     */
+    void EvictUnusedSounds();
+
+    /**
+     *    @brief Checks whether the sound's data is ready to play, requesting it if it isn't. Never blocks.
+     */
+    SoundReadiness GetSoundReadiness( const SoundData& sound );
+
+    void DeferSound( int entityIndex, int channelIndex, SoundData&& sound,
+        const Vector& origin, float volume, float attenuation, int pitch, int flags );
+
+    /**
+     *    @brief Removes deferred sounds that would have been replaced by a sound on the given channel.
+     */
+    void CancelDeferredSounds( int entityIndex, int channelIndex );
+
+    void StartDeferredSounds();
+
     std::string_view GetSoundName( const SoundData& sound ) const;
 
     Channel* CreateChannel();
@@ -113,6 +168,11 @@ private:
     cvar_t* m_RoomType{};
     cvar_t* m_WaterRoomType{};
 
+    cvar_t* m_AsyncLoad{};
+    cvar_t* m_UploadBudget{};
+    cvar_t* m_CacheFormat{};
+    cvar_t* m_CacheBudget{};
+
     cvar_t* m_HRTFEnabled{};
     cvar_t* m_HRTFImplementation{};
 
@@ -145,5 +205,11 @@ private:
     float m_LastKnownVolume{-1};
 
     std::vector<SoundIndex> m_PrecacheMap;
+
+    std::vector<DeferredSound> m_DeferredSounds;
+
+    std::uint64_t m_DeferredSoundCount{0};
+    std::uint64_t m_DroppedSoundCount{0};
+    std::chrono::duration<double> m_WorstStartDelay{};
 };
 }
@@ -96,6 +96,12 @@ void SentencesSystem::HandleNetworkDataBlock( NetworkDataBlock& block )
 
             word.Index = m_SoundCache->FindName( wordFileName );
 
+            // Needed for time compression and to move mouths.
+            if( auto wordSound = m_SoundCache->GetSound( word.Index ); wordSound )
+            {
+                wordSound->KeepSamples = true;
+            }
+
             sentenceToAdd.Words.push_back( word );
         }
 
@@ -265,7 +271,15 @@ void SentencesSystem::MoveMouth( Channel& channel, const Sound& sound )
 
     const std::size_t maxSamples = static_cast<std::size_t>( frequency * MouthSampleRange );
 
-    const std::size_t samplesToCheck = std::min( maxSamples, sound.Samples.size() - static_cast<std::size_t>( sampleOffset ) );
+    const std::size_t sampleCount = sound.GetSampleCount();
+
+    // The samples may still be loading.
+    if( static_cast<std::size_t>( sampleOffset ) >= sampleCount )
+    {
+        return;
+    }
+
+    const std::size_t samplesToCheck = std::min( maxSamples, sampleCount - static_cast<std::size_t>( sampleOffset ) );
 
     const auto entity = gEngfuncs.GetEntityByIndex( channel.EntityIndex );
 
@@ -281,7 +295,7 @@ void SentencesSystem::MoveMouth( Channel& channel, const Sound& sound )
 
     for( std::size_t sampleIndex = 0; sampleIndex < samplesToCheck && mouth.sndcount < MouthSamplesRequired; ++mouth.sndcount )
     {
-        const float sample = sound.Samples[static_cast<std::size_t>( sampleOffset ) + sampleIndex];
+        const float sample = sound.GetSample( static_cast<std::size_t>( sampleOffset ) + sampleIndex );
 
         // Rescale the sample range from [-1, 1] to [-128, 127].
         const int scaledSample = std::clamp( 
@@ -317,7 +331,14 @@ bool SentencesSystem::CreateTimeCompressedBuffer( const Channel& channel, Senten
     const float skipFraction = word.Parameters.TimeCompress / 100.f;
     const float writeFraction = 1.f - skipFraction;
 
-    const std::size_t channelCount = wordSound.Format == AL_FORMAT_MONO_FLOAT32 ? 1 : 2;
+    if( wordSound.Samples.empty() )
+    {
+        m_Logger->error( "Sentence word {} has no samples to time compress", wordSound.Name.c_str() );
+        return false;
+    }
+
+    const std::size_t channelCount = wordSound.ChannelCount == 1 ? 1 : 2;
+    const std::size_t frameSize = channelCount * wordSound.BytesPerSample;
 
     ALint size = 0;
     alGetBufferi( sound.Buffer.Id, AL_SIZE, &size );
@@ -325,17 +346,17 @@ bool SentencesSystem::CreateTimeCompressedBuffer( const Channel& channel, Senten
     const ALint startOffset = static_cast<ALint>( size * ( word.Parameters.Start / 100.f ) );
     const ALint endOffsetFromEnd = static_cast<ALint>( size * ( ( 100 - word.Parameters.End ) / 100.f ) );
 
-    const std::size_t numberOfActualSamples = ( size - startOffset - endOffsetFromEnd ) / sizeof(float);
+    const std::size_t numberOfActualSamples = ( size - startOffset - endOffsetFromEnd ) / wordSound.BytesPerSample;
 
     // Use the logical number of samples to minimize loss of samples due to fractional calculations.
     const std::size_t numberOfLogicalSamples = numberOfActualSamples / channelCount;
 
-    std::vector<float> compressedData;
-    compressedData.reserve( static_cast<std::size_t>( numberOfActualSamples * writeFraction ) );
+    std::vector<std::byte> compressedData;
+    compressedData.reserve( static_cast<std::size_t>( numberOfActualSamples * writeFraction ) * wordSound.BytesPerSample );
 
     const std::size_t chunkSize = numberOfLogicalSamples / TimeCompressChunkCount;
 
-    const std::size_t startIndex = static_cast<std::size_t>( ( wordSound.Samples.size() / static_cast<float>( channelCount ) ) * ( word.Parameters.Start / 100.f ) );
+    const std::size_t startIndex = static_cast<std::size_t>( ( wordSound.GetSampleCount() / static_cast<float>( channelCount ) ) * ( word.Parameters.Start / 100.f ) );
 
     bool isFirstIteration = true;
 
@@ -357,8 +378,8 @@ bool SentencesSystem::CreateTimeCompressedBuffer( const Channel& channel, Senten
 
         compressedData.insert( 
             compressedData.end(),
-            wordSound.Samples.begin() + ( readIndex * channelCount ),
-            wordSound.Samples.begin() + ( chunkEndPos * channelCount ) );
+            wordSound.Samples.begin() + ( readIndex * frameSize ),
+            wordSound.Samples.begin() + ( chunkEndPos * frameSize ) );
 
         readIndex = chunkEndPos;
     }
@@ -369,7 +390,7 @@ bool SentencesSystem::CreateTimeCompressedBuffer( const Channel& channel, Senten
     // Clear error state.
     alGetError();
 
-    alBufferData( sentenceChannel.TimeCompressBuffer.Id, wordSound.Format, compressedData.data(), compressedData.size() * sizeof(float), frequency );
+    alBufferData( sentenceChannel.TimeCompressBuffer.Id, wordSound.Format, compressedData.data(), compressedData.size(), frequency );
 
     if( const auto error = alGetError(); error != AL_NO_ERROR )
     {
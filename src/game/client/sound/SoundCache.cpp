@@ -13,6 +13,10 @@
  *
  ****/
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include <AL/alext.h>
 
 #include "cbase.h"
@@ -25,6 +29,28 @@ SoundCache::SoundCache( std::shared_ptr<spdlog::logger> logger )
     : m_Logger( logger ),
       m_Loader( std::make_unique<nqr::NyquistIO>() )
 {
+    // Leave some cores for the game itself.
+    const unsigned int threadCount = std::clamp( std::thread::hardware_concurrency() / 2, 1u, MaxLoaderThreads );
+
+    for( unsigned int i = 0; i < threadCount; ++i )
+    {
+        m_LoaderThreads.emplace_back( &SoundCache::RunLoader, this );
+    }
+}
+
+SoundCache::~SoundCache()
+{
+    {
+        std::lock_guard lock{m_QueueMutex};
+        m_Quit = true;
+    }
+
+    m_QueueCondition.notify_all();
+
+    for( auto& thread : m_LoaderThreads )
+    {
+        thread.join();
+    }
 }
 
 SoundIndex SoundCache::FindName( const RelativeFilename& fileName )
@@ -68,19 +94,12 @@ Sound* SoundCache::GetSound( SoundIndex index )
     return &m_Sounds[i];
 }
 
-bool SoundCache::LoadSound( Sound& sound )
+std::optional<std::string> SoundCache::GetAbsolutePath( const Sound& sound )
 {
-    if( sound.Buffer.IsValid() )
-    {
-        return true;
-    }
-
-    m_Logger->trace( "Loading sound {}", sound.Name.c_str() );
-
     if( sound.Name.empty() )
     {
         m_Logger->error( "Sound has no name" );
-        return false;
+        return {};
     }
 
     Filename completeFileName = SoundDirectoryName;
@@ -99,38 +118,293 @@ bool SoundCache::LoadSound( Sound& sound )
     {
         // TODO: add support for EASTL types to fmt formatting.
         m_Logger->error( "Could not find sound file {}", sound.Name.c_str() );
-        return false;
+        return {};
     }
 
     // Trim the size to the actual string's size.
     absolutePath.resize( strlen( absolutePath.c_str() ) );
 
-    nqr::AudioData data;
+    return absolutePath;
+}
 
-    try
+bool SoundCache::LoadSound( Sound& sound )
+{
+    sound.LastUsed = ++m_UseCounter;
+
+    if( sound.Buffer.IsValid() )
     {
-        m_Loader->Load( &data, absolutePath );
+        return true;
     }
-    catch ( const std::exception& e )
+
+    if( sound.LoadState == SoundLoadState::Failed )
     {
-        m_Logger->error( "Error loading sound file {}: {}", sound.Name.c_str(), e.what() );
         return false;
     }
 
+    m_Logger->trace( "Loading sound {}", sound.Name.c_str() );
+
+    auto absolutePath = GetAbsolutePath( sound );
+
+    if( !absolutePath )
+    {
+        sound.LoadState = SoundLoadState::Failed;
+        return false;
+    }
+
+    // If a loader thread is also working on this sound its result will be discarded.
+    DecodedSound decoded;
+
+    decoded.Job.AbsolutePath = std::move( *absolutePath );
+    decoded.Job.Format = m_SampleFormat;
+    decoded.Logger = DeferredLogger{m_Logger->level()};
+
+    Decode( *m_Loader, decoded );
+
+    return UploadSound( sound, decoded );
+}
+
+void SoundCache::PushJob( DecodeJob&& job, bool urgent )
+{
+    {
+        std::lock_guard lock{m_QueueMutex};
+
+        if( urgent )
+        {
+            m_DecodeQueue.push_front( std::move( job ) );
+        }
+        else
+        {
+            m_DecodeQueue.push_back( std::move( job ) );
+        }
+
+        m_Stats.PeakQueueDepth = std::max( m_Stats.PeakQueueDepth, m_DecodeQueue.size() );
+    }
+
+    m_QueueCondition.notify_one();
+}
+
+void SoundCache::QueueLoad( SoundIndex index, bool urgent )
+{
+    auto sound = GetSound( index );
+
+    if( !sound || sound->LoadState != SoundLoadState::NotLoaded )
+    {
+        return;
+    }
+
+    // Resolving the path goes through the engine's filesystem, which is only safe on the main thread.
+    // This only looks the file up; the file itself is read on the loader thread.
+    auto absolutePath = GetAbsolutePath( *sound );
+
+    if( !absolutePath )
+    {
+        sound->LoadState = SoundLoadState::Failed;
+        return;
+    }
+
+    sound->LoadState = urgent ? SoundLoadState::QueuedUrgent : SoundLoadState::Queued;
+
+    PushJob( {static_cast<std::size_t>( index.Index - 1 ), m_Generation, std::move( *absolutePath ), m_Logger->level(), m_SampleFormat}, urgent );
+}
+
+bool SoundCache::RequestSound( SoundIndex index )
+{
+    auto sound = GetSound( index );
+
+    if( !sound )
+    {
+        return false;
+    }
+
+    sound->LastUsed = ++m_UseCounter;
+
+    switch( sound->LoadState )
+    {
+    case SoundLoadState::NotLoaded:
+        QueueLoad( index, true );
+        break;
+
+    case SoundLoadState::Queued:
+    {
+        sound->LoadState = SoundLoadState::QueuedUrgent;
+
+        // Move it to the front if a loader thread hasn't picked it up yet.
+        std::lock_guard lock{m_QueueMutex};
+
+        const std::size_t soundIndex = index.Index - 1;
+
+        if( auto it = std::find_if( m_DecodeQueue.begin(), m_DecodeQueue.end(), [&]( const auto& job )
+                { return job.Index == soundIndex; } );
+            it != m_DecodeQueue.end() )
+        {
+            auto job = std::move( *it );
+            m_DecodeQueue.erase( it );
+            m_DecodeQueue.push_front( std::move( job ) );
+        }
+        break;
+    }
+
+    default: break;
+    }
+
+    return sound->Buffer.IsValid();
+}
+
+void SoundCache::RequestSamples( SoundIndex index, bool async )
+{
+    auto sound = GetSound( index );
+
+    if( !sound || sound->KeepSamples )
+    {
+        return;
+    }
+
+    sound->KeepSamples = true;
+
+    // Sounds that haven't been loaded yet will keep their samples once they are.
+    if( sound->LoadState != SoundLoadState::Loaded )
+    {
+        return;
+    }
+
+    auto absolutePath = GetAbsolutePath( *sound );
+
+    if( !absolutePath )
+    {
+        return;
+    }
+
+    DecodeJob job{static_cast<std::size_t>( index.Index - 1 ), m_Generation, std::move( *absolutePath ), m_Logger->level(), m_SampleFormat, true};
+
+    if( async )
+    {
+        PushJob( std::move( job ), false );
+        return;
+    }
+
+    DecodedSound decoded;
+
+    decoded.Job = std::move( job );
+    decoded.Logger = DeferredLogger{m_Logger->level()};
+
+    Decode( *m_Loader, decoded );
+
+    UploadSound( *sound, decoded );
+}
+
+void SoundCache::Update( std::chrono::duration<double> budget )
+{
+    {
+        std::lock_guard lock{m_DecodedMutex};
+
+        for( auto& decoded : m_Decoded )
+        {
+            m_PendingUploads.push_back( std::move( decoded ) );
+        }
+
+        m_Decoded.clear();
+    }
+
+    if( m_PendingUploads.empty() )
+    {
+        return;
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    do
+    {
+        auto decoded = std::move( m_PendingUploads.front() );
+        m_PendingUploads.pop_front();
+
+        m_Stats.WorstDecodeTime = std::max( m_Stats.WorstDecodeTime, decoded->DecodeTime );
+
+        if( decoded->Job.Generation != m_Generation )
+        {
+            continue;
+        }
+
+        auto& sound = m_Sounds[decoded->Job.Index];
+
+        if( decoded->Job.SamplesOnly )
+        {
+            // Evicted in the meantime.
+            if( sound.LoadState != SoundLoadState::Loaded )
+            {
+                continue;
+            }
+        }
+        // Loaded synchronously in the meantime.
+        else if( sound.LoadState != SoundLoadState::Queued && sound.LoadState != SoundLoadState::QueuedUrgent )
+        {
+            continue;
+        }
+
+        UploadSound( sound, *decoded );
+    } while( !m_PendingUploads.empty() && ( std::chrono::high_resolution_clock::now() - start ) < budget );
+
+    m_Stats.WorstUploadTime = std::max<std::chrono::duration<double>>( 
+        m_Stats.WorstUploadTime, std::chrono::high_resolution_clock::now() - start );
+}
+
+static ALenum GetBufferFormat( int channelCount, int bytesPerSample )
+{
+    const bool mono = channelCount == 1;
+
+    switch( bytesPerSample )
+    {
+    case 1: return mono ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
+    case 2: return mono ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    default: return mono ? AL_FORMAT_MONO_FLOAT32 : AL_FORMAT_STEREO_FLOAT32;
+    }
+}
+
+bool SoundCache::UploadSound( Sound& sound, DecodedSound& decoded )
+{
+    decoded.Logger.Flush( *m_Logger );
+
+    if( !decoded.Success )
+    {
+        ++m_Stats.FailedCount;
+
+        if( !decoded.Job.SamplesOnly )
+        {
+            sound.LoadState = SoundLoadState::Failed;
+        }
+
+        return false;
+    }
+
+    ++m_Stats.DecodedCount;
+
+    if( decoded.Job.SamplesOnly )
+    {
+        // The format can change if the sound was reloaded in the meantime.
+        if( sound.Samples.empty() && sound.BytesPerSample == decoded.BytesPerSample )
+        {
+            sound.Samples = std::move( decoded.Samples );
+            m_CacheStats.SampleBytes += sound.Samples.size();
+        }
+
+        return true;
+    }
+
+    auto& data = decoded.Data;
+
     // Clear error state.
     alGetError();
 
-    const ALenum format = data.channelCount == 1 ? AL_FORMAT_MONO_FLOAT32 : AL_FORMAT_STEREO_FLOAT32;
+    const ALenum format = GetBufferFormat( data.channelCount, decoded.BytesPerSample );
 
     sound.Buffer = OpenALBuffer::Create();
 
-    m_Logger->trace( "Loading sound {} into buffer {}", absolutePath, sound.Buffer.Id );
+    m_Logger->trace( "Loading sound {} into buffer {}", decoded.Job.AbsolutePath, sound.Buffer.Id );
 
     alBufferData( sound.Buffer.Id, format,
-        data.samples.data(), data.samples.size() * sizeof(float), data.sampleRate );
+        decoded.Samples.data(), decoded.Samples.size(), data.sampleRate );
 
     // See https://openal-soft.org/openal-extensions/SOFT_loop_points.txt
-    const auto cuePoints = TryLoadCuePoints( absolutePath, data.samples.size(), data.channelCount );
+    const auto& cuePoints = decoded.CuePoints;
 
     if( cuePoints )
     {
@@ -141,42 +415,284 @@ bool SoundCache::LoadSound( Sound& sound )
     if( const auto error = alGetError(); error != AL_NO_ERROR )
     {
         m_Logger->error( "OpenAL error {} ({}) while initializing buffer for \"{}\"",
-            alGetString( error ), error, absolutePath );
+            alGetString( error ), error, decoded.Job.AbsolutePath );
         sound.Buffer.Delete();
+        sound.LoadState = SoundLoadState::Failed;
         return false;
     }
 
     sound.IsLooping = cuePoints.has_value();
     sound.Format = format;
-    // Cache the samples for future use.
-    sound.Samples = std::move( data.samples );
+    sound.ChannelCount = data.channelCount;
+    sound.BytesPerSample = decoded.BytesPerSample;
+    sound.BufferSize = decoded.Samples.size();
+    sound.LoadState = SoundLoadState::Loaded;
+
+    ++m_CacheStats.LoadedCount;
+    m_CacheStats.BufferBytes += sound.BufferSize;
+
+    // OpenAL has its own copy now, so only keep ours if something needs it.
+    if( sound.KeepSamples )
+    {
+        sound.Samples = std::move( decoded.Samples );
+        m_CacheStats.SampleBytes += sound.Samples.size();
+    }
 
     return true;
 }
 
+void SoundCache::UnloadSound( Sound& sound )
+{
+    if( sound.LoadState == SoundLoadState::Loaded )
+    {
+        --m_CacheStats.LoadedCount;
+        m_CacheStats.BufferBytes -= sound.BufferSize;
+        m_CacheStats.SampleBytes -= sound.Samples.size();
+    }
+
+    // Release the memory instead of just clearing it.
+    sound.Samples = {};
+    sound.Buffer.Delete();
+    sound.BufferSize = 0;
+    sound.LoadState = SoundLoadState::NotLoaded;
+}
+
+void SoundCache::EvictUnusedSounds( std::span<const SoundIndex> soundsInUse )
+{
+    std::vector<bool> inUse( m_Sounds.size() );
+
+    for( const auto index : soundsInUse )
+    {
+        if( const int i = index.Index - 1; i >= 0 && static_cast<std::size_t>( i ) < inUse.size() )
+        {
+            inUse[i] = true;
+        }
+    }
+
+    std::vector<std::size_t> candidates;
+
+    for( std::size_t i = 0; i < m_Sounds.size(); ++i )
+    {
+        if( m_Sounds[i].LoadState == SoundLoadState::Loaded && !inUse[i] )
+        {
+            candidates.push_back( i );
+        }
+    }
+
+    std::sort( candidates.begin(), candidates.end(), [this]( auto lhs, auto rhs )
+        { return m_Sounds[lhs].LastUsed < m_Sounds[rhs].LastUsed; } );
+
+    std::size_t evictedCount = 0;
+
+    for( const auto i : candidates )
+    {
+        if( !IsOverBudget() )
+        {
+            break;
+        }
+
+        UnloadSound( m_Sounds[i] );
+        ++evictedCount;
+    }
+
+    if( evictedCount > 0 )
+    {
+        m_CacheStats.EvictedCount += evictedCount;
+        m_Logger->debug( "Evicted {} sounds, {} bytes in use (budget {} bytes)", evictedCount,
+            m_CacheStats.BufferBytes + m_CacheStats.SampleBytes, m_MemoryBudget );
+    }
+}
+
+void SoundCache::Decode( nqr::NyquistIO& loader, DecodedSound& result )
+{
+    const auto& absolutePath = result.Job.AbsolutePath;
+
+    try
+    {
+        loader.Load( &result.Data, absolutePath );
+    }
+    catch ( const std::exception& e )
+    {
+        result.Logger.error( "Error loading sound file {}: {}", absolutePath, e.what() );
+        return;
+    }
+
+    result.CuePoints = TryLoadCuePoints( absolutePath, result.Data.samples.size(), result.Data.channelCount, result.Logger );
+
+    ConvertSamples( result );
+
+    result.Success = true;
+}
+
+void SoundCache::ConvertSamples( DecodedSound& result )
+{
+    auto& data = result.Data;
+
+    switch( result.Job.Format )
+    {
+    case SampleFormat::Float32:
+        result.BytesPerSample = sizeof( float );
+        break;
+
+    case SampleFormat::Int16:
+        result.BytesPerSample = sizeof( std::int16_t );
+        break;
+
+    case SampleFormat::Native:
+        // OpenAL only supports 8 and 16 bit integer samples, so anything else is stored as 16 bit.
+        result.BytesPerSample = ( data.sourceFormat == nqr::PCM_U8 || data.sourceFormat == nqr::PCM_S8 ) ? 1 : 2;
+        break;
+    }
+
+    result.Samples.resize( data.samples.size() * result.BytesPerSample );
+
+    std::byte* dest = result.Samples.data();
+
+    switch( result.BytesPerSample )
+    {
+    case 1:
+    {
+        // 8 bit samples are unsigned in OpenAL.
+        for( const float sample : data.samples )
+        {
+            *dest++ = static_cast<std::byte>( std::clamp( static_cast<int>( std::lround( sample * 127.f ) ) + 128, 0, 255 ) );
+        }
+        break;
+    }
+
+    case 2:
+    {
+        for( const float sample : data.samples )
+        {
+            const auto converted = static_cast<std::int16_t>( std::clamp( 
+                static_cast<int>( std::lround( sample * 32767.f ) ), -32768, 32767 ) );
+            std::memcpy( dest, &converted, sizeof( converted ) );
+            dest += sizeof( converted );
+        }
+        break;
+    }
+
+    default:
+        std::memcpy( dest, data.samples.data(), result.Samples.size() );
+        break;
+    }
+
+    // Free the float samples now; they can be several times larger than the converted ones.
+    data.samples = {};
+}
+
+void SoundCache::RunLoader()
+{
+    // Each thread needs its own decoder.
+    nqr::NyquistIO loader;
+
+    while( true )
+    {
+        auto decoded = std::make_unique<DecodedSound>();
+
+        {
+            std::unique_lock lock{m_QueueMutex};
+
+            m_QueueCondition.wait( lock, [this]
+                { return m_Quit || !m_DecodeQueue.empty(); } );
+
+            if( m_Quit )
+            {
+                return;
+            }
+
+            decoded->Job = std::move( m_DecodeQueue.front() );
+            m_DecodeQueue.pop_front();
+        }
+
+        // Can't log here since we're on a loader thread; messages are logged when the sound is uploaded.
+        decoded->Logger = DeferredLogger{decoded->Job.LogLevel};
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        Decode( loader, *decoded );
+
+        decoded->DecodeTime = std::chrono::high_resolution_clock::now() - start;
+
+        std::lock_guard lock{m_DecodedMutex};
+        m_Decoded.push_back( std::move( decoded ) );
+    }
+}
+
+void SoundCache::CancelPendingLoads()
+{
+    ++m_Generation;
+
+    {
+        std::lock_guard lock{m_QueueMutex};
+        m_DecodeQueue.clear();
+    }
+
+    {
+        std::lock_guard lock{m_DecodedMutex};
+        m_Decoded.clear();
+    }
+
+    m_PendingUploads.clear();
+}
+
+SoundCache::LoaderStats SoundCache::GetStats()
+{
+    LoaderStats stats = m_Stats;
+
+    {
+        std::lock_guard lock{m_QueueMutex};
+        stats.QueueDepth = m_DecodeQueue.size();
+    }
+
+    {
+        std::lock_guard lock{m_DecodedMutex};
+        stats.PendingUploads = m_PendingUploads.size() + m_Decoded.size();
+    }
+
+    return stats;
+}
+
+void SoundCache::DeferredLogger::Flush( spdlog::logger& logger )
+{
+    for( const auto& [level, message] : m_Messages )
+    {
+        logger.log( level, message );
+    }
+
+    m_Messages.clear();
+}
+
 void SoundCache::ClearBuffers()
 {
+    CancelPendingLoads();
+
     for( auto& sound : m_Sounds )
     {
-        sound.Samples.clear();
-        sound.Buffer.Delete();
+        UnloadSound( sound );
     }
 }
 
 void SoundCache::Clear()
 {
+    CancelPendingLoads();
+
+    m_CacheStats.LoadedCount = 0;
+    m_CacheStats.BufferBytes = 0;
+    m_CacheStats.SampleBytes = 0;
+
     m_SoundLookup.clear();
     m_Sounds.clear();
 }
 
 std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints( 
-    const std::string& fileName, ALint sampleCount, int channelCount )
+    const std::string& fileName, ALint sampleCount, int channelCount, DeferredLogger& logger )
 {
-    m_Logger->trace( "Trying to load loop info from file \"{}\"", fileName );
+    logger.trace( "Trying to load loop info from file \"{}\"", fileName );
 
     if( !fileName.ends_with( CuePointExtension ) )
     {
-        m_Logger->trace( "File \"{}\" does not have the {} extension, ignoring", fileName, CuePointExtension );
+        logger.trace( "File \"{}\" does not have the {} extension, ignoring", fileName, CuePointExtension );
         return {};
     }
 
@@ -184,7 +700,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( !file )
     {
-        m_Logger->error( "Couldn't open file \"{}\" for reading", fileName );
+        logger.error( "Couldn't open file \"{}\" for reading", fileName );
         return {};
     }
 
@@ -193,7 +709,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( size < 0 )
     {
-        m_Logger->error( "Error seeking file \"{}\"", fileName );
+        logger.error( "Error seeking file \"{}\"", fileName );
         return {};
     }
 
@@ -205,7 +721,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( fread( data.data(), 1, size, file.get() ) != static_cast<std::size_t>( size ) )
     {
-        m_Logger->error( "Error reading file \"{}\"", fileName );
+        logger.error( "Error reading file \"{}\"", fileName );
         return {};
     }
 
@@ -215,7 +731,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( !fileReader )
     {
-        m_Logger->error( "Not a wave file: \"{}\"", fileName );
+        logger.error( "Not a wave file: \"{}\"", fileName );
         return {};
     }
 
@@ -227,13 +743,13 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
     if( !fmtChunk )
     {
         // Should never happen since the file was already loaded before.
-        m_Logger->error( "Wave file \"{}\" missing fmt chunk", fileName );
+        logger.error( "Wave file \"{}\" missing fmt chunk", fileName );
         return {};
     }
 
     if( fmtChunk->Size < 16 )
     {
-        m_Logger->error( "Wave file \"{}\" has bad fmt chunk", fileName );
+        logger.error( "Wave file \"{}\" has bad fmt chunk", fileName );
         return {};
     }
 
@@ -241,7 +757,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( bitDepth < 0 )
     {
-        m_Logger->error( "Wave file \"{}\" has bad bit depth {}", fileName, bitDepth );
+        logger.error( "Wave file \"{}\" has bad bit depth {}", fileName, bitDepth );
         return {};
     }
 
@@ -255,7 +771,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( !cueChunk )
     {
-        m_Logger->debug( "No cue chunk in file \"{}\"", fileName );
+        logger.debug( "No cue chunk in file \"{}\"", fileName );
         return {};
     }
 
@@ -278,7 +794,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
     // Convert loop start from bytes to 32 bit float samples.
     std::tuple<ALint, ALint> loopPoints = {convertRawSampleCount( cuePositionInBytes ), sampleCount / channelCount};
 
-    m_Logger->trace( "Loaded loop start point {} from file \"{}\"", std::get<0>( loopPoints ), fileName );
+    logger.trace( "Loaded loop start point {} from file \"{}\"", std::get<0>( loopPoints ), fileName );
 
     // See if there's a list chunk containing an associated data list following the cue chunk.
     // See https://www.recordingblogs.com/wiki/associated-data-list-chunk-of-a-wave-file for more information.
@@ -306,7 +822,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( ltxtChunk->Size < 12 )
     {
-        m_Logger->error( "Wave file \"{}\" has bad ltxt subchunk", fileName );
+        logger.error( "Wave file \"{}\" has bad ltxt subchunk", fileName );
         return loopPoints;
     }
 
@@ -314,7 +830,7 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( purposeId != "mark" )
     {
-        m_Logger->debug( "Wave file \"{}\" has ltxt subchunk with purpose ID \"{}\" (expected \"mark\")", fileName, purposeId );
+        logger.debug( "Wave file \"{}\" has ltxt subchunk with purpose ID \"{}\" (expected \"mark\")", fileName, purposeId );
         return loopPoints;
     }
 
@@ -325,14 +841,14 @@ std::optional<std::tuple<ALint, ALint>> SoundCache::TryLoadCuePoints(
 
     if( loopSampleCount == 0 )
     {
-        m_Logger->debug( "Wave file \"{}\" has bad loop length value {}, falling back to total sample length",
+        logger.debug( "Wave file \"{}\" has bad loop length value {}, falling back to total sample length",
             fileName, remainingSampleCount );
         loopSampleCount = sampleCount - convertRawSampleCount( cuePositionInBytes );
     }
 
     std::get<1>( loopPoints ) = loopSampleCount;
 
-    m_Logger->trace( "Loaded loop end point {} from file \"{}\"", std::get<1>( loopPoints ), fileName );
+    logger.trace( "Loaded loop end point {} from file \"{}\"", std::get<1>( loopPoints ), fileName );
 
     return loopPoints;
 }
@@ -15,13 +15,23 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include <fmt/format.h>
+
 #include <spdlog/logger.h>
 
 #include <libnyquist/Decoders.h>
@@ -35,10 +45,103 @@ namespace sound
 {
 /**
  *    @brief Maintains a cache of sounds and provides a means of loading them.
+ *    @details Sounds are decoded on a pool of loader threads and uploaded to OpenAL on the main thread.
+ *    Sounds can also be loaded synchronously with @c LoadSound.
  */
 class SoundCache final
 {
+public:
+    struct LoaderStats
+    {
+        std::size_t QueueDepth = 0;
+        std::size_t PeakQueueDepth = 0;
+        std::size_t PendingUploads = 0;
+        std::uint64_t DecodedCount = 0;
+        std::uint64_t FailedCount = 0;
+        std::chrono::duration<double> WorstDecodeTime{};
+        std::chrono::duration<double> WorstUploadTime{};
+    };
+
+    struct CacheStats
+    {
+        std::size_t LoadedCount = 0;
+        std::size_t BufferBytes = 0;
+        std::size_t SampleBytes = 0;
+        std::uint64_t EvictedCount = 0;
+    };
+
 private:
+    static constexpr unsigned int MaxLoaderThreads = 4;
+
+    /**
+     *    @brief Collects log messages on loader threads so they can be logged on the main thread.
+     */
+    class DeferredLogger final
+    {
+    public:
+        explicit DeferredLogger( spdlog::level::level_enum level = spdlog::level::off )
+            : m_Level( level )
+        {
+        }
+
+        template <typename... Args>
+        void trace( fmt::format_string<Args...> format, Args&&... args )
+        {
+            Log( spdlog::level::trace, format, std::forward<Args>( args )... );
+        }
+
+        template <typename... Args>
+        void debug( fmt::format_string<Args...> format, Args&&... args )
+        {
+            Log( spdlog::level::debug, format, std::forward<Args>( args )... );
+        }
+
+        template <typename... Args>
+        void error( fmt::format_string<Args...> format, Args&&... args )
+        {
+            Log( spdlog::level::err, format, std::forward<Args>( args )... );
+        }
+
+        void Flush( spdlog::logger& logger );
+
+    private:
+        template <typename... Args>
+        void Log( spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args )
+        {
+            if( level >= m_Level )
+            {
+                m_Messages.emplace_back( level, fmt::format( format, std::forward<Args>( args )... ) );
+            }
+        }
+
+    private:
+        spdlog::level::level_enum m_Level;
+        std::vector<std::pair<spdlog::level::level_enum, std::string>> m_Messages;
+    };
+
+    struct DecodeJob
+    {
+        std::size_t Index = 0;
+        std::uint32_t Generation = 0;
+        std::string AbsolutePath;
+        spdlog::level::level_enum LogLevel = spdlog::level::off;
+        SampleFormat Format = SampleFormat::Native;
+        // Only reload the CPU copy of the samples for a sound that is already loaded.
+        bool SamplesOnly = false;
+    };
+
+    struct DecodedSound
+    {
+        DecodeJob Job;
+        bool Success = false;
+        nqr::AudioData Data; // Float samples are released once they've been converted.
+        std::vector<std::byte> Samples;
+        int BytesPerSample = 0;
+        std::optional<std::tuple<ALint, ALint>> CuePoints;
+        DeferredLogger Logger;
+        std::chrono::duration<double> DecodeTime{};
+    };
+
     // Comparer that allows us to access the sound name in the set without making copies.
     struct LookupComparer
     {
@@ -70,20 +173,102 @@ private:
 
 public:
     explicit SoundCache( std::shared_ptr<spdlog::logger> logger );
+    ~SoundCache();
+
+    SoundCache( const SoundCache& ) = delete;
+    SoundCache& operator=( const SoundCache& ) = delete;
 
     SoundIndex FindName( const RelativeFilename& fileName );
 
     Sound* GetSound( SoundIndex index );
 
+    /**
+     *    @brief Loads the sound on the calling thread if it hasn't been loaded yet.
+     */
     bool LoadSound( Sound& sound );
 
+    /**
+     *    @brief Queues a sound to be decoded on a loader thread.
+     *    @param urgent Whether to decode this sound before sounds that were queued ahead of time.
+     */
+    void QueueLoad( SoundIndex index, bool urgent = false );
+
+    /**
+     *    @brief Returns whether a sound is ready to play without blocking.
+     *    If it isn't, it is queued with priority so it can be played as soon as possible.
+     */
+    bool RequestSound( SoundIndex index );
+
+    /**
+     *    @brief Makes sure the CPU copy of a sound's samples is kept so it can be used to move mouths.
+     *    If the sound was already loaded without it, the samples are reloaded in the background.
+     */
+    void RequestSamples( SoundIndex index, bool async );
+
+    /**
+     *    @brief Sets the format used for sounds loaded from now on.
+     */
+    void SetSampleFormat( SampleFormat format )
+    {
+        m_SampleFormat = format;
+    }
+
+    /**
+     *    @brief Sets the amount of memory sounds may use before unused sounds are evicted. 0 means no limit.
+     */
+    void SetMemoryBudget( std::size_t bytes )
+    {
+        m_MemoryBudget = bytes;
+    }
+
+    bool IsOverBudget() const
+    {
+        return m_MemoryBudget > 0 && ( m_CacheStats.BufferBytes + m_CacheStats.SampleBytes ) > m_MemoryBudget;
+    }
+
+    /**
+     *    @brief Unloads the least recently used sounds until the cache is within its memory budget.
+     *    @param soundsInUse Sounds that are playing or about to play and must not be evicted.
+     */
+    void EvictUnusedSounds( std::span<const SoundIndex> soundsInUse );
+
+    /**
+     *    @brief Uploads decoded sounds to OpenAL until @p budget has been used up.
+     *    At least one sound is uploaded if any are waiting so loading always makes progress.
+     */
+    void Update( std::chrono::duration<double> budget );
+
     void ClearBuffers();
 
     void Clear();
 
+    LoaderStats GetStats();
+
+    const CacheStats& GetCacheStats() const { return m_CacheStats; }
+
+    SampleFormat GetSampleFormat() const { return m_SampleFormat; }
+
+    std::size_t GetMemoryBudget() const { return m_MemoryBudget; }
+
 private:
-    std::optional<std::tuple<ALint, ALint>> TryLoadCuePoints( 
-        const std::string& fileName, ALint sampleCount, int channelCount );
+    std::optional<std::string> GetAbsolutePath( const Sound& sound );
+
+    void CancelPendingLoads();
+
+    void PushJob( DecodeJob&& job, bool urgent );
+
+    void UnloadSound( Sound& sound );
+
+    void RunLoader();
+
+    static void Decode( nqr::NyquistIO& loader, DecodedSound& result );
+
+    static void ConvertSamples( DecodedSound& result );
+
+    bool UploadSound( Sound& sound, DecodedSound& decoded );
+
+    static std::optional<std::tuple<ALint, ALint>> TryLoadCuePoints( 
+        const std::string& fileName, ALint sampleCount, int channelCount, DeferredLogger& logger );
 
 private:
     std::shared_ptr<spdlog::logger> m_Logger;
@@ -92,5 +277,28 @@ private:
     std::set<std::size_t, LookupComparer> m_SoundLookup{LookupComparer{&m_Sounds}};
 
     std::unique_ptr<nqr::NyquistIO> m_Loader;
+
+    // Incremented whenever the cache is cleared so results for sounds that no longer exist are ignored.
+    std::uint32_t m_Generation = 0;
+
+    SampleFormat m_SampleFormat = SampleFormat::Native;
+    std::size_t m_MemoryBudget = 0;
+    std::uint64_t m_UseCounter = 0;
+
+    std::vector<std::thread> m_LoaderThreads;
+
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueCondition;
+    std::deque<DecodeJob> m_DecodeQueue;
+    bool m_Quit = false;
+
+    std::mutex m_DecodedMutex;
+    std::vector<std::unique_ptr<DecodedSound>> m_Decoded;
+
+    // Only accessed on the main thread.
+    std::deque<std::unique_ptr<DecodedSound>> m_PendingUploads;
+
+    LoaderStats m_Stats;
+    CacheStats m_CacheStats;
 };
 }
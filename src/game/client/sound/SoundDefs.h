@@ -15,7 +15,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <variant>
+#include <vector>
 
 #include <EASTL/fixed_vector.h>
 
@@ -102,6 +106,25 @@ struct SoundIndex final
     int Index = InvalidIndex;
 };
 
+/**
+ *    @brief How sound samples are stored, both in OpenAL buffers and in memory.
+ */
+enum class SampleFormat
+{
+    Float32 = 0,
+    Int16,
+    Native // 8 bit sounds are kept as 8 bit, everything else is stored as 16 bit.
+};
+
+enum class SoundLoadState
+{
+    NotLoaded = 0,
+    Queued,       // Waiting for a loader thread to decode it.
+    QueuedUrgent, // Queued, and something is waiting to play it.
+    Loaded,
+    Failed
+};
+
 /**
  *    @brief A single sound.
  *    @details Sounds should always be referred to using a @see SoundIndex.
@@ -111,8 +134,20 @@ struct Sound
     RelativeFilename Name;
     OpenALBuffer Buffer;
     ALenum Format = 0;
-    std::vector<float> Samples; // For sentences, to update mouths.
+    int ChannelCount = 0;
+    int BytesPerSample = 0;
+    std::size_t BufferSize = 0;
+
+    // Copy of the samples in the buffer's format. Only kept for sounds that need it,
+    // like sentence words for time compression and sounds that move mouths.
+    std::vector<std::byte> Samples;
+    bool KeepSamples{false};
+
     bool IsLooping{false};
+    SoundLoadState LoadState{SoundLoadState::NotLoaded};
+
+    // Used to evict the least recently used sounds first.
+    std::uint64_t LastUsed = 0;
 
     explicit Sound( const RelativeFilename& filename )
         : Name( filename )
@@ -121,6 +156,38 @@ struct Sound
 
     Sound( Sound&& ) = default;
     Sound& operator=( Sound&& ) = default;
+
+    std::size_t GetSampleCount() const
+    {
+        return BytesPerSample > 0 ? Samples.size() / BytesPerSample : 0;
+    }
+
+    /**
+     *    @brief Gets a sample from the CPU copy of the sound, in the range [-1, 1].
+     */
+    float GetSample( std::size_t index ) const
+    {
+        const std::byte* data = Samples.data() + ( index * BytesPerSample );
+
+        switch( BytesPerSample )
+        {
+        case 1: return ( std::to_integer<int>( *data ) - 128 ) / 128.f;
+
+        case 2:
+        {
+            std::int16_t sample;
+            std::memcpy( &sample, data, sizeof( sample ) );
+            return sample / 32768.f;
+        }
+
+        default:
+        {
+            float sample;
+            std::memcpy( &sample, data, sizeof( sample ) );
+            return sample;
+        }
+        }
+    }
 };
 
 struct SentenceWord
@@ -54,6 +54,11 @@
 #include "config/sections/SuitLightTypeSection.h"
 
 #include "entities/EntityClassificationSystem.h"
+#include "entities/EntityNameIndex.h"
+#include "entities/EntityPartition.h"
+#include "entities/ModelSequenceIndex.h"
+#include "entities/NPCs/MonsterThinkLOD.h"
+#include "entities/NPCs/MonsterVisibilitySystem.h"
 
 #include "gamerules/MapCycleSystem.h"
 #include "gamerules/PersistentInventorySystem.h"
@@ -124,6 +129,9 @@ bool ServerLibrary::Initialize()
     g_ConCommands.CreateCommand( "stop_loading_all_maps", [this]( const auto& )
         { m_MapsToLoad.clear(); } );
 
+    g_ConCommands.CreateCommand( "saverestore_benchmark", [this]( const auto& args )
+        { BenchmarkSaveRestore( args ); } );
+
     g_ConCommands.RegisterChangeCallback( &sv_allowbunnyhopping, []( const auto& state )
         {
             const bool allowBunnyHopping = state.Cvar->value != 0;
@@ -197,6 +205,13 @@ void ServerLibrary::RunFrame()
 
     g_Bots.RunFrame();
 
+    g_MonsterVisibility.RunFrame();
+    g_MonsterThinkLOD.RunFrame();
+
+    WorldGraph.LogFrameStats();
+
+    CSaveRestoreBuffer::LogTokenTableStats();
+
     // If we're loading all maps then change maps after 3 seconds (time starts at 1)
     // to give the game time to generate files.
     if( !m_MapsToLoad.empty() && gpGlobals->time > 4 )
@@ -281,6 +296,12 @@ void ServerLibrary::NewMapStarted( bool loadGame )
 
     ClearStringPool();
 
+    g_EntityPartition.Clear();
+    g_EntityNameIndex.Clear();
+    g_ModelSequenceIndex.Clear();
+    g_MonsterVisibility.Clear();
+    g_MonsterThinkLOD.Clear();
+
     // Initialize map state to its default state
     *m_MapState = MapState{};
 
@@ -387,6 +408,8 @@ void ServerLibrary::AddGameSystems()
     g_GameSystems.Add( &g_MapCycleSystem );
     g_GameSystems.Add( &g_EntityTemplates );
     g_GameSystems.Add( &g_Bots );
+    g_GameSystems.Add( &g_MonsterVisibility );
+    g_GameSystems.Add( &g_MonsterThinkLOD );
 }
 
 void ServerLibrary::SetEntLogLevels( spdlog::level::level_enum level )
@@ -645,6 +668,8 @@ void ServerLibrary::LoadServerConfigFiles( const WorldConfig& MapConfiguration )
 
     g_GameMode->OnMapInit();
 
+    g_ConditionEvaluator.LogStatistics();
+
     const auto timeElapsed = std::chrono::high_resolution_clock::now() - start;
 
     g_GameLogger->trace( "Server configurations loaded in {}ms",
@@ -767,6 +792,170 @@ void ServerLibrary::LoadNextMap()
     SERVER_COMMAND(fmt::format("map \"{}\"\n", mapName).c_str());
 }
 
+void ServerLibrary::BenchmarkSaveRestore( const CommandArgs& args )
+{
+    auto edicts = UTIL_GetEntityList();
+
+    if( !edicts || !m_HasFinishedLoading )
+    {
+        Con_Printf( "A map must be running to benchmark save/restore\n" );
+        return;
+    }
+
+    const int iterations = args.Count() > 1 ? std::max( 1, atoi( args.Argument( 1 ) ) ) : 10;
+
+    constexpr int BufferSize = 32 * 1024 * 1024;
+    constexpr int TokenCount = 0xfff;
+
+    std::vector<char> buffer( BufferSize );
+    std::vector<char*> tokens( TokenCount );
+    std::vector<ENTITYTABLE> table( gpGlobals->maxEntities );
+    std::vector<CBaseEntity*> entities;
+
+    for( int i = 0; i < gpGlobals->maxEntities; ++i )
+    {
+        table[i].id = i;
+        table[i].pent = &edicts[i];
+
+        if( 0 == edicts[i].free )
+        {
+            if( auto entity = CBaseEntity::Instance( &edicts[i] ); entity )
+            {
+                table[i].classname = entity->pev->classname;
+                entities.push_back( entity );
+            }
+        }
+    }
+
+    SAVERESTOREDATA data{};
+
+    data.pBaseData = buffer.data();
+    data.bufferSize = BufferSize;
+    data.tokenCount = TokenCount;
+    data.pTokens = tokens.data();
+    data.tableCount = gpGlobals->maxEntities;
+    data.pTable = table.data();
+    data.time = gpGlobals->time;
+    strncpy( data.szCurrentMapName, STRING( gpGlobals->mapname ), sizeof( data.szCurrentMapName ) - 1 );
+
+    const auto entvarsMap = entvars_t::GetLocalDataMap();
+
+    entvars_t scratchVars;
+    std::vector<CBaseEntity*> scratchEntities( entities.size() );
+
+    std::chrono::high_resolution_clock::duration saveTime{};
+    std::chrono::high_resolution_clock::duration restoreTime{};
+    int savedBytes = 0;
+
+    for( int iteration = 0; iteration < iterations; ++iteration )
+    {
+        data.pCurrentData = data.pBaseData;
+        data.size = 0;
+
+        const auto saveStart = std::chrono::high_resolution_clock::now();
+
+        // Only the data map fields are written, custom Save overrides are skipped so the data can be read back generically.
+        for( auto entity : entities )
+        {
+            const int index = entity->entindex();
+
+            data.currentIndex = index;
+            table[index].location = data.size;
+
+            CSave save{data};
+
+            if( save.WriteFields( entity->pev, *entvarsMap, *entvarsMap ) )
+            {
+                const auto completeDataMap = entity->GetDataMap();
+
+                for( auto dataMap = completeDataMap; dataMap; dataMap = dataMap->BaseMap )
+                {
+                    save.WriteFields( entity, *completeDataMap, *dataMap );
+                }
+            }
+
+            table[index].size = data.size - table[index].location;
+
+            if( save.HasOverflowed() )
+            {
+                Con_Printf( "Save/restore benchmark buffer overflowed\n" );
+                return;
+            }
+        }
+
+        savedBytes = data.size;
+
+        // Restore into freshly constructed objects of the same class so members with non-trivial types are valid.
+        // OnCreate is not called since it expects a live edict.
+        for( std::size_t i = 0; i < entities.size(); ++i )
+        {
+            if( auto descriptor = g_EntityDictionary->Find( STRING( entities[i]->pev->classname ) ); descriptor )
+            {
+                scratchEntities[i] = descriptor->Create();
+                scratchEntities[i]->pev = &scratchVars;
+            }
+        }
+
+        const auto restoreStart = std::chrono::high_resolution_clock::now();
+
+        for( std::size_t i = 0; i < entities.size(); ++i )
+        {
+            auto scratchEntity = scratchEntities[i];
+
+            if( !scratchEntity )
+            {
+                continue;
+            }
+
+            const int index = entities[i]->entindex();
+
+            data.currentIndex = index;
+            data.pCurrentData = data.pBaseData + table[index].location;
+            data.size = table[index].location;
+
+            CRestore restore{data};
+            restore.PrecacheMode( false );
+
+            if( restore.ReadFields( &scratchVars, *entvarsMap, *entvarsMap ) )
+            {
+                const auto completeDataMap = scratchEntity->GetDataMap();
+
+                for( auto dataMap = completeDataMap; dataMap; dataMap = dataMap->BaseMap )
+                {
+                    restore.ReadFields( scratchEntity, *completeDataMap, *dataMap );
+                }
+            }
+        }
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        for( auto& scratchEntity : scratchEntities )
+        {
+            delete scratchEntity;
+            scratchEntity = nullptr;
+        }
+
+        saveTime += restoreStart - saveStart;
+        restoreTime += end - restoreStart;
+    }
+
+    const auto toSeconds = []( auto duration )
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>( duration ).count();
+    };
+
+    const double totalEntities = static_cast<double>( entities.size() ) * iterations;
+    const double saveSeconds = toSeconds( saveTime );
+    const double restoreSeconds = toSeconds( restoreTime );
+
+    Con_Printf( "Save/restore benchmark: %zu entities, %d iterations, %d bytes per pass\n",
+        entities.size(), iterations, savedBytes );
+    Con_Printf( "Save: %.3f ms total, %.0f entities/sec\n",
+        saveSeconds * 1000.0, saveSeconds > 0 ? totalEntities / saveSeconds : 0.0 );
+    Con_Printf( "Restore: %.3f ms total, %.0f entities/sec\n",
+        restoreSeconds * 1000.0, restoreSeconds > 0 ? totalEntities / restoreSeconds : 0.0 );
+}
+
 bool ServerLibrary::CanPlayerConnect( edict_t* ent, const char* name, const char* address, char reason[128] )
 {
     g_pGameRules->ClientConnected(ent, name, address, reason);
@@ -129,6 +129,12 @@ private:
 
     void LoadNextMap();
 
+    /**
+     *    @brief Saves and restores the fields of every entity in the current map to measure save/restore throughput.
+     *    Entities are restored into scratch memory so the map is left untouched.
+     */
+    void BenchmarkSaveRestore( const CommandArgs& args );
+
 private:
     cvar_t* m_AllowDownload{};
     cvar_t* m_SendResources{};
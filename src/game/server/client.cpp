@@ -1551,8 +1551,10 @@ int AddToFullPack( entity_state_t* state, int e, edict_t* ent, edict_t* host, in
             // Remove the night vision illumination effect so other players don't see it
             state->effects &= ~EF_BRIGHTLIGHT;
 
+            static const ConfigVarHandle PlayerCollision{"player_collision"sv};
+
             // Set nocliping if players touching each others
-            if( !g_cfg.GetValue<bool>( "player_collision"sv, true )
+            if( !g_cfg.GetValue<bool>( PlayerCollision, true )
             && entity->IsPlayer()
             && pHost->IsAlive()
             && pHost->Intersects( entity )
@@ -115,18 +115,93 @@ bool ConditionEvaluator::Initialize()
 
 void ConditionEvaluator::Shutdown()
 {
+    // Modules have to be discarded before the engine is destroyed.
+    m_Conditionals.clear();
     m_ScriptContext.reset();
     m_ScriptEngine.reset();
     m_Logger.reset();
 }
 
+ConditionEvaluator::InputState ConditionEvaluator::GetInputState()
+{
+    InputState state;
+
+#ifndef CLIENT_DLL
+    state.Multiplayer = g_GameMode.gamemode && g_GameMode->IsMultiplayer();
+    state.DedicatedServer = IS_DEDICATED_SERVER() != 0;
+
+    if( g_pGameRules )
+    {
+        state.GameMode = g_pGameRules->GetGameModeName();
+    }
+#endif
+
+    return state;
+}
+
 std::optional<bool> ConditionEvaluator::Evaluate( std::string_view conditional )
 {
-    // Create a temporary module to evaluate the conditional with
-    const as::ModulePtr module{g_ASManager.CreateModule( *m_ScriptEngine, "gamecfg_conditional" )};
+    ++m_Statistics.Evaluations;
 
-    if( !module )
+    if( auto state = GetInputState(); state != m_InputState )
+    {
+        m_Logger->debug( "Game mode or server type changed, discarding cached conditional results" );
+
+        for( auto& [text, compiled] : m_Conditionals )
+        {
+            compiled.Result.reset();
+        }
+
+        m_InputState = std::move( state );
+    }
+
+    auto& compiled = Compile( conditional );
+
+    if( !compiled.Function )
+    {
+        m_Logger->trace( "Conditional \"{}\" failed to compile previously", conditional );
         return {};
+    }
+
+    if( compiled.Result.has_value() )
+    {
+        ++m_Statistics.ResultHits;
+        return compiled.Result;
+    }
+
+    compiled.Result = Execute( *compiled.Function );
+
+    return compiled.Result;
+}
+
+void ConditionEvaluator::LogStatistics()
+{
+    m_Logger->debug( "{} conditionals evaluated: {} compiled, {} compile cache hits, {} result cache hits ({} cached conditionals)",
+        m_Statistics.Evaluations, m_Statistics.Compilations, m_Statistics.CompiledHits, m_Statistics.ResultHits, m_Conditionals.size() );
+
+    m_Statistics = {};
+}
+
+ConditionEvaluator::CompiledConditional& ConditionEvaluator::Compile( std::string_view conditional )
+{
+    if( auto it = m_Conditionals.find( conditional ); it != m_Conditionals.end() )
+    {
+        ++m_Statistics.CompiledHits;
+        return it->second;
+    }
+
+    ++m_Statistics.Compilations;
+
+    // Failed conditionals are cached too so errors are only reported once.
+    auto& compiled = m_Conditionals.emplace( std::string{conditional}, CompiledConditional{} ).first->second;
+
+    // Each conditional gets its own module so it can stay loaded alongside the others.
+    const auto moduleName = fmt::format( "gamecfg_conditional_{}", m_NextModuleId++ );
+
+    as::ModulePtr module{g_ASManager.CreateModule( *m_ScriptEngine, moduleName.c_str() )};
+
+    if( !module )
+        return compiled;
 
     // Wrap the conditional in a function we can call
     {
@@ -136,15 +211,21 @@ std::optional<bool> ConditionEvaluator::Evaluate( std::string_view conditional )
         const int addResult = module->AddScriptSection( "conditional", script.c_str(), script.size() );
 
         if( !g_ASManager.HandleAddScriptSectionResult( addResult, module->GetName(), "conditional" ) )
-            return {};
+            return compiled;
     }
 
     if( !g_ASManager.HandleBuildResult( module->Build(), module->GetName() ) )
-        return {};
+        return compiled;
 
-    const auto function = module->GetFunctionByName( "Evaluate" );
+    compiled.Function = module->GetFunctionByName( "Evaluate" );
+    compiled.Module = std::move( module );
 
-    if( !g_ASManager.PrepareContext( *m_ScriptContext, function ) )
+    return compiled;
+}
+
+std::optional<bool> ConditionEvaluator::Execute( asIScriptFunction& function )
+{
+    if( !g_ASManager.PrepareContext( *m_ScriptContext, &function ) )
         return {};
 
     // Since this is expected to run very quickly, use a line callback to handle timeout to prevent infinite loops from locking up the game
@@ -15,21 +15,28 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #include <spdlog/logger.h>
 
 #include "GameSystem.h"
+#include "heterogeneous_lookup.h"
 
 #include "scripting/AS/as_utils.h"
 
 class asIScriptContext;
+class asIScriptFunction;
 
 /**
  *    @brief Evaluates strings containing conditonal statements.
+ *    @details Conditionals are compiled once and kept for the lifetime of the evaluator.
+ *    Results are cached until one of the values the script API exposes changes.
  */
 struct ConditionEvaluator final : public IGameSystem
 {
@@ -46,11 +53,59 @@ struct ConditionEvaluator final : public IGameSystem
      */
     std::optional<bool> Evaluate( std::string_view conditional );
 
+    /**
+     *    @brief Logs how many conditionals were evaluated and compiled since the last call.
+     */
+    void LogStatistics();
+
+private:
+    /**
+     *    @brief Values that conditionals can depend on.
+     */
+    struct InputState
+    {
+        bool Multiplayer = false;
+        bool DedicatedServer = false;
+        std::string GameMode;
+
+        bool operator==( const InputState& ) const = default;
+    };
+
+    struct CompiledConditional
+    {
+        as::ModulePtr Module;
+
+        // Null if the conditional failed to compile.
+        asIScriptFunction* Function{};
+
+        std::optional<bool> Result;
+    };
+
+    struct Statistics
+    {
+        std::size_t Evaluations = 0;
+        std::size_t Compilations = 0;
+        std::size_t CompiledHits = 0;
+        std::size_t ResultHits = 0;
+    };
+
+    static InputState GetInputState();
+
+    CompiledConditional& Compile( std::string_view conditional );
+
+    std::optional<bool> Execute( asIScriptFunction& function );
+
 private:
     std::shared_ptr<spdlog::logger> m_Logger;
 
     as::EnginePtr m_ScriptEngine;
     as::UniquePtr<asIScriptContext> m_ScriptContext;
+
+    std::unordered_map<std::string, CompiledConditional, TransparentStringHash, TransparentEqual> m_Conditionals;
+    InputState m_InputState;
+    int m_NextModuleId = 0;
+
+    Statistics m_Statistics;
 };
 
 inline ConditionEvaluator g_ConditionEvaluator;
@@ -24,6 +24,7 @@
 #include "util.h"
 #include "DataMap.h"
 #include "EntityClassificationSystem.h"
+#include "EntityKeyValues.h"
 #include "ConfigurationSystem.h"
 
 class CBaseEntity;
@@ -38,7 +39,6 @@ class CTalkMonster;
 class CItemCTF;
 struct ReplacementMap;
 
-#define MAX_KEYVALUEMANAGER_ENTRIES 64 // Max entries for KeyValueManager
 
 #define MAX_PATH_SIZE 10 // max number of nodes available for a path.
 
@@ -195,6 +195,16 @@ public:
 
     const char* GetMessage() const { return STRING( pev->message ); }
 
+    /**
+     *    @brief Sets the classname and updates the entity name index.
+     *    @details Always use these instead of assigning to @c pev directly so lookups by name stay correct.
+     */
+    void SetClassname( string_t classname );
+
+    void SetTargetname( string_t targetname );
+
+    void SetTarget( string_t target );
+
     void SetOrigin( const Vector& origin );
 
     int PrecacheModel( const char* s );
@@ -701,28 +711,15 @@ public:
 
     bool m_uselos = false;
 
-private:
-
-    struct KeyValueManager
-    {
-        bool custom{false};
-
-        std::unordered_map<std::string, std::string> KeyValues;
-
-        int size{0}; // This is for SaveRestore. I should see how to implement std::vector support instead.
-        string_t m_Keys[MAX_KEYVALUEMANAGER_ENTRIES];
-        string_t m_Values[MAX_KEYVALUEMANAGER_ENTRIES];
-
-        std::string& GetValue( std::string_view key );
-        void SetValue( std::string_view key, std::string_view value );
-        void Save();
-        void Restore();
-    };
-
-public:
+    /**
+     *    @brief Every keyvalue the entity was spawned with. Only filled in if the map enables the keyvalue manager.
+     */
+    EntityKeyValues m_KeyValues;
 
-    KeyValueManager m_KeyValues{};
-    KeyValueManager m_CustomKeyValues{};
+    /**
+     *    @brief Custom keyvalues, whose names start with @c $. Always stored.
+     */
+    EntityKeyValues m_CustomKeyValues;
 };
 
 inline bool FNullEnt( CBaseEntity* ent ) { return ( ent == nullptr ) || FNullEnt( ent->edict() ); }
@@ -95,7 +95,7 @@ void CTriggerChangeKeyValue::Use( CBaseEntity* pActivator, CBaseEntity* pCaller,
 
         if( !FStringNull( m_changeTargetName ) )
         {
-            target->pev->target = m_changeTargetName;
+            target->SetTarget( m_changeTargetName );
         }
     }
 }
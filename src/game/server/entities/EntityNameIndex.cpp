@@ -0,0 +1,179 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+
+#include "cbase.h"
+#include "EntityNameIndex.h"
+
+constexpr int NameFieldCount = static_cast<int>( EntityNameField::Count );
+
+void EntityNameIndex::Clear()
+{
+    for( auto& map : m_Maps )
+    {
+        map.clear();
+    }
+
+    m_Names.clear();
+}
+
+string_t EntityNameIndex::GetName( const edict_t* pEdict, int field )
+{
+    if( 0 != pEdict->free )
+    {
+        return string_t::Null;
+    }
+
+    switch( static_cast<EntityNameField>( field ) )
+    {
+    case EntityNameField::Classname: return pEdict->v.classname;
+    case EntityNameField::Targetname: return pEdict->v.targetname;
+    case EntityNameField::Target: return pEdict->v.target;
+    default: return string_t::Null;
+    }
+}
+
+void EntityNameIndex::Insert( int field, string_t name, int index )
+{
+    if( FStringNull( name ) )
+    {
+        return;
+    }
+
+    auto& list = m_Maps[field][STRING( name )];
+    list.insert( std::lower_bound( list.begin(), list.end(), index ), index );
+}
+
+void EntityNameIndex::Erase( int field, string_t name, int index )
+{
+    if( FStringNull( name ) )
+    {
+        return;
+    }
+
+    auto& map = m_Maps[field];
+
+    if( auto it = map.find( std::string_view{STRING( name )} ); it != map.end() )
+    {
+        auto& list = it->second;
+
+        if( auto entry = std::lower_bound( list.begin(), list.end(), index ); entry != list.end() && *entry == index )
+        {
+            list.erase( entry );
+        }
+
+        if( list.empty() )
+        {
+            map.erase( it );
+        }
+    }
+}
+
+void EntityNameIndex::Update( edict_t* pEdict )
+{
+    const int index = pEdict - UTIL_GetEntityList();
+
+    if( index < 0 )
+    {
+        return;
+    }
+
+    if( index >= static_cast<int>( m_Names.size() ) )
+    {
+        m_Names.resize( index + 1 );
+    }
+
+    auto& names = m_Names[index];
+
+    for( int field = 0; field < NameFieldCount; ++field )
+    {
+        const string_t name = GetName( pEdict, field );
+
+        if( names.Values[field] == name )
+        {
+            continue;
+        }
+
+        Erase( field, names.Values[field], index );
+        Insert( field, name, index );
+        names.Values[field] = name;
+    }
+}
+
+void EntityNameIndex::Update( CBaseEntity* entity )
+{
+    if( entity )
+    {
+        Update( entity->edict() );
+    }
+}
+
+void EntityNameIndex::Remove( edict_t* pEdict )
+{
+    const int index = pEdict - UTIL_GetEntityList();
+
+    if( index < 0 || index >= static_cast<int>( m_Names.size() ) )
+    {
+        return;
+    }
+
+    auto& names = m_Names[index];
+
+    for( int field = 0; field < NameFieldCount; ++field )
+    {
+        Erase( field, names.Values[field], index );
+        names.Values[field] = string_t::Null;
+    }
+}
+
+int EntityNameIndex::FindInList( const IndexList& list, int startIndex )
+{
+    auto it = std::lower_bound( list.begin(), list.end(), startIndex );
+    return it != list.end() ? *it : -1;
+}
+
+int EntityNameIndex::FindNext( EntityNameField field, std::string_view name, bool prefix, int startIndex ) const
+{
+    const auto& map = m_Maps[static_cast<int>( field )];
+
+    if( !prefix )
+    {
+        if( auto it = map.find( name ); it != map.end() )
+        {
+            return FindInList( it->second, startIndex );
+        }
+
+        return -1;
+    }
+
+    // Names sharing the prefix are adjacent; pick whichever has the lowest matching edict.
+    int best = -1;
+
+    for( auto it = map.lower_bound( name ); it != map.end() && it->first.starts_with( name ); ++it )
+    {
+        if( const int index = FindInList( it->second, startIndex ); index != -1 && ( best == -1 || index < best ) )
+        {
+            best = index;
+
+            if( best == startIndex )
+            {
+                break;
+            }
+        }
+    }
+
+    return best;
+}
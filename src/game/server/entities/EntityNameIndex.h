@@ -0,0 +1,119 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "extdll.h"
+
+class CBaseEntity;
+
+enum class EntityNameField
+{
+    Classname = 0,
+    Targetname,
+    Target,
+    Count
+};
+
+/**
+ *    @brief Index of entities by classname, targetname and target.
+ *    @details Each name maps to the indices of the entities using it, sorted by edict index
+ *    so lookups return entities in the same order as a linear scan.
+ *    Names are kept in sorted order so prefix lookups only visit matching names.
+ *
+ *    Entities are reindexed after keyvalues are set, after spawning and restoring, when removed,
+ *    and whenever game code changes a name through CBaseEntity::SetClassname, SetTargetname or SetTarget.
+ */
+class EntityNameIndex final
+{
+public:
+    /**
+     *    @brief Removes all entities. Must be called whenever the string pool is cleared.
+     */
+    void Clear();
+
+    /**
+     *    @brief Reindexes @p pEdict if any of its names have changed.
+     */
+    void Update( edict_t* pEdict );
+
+    void Update( CBaseEntity* entity );
+
+    void Remove( edict_t* pEdict );
+
+    /**
+     *    @brief Finds the first entity after @p startIndex whose @p field matches @p name.
+     *    @param prefix If @c true, matches names starting with @p name.
+     *    @return Edict index of the entity, or -1 if there is none.
+     */
+    int FindNext( EntityNameField field, std::string_view name, bool prefix, int startIndex ) const;
+
+private:
+    // Sorted by edict index.
+    using IndexList = std::vector<int>;
+
+    // Keys are copies so they don't depend on the lifetime of pooled strings.
+    using NameMap = std::map<std::string, IndexList, std::less<>>;
+
+    struct IndexedNames
+    {
+        string_t Values[static_cast<int>( EntityNameField::Count )]{};
+    };
+
+    static string_t GetName( const edict_t* pEdict, int field );
+
+    static int FindInList( const IndexList& list, int startIndex );
+
+    void Insert( int field, string_t name, int index );
+    void Erase( int field, string_t name, int index );
+
+    NameMap m_Maps[static_cast<int>( EntityNameField::Count )];
+    std::vector<IndexedNames> m_Names;
+};
+
+inline EntityNameIndex g_EntityNameIndex;
+
+/**
+ *    @brief Updates the name index for an entity when the scope exits,
+ *    no matter which path the enclosing function returns from.
+ */
+class EntityNameIndexUpdater final
+{
+public:
+    explicit EntityNameIndexUpdater( edict_t*& pEdict )
+        : m_Edict( pEdict )
+    {
+    }
+
+    ~EntityNameIndexUpdater()
+    {
+        if( m_Edict )
+        {
+            g_EntityNameIndex.Update( m_Edict );
+        }
+    }
+
+    EntityNameIndexUpdater( const EntityNameIndexUpdater& ) = delete;
+    EntityNameIndexUpdater& operator=( const EntityNameIndexUpdater& ) = delete;
+
+private:
+    edict_t*& m_Edict;
+};
@@ -0,0 +1,187 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <cmath>
+
+#include "cbase.h"
+#include "EntityPartition.h"
+
+void EntityPartition::Clear()
+{
+    m_Cells.resize( GridDim * GridDim );
+
+    for( auto& cell : m_Cells )
+    {
+        cell.clear();
+    }
+
+    m_Oversized.clear();
+
+    m_Entries.clear();
+    m_Entries.resize( std::max( 0, gpGlobals->maxEntities ) );
+}
+
+int EntityPartition::CoordToCell( float value )
+{
+    // Entities outside the grid end up in the border cells; queries are clamped the same way.
+    const int cell = static_cast<int>( std::floor( ( value + GridExtent ) / CellSize ) );
+    return std::clamp( cell, 0, GridDim - 1 );
+}
+
+void EntityPartition::RemoveFromList( std::vector<int>& list, int index )
+{
+    if( auto it = std::find( list.begin(), list.end(), index ); it != list.end() )
+    {
+        *it = list.back();
+        list.pop_back();
+    }
+}
+
+void EntityPartition::Link( edict_t* pEdict )
+{
+    const int index = pEdict - UTIL_GetEntityList();
+
+    // The world covers everything and is never returned by queries.
+    if( index <= 0 )
+    {
+        return;
+    }
+
+    if( m_Cells.empty() )
+    {
+        Clear();
+    }
+
+    if( index >= static_cast<int>( m_Entries.size() ) )
+    {
+        m_Entries.resize( index + 1 );
+    }
+
+    const auto& vars = pEdict->v;
+
+    // Sphere queries test the origin on the X and Y axes, which isn't always inside the bounds.
+    CellRange range{
+        CoordToCell( std::min( vars.absmin.x, vars.origin.x ) ),
+        CoordToCell( std::min( vars.absmin.y, vars.origin.y ) ),
+        CoordToCell( std::max( vars.absmax.x, vars.origin.x ) ),
+        CoordToCell( std::max( vars.absmax.y, vars.origin.y ) )};
+
+    const bool oversized = ( range.MaxX - range.MinX ) >= MaxCellSpan || ( range.MaxY - range.MinY ) >= MaxCellSpan;
+
+    auto& entry = m_Entries[index];
+
+    entry.Origin = vars.origin.Make2D();
+
+    if( entry.Linked )
+    {
+        if( entry.Oversized == oversized && ( oversized || ( entry.Range.MinX == range.MinX && entry.Range.MinY == range.MinY && entry.Range.MaxX == range.MaxX && entry.Range.MaxY == range.MaxY ) ) )
+        {
+            // Still in the same cells.
+            entry.Range = range;
+            return;
+        }
+
+        Unlink( pEdict );
+    }
+
+    entry.Range = range;
+    entry.Linked = true;
+    entry.Oversized = oversized;
+
+    if( oversized )
+    {
+        m_Oversized.push_back( index );
+        return;
+    }
+
+    for( int y = range.MinY; y <= range.MaxY; ++y )
+    {
+        for( int x = range.MinX; x <= range.MaxX; ++x )
+        {
+            Cell( x, y ).push_back( index );
+        }
+    }
+}
+
+void EntityPartition::Unlink( edict_t* pEdict )
+{
+    const int index = pEdict - UTIL_GetEntityList();
+
+    if( index <= 0 || index >= static_cast<int>( m_Entries.size() ) )
+    {
+        return;
+    }
+
+    auto& entry = m_Entries[index];
+
+    if( !entry.Linked )
+    {
+        return;
+    }
+
+    entry.Linked = false;
+
+    if( entry.Oversized )
+    {
+        RemoveFromList( m_Oversized, index );
+        return;
+    }
+
+    for( int y = entry.Range.MinY; y <= entry.Range.MaxY; ++y )
+    {
+        for( int x = entry.Range.MinX; x <= entry.Range.MaxX; ++x )
+        {
+            RemoveFromList( Cell( x, y ), index );
+        }
+    }
+}
+
+bool EntityPartition::Query( float minX, float minY, float maxX, float maxY, CandidateList& candidates )
+{
+    if( m_Cells.empty() )
+    {
+        return false;
+    }
+
+    const int cellMinX = CoordToCell( minX );
+    const int cellMinY = CoordToCell( minY );
+    const int cellMaxX = CoordToCell( maxX );
+    const int cellMaxY = CoordToCell( maxY );
+
+    if( ( cellMaxX - cellMinX + 1 ) * ( cellMaxY - cellMinY + 1 ) > MaxQueryCells )
+    {
+        return false;
+    }
+
+    candidates.clear();
+
+    for( int y = cellMinY; y <= cellMaxY; ++y )
+    {
+        for( int x = cellMinX; x <= cellMaxX; ++x )
+        {
+            const auto& cell = Cell( x, y );
+            candidates.insert( candidates.end(), cell.begin(), cell.end() );
+        }
+    }
+
+    candidates.insert( candidates.end(), m_Oversized.begin(), m_Oversized.end() );
+
+    // Entities spanning several cells show up more than once.
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+    return true;
+}
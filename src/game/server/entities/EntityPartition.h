@@ -0,0 +1,104 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <vector>
+
+#include <EASTL/fixed_vector.h>
+
+#include "vector.h"
+
+struct edict_t;
+
+/**
+ *    @brief Loose 2D grid of all linked entities, used to accelerate box and sphere queries.
+ *    @details Entities are (re)inserted whenever the engine relinks them and sets their absolute bounds,
+ *    which covers @c UTIL_SetOrigin, @c SetSize and physics movement.
+ *    Queries return candidate edict indices in ascending order so callers see the same ordering as a linear scan.
+ *    Candidates are conservative: callers must still test the actual bounds.
+ *    Origins written without relinking the entity aren't picked up, so sphere tests must use @c GetLinkedOrigin.
+ */
+class EntityPartition final
+{
+public:
+    static constexpr int CellSize = 256;
+    static constexpr int GridExtent = 16384;
+    static constexpr int GridDim = ( GridExtent * 2 ) / CellSize;
+
+    /**
+     *    @brief Entities spanning more than this many cells on either axis are stored in a separate list
+     *    that every query checks.
+     */
+    static constexpr int MaxCellSpan = 8;
+
+    /**
+     *    @brief Queries covering more cells than this are cheaper to do as a linear scan.
+     */
+    static constexpr int MaxQueryCells = 1024;
+
+    using CandidateList = eastl::fixed_vector<int, 512>;
+
+    /**
+     *    @brief Removes all entities and sizes the partition for the current map's edict count.
+     */
+    void Clear();
+
+    /**
+     *    @brief Inserts or moves @p pEdict using its current absolute bounds and origin.
+     */
+    void Link( edict_t* pEdict );
+
+    void Unlink( edict_t* pEdict );
+
+    /**
+     *    @brief Gets the indices of all entities whose stored bounds may overlap the given 2D region.
+     *    @return @c false if the partition can't answer this query and the caller should do a linear scan.
+     */
+    bool Query( float minX, float minY, float maxX, float maxY, CandidateList& candidates );
+
+    /**
+     *    @brief Gets the 2D origin that the entity at @p index had when it was last linked.
+     *    Only valid for indices returned by @c Query.
+     */
+    Vector2D GetLinkedOrigin( int index ) const { return m_Entries[index].Origin; }
+
+private:
+    struct CellRange
+    {
+        int MinX, MinY, MaxX, MaxY;
+    };
+
+    struct Entry
+    {
+        CellRange Range{};
+        Vector2D Origin;
+        bool Linked = false;
+        bool Oversized = false;
+    };
+
+    static int CoordToCell( float value );
+
+    std::vector<int>& Cell( int x, int y ) { return m_Cells[y * GridDim + x]; }
+
+    static void RemoveFromList( std::vector<int>& list, int index );
+
+private:
+    std::vector<std::vector<int>> m_Cells;
+    std::vector<int> m_Oversized;
+    std::vector<Entry> m_Entries;
+};
+
+inline EntityPartition g_EntityPartition;
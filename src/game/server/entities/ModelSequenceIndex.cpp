@@ -0,0 +1,132 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <cctype>
+
+#include "cbase.h"
+#include "studio.h"
+#include "animation.h"
+#include "ModelSequenceIndex.h"
+
+/**
+ *    @brief Lowercases @p label into @p buffer.
+ *    @return Whether the label fits. Labels that don't fit can't match any sequence.
+ */
+template <std::size_t Size>
+static bool LowercaseLabel( std::string_view label, char ( &buffer )[Size], std::string_view& result )
+{
+    if( label.size() >= Size )
+    {
+        return false;
+    }
+
+    for( std::size_t i = 0; i < label.size(); ++i )
+    {
+        buffer[i] = static_cast<char>( std::tolower( static_cast<unsigned char>( label[i] ) ) );
+    }
+
+    result = {buffer, label.size()};
+    return true;
+}
+
+const ActivitySequences* ModelSequenceIndex::FindActivity( const studiohdr_t* header, int activity )
+{
+    const auto& model = GetModel( header );
+
+    if( auto it = model.Activities.find( activity ); it != model.Activities.end() )
+    {
+        return &it->second;
+    }
+
+    return nullptr;
+}
+
+int ModelSequenceIndex::FindSequence( const studiohdr_t* header, std::string_view label )
+{
+    const auto& model = GetModel( header );
+
+    char buffer[sizeof( mstudioseqdesc_t::label )];
+    std::string_view lowercase;
+
+    if( !LowercaseLabel( label, buffer, lowercase ) )
+    {
+        return -1;
+    }
+
+    if( auto it = model.Labels.find( lowercase ); it != model.Labels.end() )
+    {
+        return it->second;
+    }
+
+    return -1;
+}
+
+void ModelSequenceIndex::Clear()
+{
+    m_Models.clear();
+}
+
+const ModelSequenceIndex::ModelSequences& ModelSequenceIndex::GetModel( const studiohdr_t* header )
+{
+    auto& model = m_Models[header];
+
+    // A different model may have been loaded at the same address if the index wasn't cleared.
+    if( model.NumSequences != header->numseq || model.Length != header->length )
+    {
+        Build( model, header );
+    }
+
+    return model;
+}
+
+void ModelSequenceIndex::Build( ModelSequences& model, const studiohdr_t* header )
+{
+    model = {};
+    model.NumSequences = header->numseq;
+    model.Length = header->length;
+
+    const auto pseqdesc = reinterpret_cast<const mstudioseqdesc_t*>( reinterpret_cast<const byte*>( header ) + header->seqindex );
+
+    for( int i = 0; i < header->numseq; ++i )
+    {
+        const auto& seqdesc = pseqdesc[i];
+
+        auto& activity = model.Activities[seqdesc.activity];
+
+        const int previousWeight = activity.CumulativeWeights.empty() ? 0 : activity.CumulativeWeights.back();
+
+        activity.Sequences.push_back( i );
+        activity.CumulativeWeights.push_back( previousWeight + seqdesc.actweight );
+
+        if( seqdesc.actweight < 0 )
+        {
+            activity.HasNegativeWeights = true;
+        }
+
+        if( seqdesc.actweight > ( activity.Heaviest != ACTIVITY_NOT_AVAILABLE ? pseqdesc[activity.Heaviest].actweight : 0 ) )
+        {
+            activity.Heaviest = i;
+        }
+
+        char buffer[sizeof( seqdesc.label )];
+        std::string_view label;
+
+        if( LowercaseLabel( std::string_view{seqdesc.label, strnlen( seqdesc.label, sizeof( seqdesc.label ) )}, buffer, label ) )
+        {
+            // First sequence with a given name wins, like the linear search did.
+            model.Labels.try_emplace( std::string{label}, i );
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/heterogeneous_lookup.h"
+
+struct studiohdr_t;
+
+/**
+ *    @brief Sequences of a model that share an activity, in model order.
+ */
+struct ActivitySequences
+{
+    std::vector<int> Sequences;
+
+    // Running total of the weights of Sequences.
+    std::vector<int> CumulativeWeights;
+
+    // First sequence with the largest positive weight, or ACTIVITY_NOT_AVAILABLE.
+    int Heaviest = -1;
+
+    // Weighted selection falls back to the original algorithm for these.
+    bool HasNegativeWeights = false;
+};
+
+/**
+ *    @brief Index of each model's sequences by activity and by label.
+ *    @details Built the first time a model is looked up. Models are identified by their header address,
+ *    so the index must be cleared whenever models are unloaded.
+ */
+class ModelSequenceIndex final
+{
+public:
+    /**
+     *    @brief Gets the sequences for @p activity, or @c nullptr if the model has none.
+     */
+    const ActivitySequences* FindActivity( const studiohdr_t* header, int activity );
+
+    /**
+     *    @brief Finds the first sequence named @p label, ignoring case.
+     *    @return Sequence index, or -1 if there is none.
+     */
+    int FindSequence( const studiohdr_t* header, std::string_view label );
+
+    void Clear();
+
+private:
+    struct ModelSequences
+    {
+        int NumSequences = 0;
+        int Length = 0;
+
+        std::unordered_map<int, ActivitySequences> Activities;
+
+        // Labels are stored in lowercase.
+        std::unordered_map<std::string, int, TransparentStringHash, TransparentEqual> Labels;
+    };
+
+    const ModelSequences& GetModel( const studiohdr_t* header );
+
+    static void Build( ModelSequences& model, const studiohdr_t* header );
+
+    std::unordered_map<const studiohdr_t*, ModelSequences> m_Models;
+};
+
+inline ModelSequenceIndex g_ModelSequenceIndex;
@@ -0,0 +1,235 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include "cbase.h"
+#include "MonsterThinkLOD.h"
+
+/**
+ *    @brief Think interval used by monsters in the full tier.
+ */
+constexpr float FullThinkInterval = 0.1f;
+
+constexpr const char* AILODTierNames[] = {"full", "reduced", "dormant"};
+
+static_assert( std::size( AILODTierNames ) == static_cast<std::size_t>( AILODTier::Count ) );
+
+bool MonsterThinkLOD::Initialize()
+{
+    m_Logger = g_Logging.CreateLogger( "ent.ai.lod" );
+
+    m_Enabled = g_ConCommands.CreateCVar( "ai_lod", "1" );
+    m_NearDistance = g_ConCommands.CreateCVar( "ai_lod_near_distance", "1024" );
+    m_FarDistance = g_ConCommands.CreateCVar( "ai_lod_far_distance", "3072" );
+    m_ReducedInterval = g_ConCommands.CreateCVar( "ai_lod_reduced_interval", "0.3" );
+    m_DormantInterval = g_ConCommands.CreateCVar( "ai_lod_dormant_interval", "1" );
+    m_PromoteTime = g_ConCommands.CreateCVar( "ai_lod_promote_time", "5" );
+    m_Stats = g_ConCommands.CreateCVar( "ai_lod_stats", "0" );
+
+    g_ConCommands.CreateCommand( "ai_lod_report", [this]( const auto& )
+        { PrintReport(); } );
+
+    return true;
+}
+
+void MonsterThinkLOD::Shutdown()
+{
+    Clear();
+    g_Logging.RemoveLogger( m_Logger );
+    m_Logger.reset();
+}
+
+void MonsterThinkLOD::RunFrame()
+{
+    if( m_Stats->value != 0 )
+    {
+        if( std::any_of( m_FrameThinks.begin(), m_FrameThinks.end(), []( int count )
+                { return count > 0; } ) )
+        {
+            m_Logger->info( "thinks: {} full, {} reduced, {} dormant, {} promotions",
+                m_FrameThinks[0], m_FrameThinks[1], m_FrameThinks[2], m_FramePromotions );
+        }
+    }
+
+    m_FrameThinks = {};
+    m_FramePromotions = 0;
+}
+
+void MonsterThinkLOD::Clear()
+{
+    m_LowerTierMonsters.clear();
+    m_FrameThinks = {};
+    m_FramePromotions = 0;
+}
+
+float MonsterThinkLOD::UpdateTier( CBaseMonster* monster )
+{
+    const AILODTier tier = SelectTier( monster );
+
+    monster->m_AILODTier = tier;
+
+    ++m_FrameThinks[static_cast<std::size_t>( tier )];
+    ++m_TotalThinks[static_cast<std::size_t>( tier )];
+
+    switch ( tier )
+    {
+    case AILODTier::Reduced:
+    case AILODTier::Dormant:
+    {
+        if( !monster->m_InAILODList )
+        {
+            monster->m_InAILODList = true;
+            m_LowerTierMonsters.emplace_back() = monster;
+        }
+
+        const float interval = tier == AILODTier::Reduced ? m_ReducedInterval->value : m_DormantInterval->value;
+        return std::max( FullThinkInterval, interval );
+    }
+
+    default: return FullThinkInterval;
+    }
+}
+
+void MonsterThinkLOD::Promote( CBaseMonster* monster )
+{
+    monster->m_flAILODPromoteTime = gpGlobals->time + m_PromoteTime->value;
+
+    if( monster->m_AILODTier == AILODTier::Full )
+    {
+        return;
+    }
+
+    monster->m_AILODTier = AILODTier::Full;
+
+    ++m_FramePromotions;
+    ++m_TotalPromotions;
+
+    // Only living monsters in a lower tier are waiting on MonsterThink.
+    if( monster->IsAlive() && monster->pev->nextthink > gpGlobals->time )
+    {
+        monster->pev->nextthink = gpGlobals->time;
+    }
+}
+
+void MonsterThinkLOD::OnSoundInserted( int type, const Vector& origin, int volume )
+{
+    for( std::size_t i = 0; i < m_LowerTierMonsters.size(); )
+    {
+        CBaseMonster* monster = m_LowerTierMonsters[i];
+
+        // Remove monsters that were deleted or are back in the full tier.
+        if( !monster || monster->m_AILODTier == AILODTier::Full )
+        {
+            if( monster )
+            {
+                monster->m_InAILODList = false;
+            }
+
+            m_LowerTierMonsters[i] = m_LowerTierMonsters.back();
+            m_LowerTierMonsters.pop_back();
+            continue;
+        }
+
+        ++i;
+
+        if( ( type & monster->ISoundMask() ) == 0 )
+        {
+            continue;
+        }
+
+        const float hearingDistance = volume * monster->HearingSensitivity();
+
+        if( hearingDistance >= 0 && ( origin - monster->EarPosition() ).LengthSquared() <= hearingDistance * hearingDistance )
+        {
+            Promote( monster );
+        }
+    }
+}
+
+AILODTier MonsterThinkLOD::SelectTier( CBaseMonster* monster ) const
+{
+    if( m_Enabled->value == 0 )
+    {
+        return AILODTier::Full;
+    }
+
+    // Anything that isn't standing around idle runs at the full rate.
+    if( monster->m_MonsterState != MONSTERSTATE_IDLE || monster->m_IdealMonsterState != MONSTERSTATE_IDLE ||
+        monster->pev->deadflag != DEAD_NO || monster->m_hEnemy || monster->m_pCine || !monster->MovementIsComplete() )
+    {
+        return AILODTier::Full;
+    }
+
+    if( monster->m_flAILODPromoteTime > gpGlobals->time )
+    {
+        return AILODTier::Full;
+    }
+
+    if( UTIL_FindClientInPVS( monster ) )
+    {
+        return AILODTier::Full;
+    }
+
+    float nearestDistanceSquared = -1;
+
+    for( auto player : UTIL_FindPlayers() )
+    {
+        const float distanceSquared = ( player->pev->origin - monster->pev->origin ).LengthSquared();
+
+        if( nearestDistanceSquared < 0 || distanceSquared < nearestDistanceSquared )
+        {
+            nearestDistanceSquared = distanceSquared;
+        }
+    }
+
+    // No players to perceive anything yet.
+    if( nearestDistanceSquared < 0 )
+    {
+        return AILODTier::Full;
+    }
+
+    if( nearestDistanceSquared <= m_NearDistance->value * m_NearDistance->value )
+    {
+        return AILODTier::Full;
+    }
+
+    if( nearestDistanceSquared <= m_FarDistance->value * m_FarDistance->value )
+    {
+        return AILODTier::Reduced;
+    }
+
+    return AILODTier::Dormant;
+}
+
+void MonsterThinkLOD::PrintReport()
+{
+    std::array<int, static_cast<std::size_t>( AILODTier::Count )> monsters{};
+
+    for( auto entity : UTIL_FindEntities() )
+    {
+        if( auto monster = entity->MyMonsterPointer(); monster && !entity->IsPlayer() && monster->IsAlive() )
+        {
+            ++monsters[static_cast<std::size_t>( monster->m_AILODTier )];
+        }
+    }
+
+    m_Logger->info( "AI LOD is {}", m_Enabled->value != 0 ? "enabled" : "disabled" );
+
+    for( std::size_t i = 0; i < monsters.size(); ++i )
+    {
+        m_Logger->info( "{:>8}: {} monsters, {} thinks total", AILODTierNames[i], monsters[i], m_TotalThinks[i] );
+    }
+
+    m_Logger->info( "{} promotions total", m_TotalPromotions );
+}
@@ -0,0 +1,106 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <spdlog/logger.h>
+
+#include "ehandle.h"
+#include "utils/GameSystem.h"
+
+class CBaseEntity;
+class CBaseMonster;
+
+/**
+ *    @brief How often a monster runs its AI.
+ */
+enum class AILODTier
+{
+    Full = 0, //!< Thinks every 0.1 seconds.
+    Reduced,  //!< Idle and out of sight of all players.
+    Dormant,  //!< Idle, out of sight and far away from all players.
+    Count
+};
+
+/**
+ *    @brief Lowers the think rate of idle monsters that no player can perceive.
+ *    @details Monsters outside of every player's PVS already skip Look and Listen, so lowering the think rate
+ *    doesn't change what they sense. Monsters are promoted to the full rate right away when they are damaged,
+ *    used, possessed by a scripted sequence or hear a sound, and stay there for a while afterwards.
+ */
+class MonsterThinkLOD final : public IGameSystem
+{
+public:
+    const char* GetName() const override { return "MonsterThinkLOD"; }
+
+    bool Initialize() override;
+
+    void PostInitialize() override {}
+
+    void Shutdown() override;
+
+    void RunFrame();
+
+    /**
+     *    @brief Must be called on map change.
+     */
+    void Clear();
+
+    /**
+     *    @brief Picks the tier for @p monster and returns the time until it should think again.
+     */
+    float UpdateTier( CBaseMonster* monster );
+
+    /**
+     *    @brief Makes @p monster think at the full rate starting next frame.
+     */
+    void Promote( CBaseMonster* monster );
+
+    /**
+     *    @brief Promotes monsters in a lower tier that can hear a sound.
+     */
+    void OnSoundInserted( int type, const Vector& origin, int volume );
+
+private:
+    AILODTier SelectTier( CBaseMonster* monster ) const;
+
+    void PrintReport();
+
+private:
+    std::shared_ptr<spdlog::logger> m_Logger;
+
+    cvar_t* m_Enabled{};
+    cvar_t* m_NearDistance{};
+    cvar_t* m_FarDistance{};
+    cvar_t* m_ReducedInterval{};
+    cvar_t* m_DormantInterval{};
+    cvar_t* m_PromoteTime{};
+    cvar_t* m_Stats{};
+
+    // Monsters that were in a lower tier when they last thought. May contain stale entries.
+    std::vector<EntityHandle<CBaseMonster>> m_LowerTierMonsters;
+
+    std::array<int, static_cast<std::size_t>( AILODTier::Count )> m_FrameThinks{};
+    std::array<std::uint64_t, static_cast<std::size_t>( AILODTier::Count )> m_TotalThinks{};
+    int m_FramePromotions = 0;
+    std::uint64_t m_TotalPromotions = 0;
+};
+
+inline MonsterThinkLOD g_MonsterThinkLOD;
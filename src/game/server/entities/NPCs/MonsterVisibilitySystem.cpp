@@ -0,0 +1,184 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <cmath>
+
+#include "cbase.h"
+#include "MonsterVisibilitySystem.h"
+
+/**
+ *    @brief Size of the grid that eye positions are rounded to.
+ */
+constexpr float EyePositionGridSize = 2.f;
+
+bool MonsterVisibilitySystem::Initialize()
+{
+    m_Logger = g_Logging.CreateLogger( "ent.ai.visibility" );
+
+    m_CacheEnabled = g_ConCommands.CreateCVar( "ai_visibility_cache", "1" );
+    m_LookBudget = g_ConCommands.CreateCVar( "ai_look_budget", "8" );
+    m_LookMaxDelay = g_ConCommands.CreateCVar( "ai_look_max_delay", "0.5" );
+    m_LookNearDistance = g_ConCommands.CreateCVar( "ai_look_near_distance", "1024" );
+    m_Stats = g_ConCommands.CreateCVar( "ai_visibility_stats", "0" );
+
+    return true;
+}
+
+void MonsterVisibilitySystem::Shutdown()
+{
+    Clear();
+    g_Logging.RemoveLogger( m_Logger );
+    m_Logger.reset();
+}
+
+void MonsterVisibilitySystem::RunFrame()
+{
+    if( m_Stats->value != 0 && ( m_FrameStats.Traces > 0 || m_FrameStats.TracesSaved > 0 || m_FrameStats.Looks > 0 ) )
+    {
+        m_Logger->info( "{} traces, {} saved ({} total, {} saved), {} looks, {} deferred",
+            m_FrameStats.Traces, m_FrameStats.TracesSaved, m_TotalTraces, m_TotalTracesSaved,
+            m_FrameStats.Looks, m_FrameStats.LooksDeferred );
+    }
+
+    m_Results.clear();
+    m_BudgetedLooks = 0;
+    m_FrameStats = {};
+}
+
+void MonsterVisibilitySystem::Clear()
+{
+    m_Results.clear();
+    m_BudgetedLooks = 0;
+    m_FrameStats = {};
+}
+
+bool MonsterVisibilitySystem::IsVisible( CBaseEntity* looker, const Vector& start, CBaseEntity* target, const Vector& end )
+{
+    // Brush entities can block the trace in one direction but not the other.
+    if( m_CacheEnabled->value == 0 || looker->pev->solid == SOLID_BSP || target->pev->solid == SOLID_BSP )
+    {
+        ++m_FrameStats.Traces;
+        ++m_TotalTraces;
+        return TraceLineOfSight( looker, start, end );
+    }
+
+    Key key{MakeEndpoint( looker, start ), MakeEndpoint( target, end )};
+
+    if( key.Second < key.First )
+    {
+        std::swap( key.First, key.Second );
+    }
+
+    if( auto it = m_Results.find( key ); it != m_Results.end() )
+    {
+        ++m_FrameStats.TracesSaved;
+        ++m_TotalTracesSaved;
+        return it->second;
+    }
+
+    ++m_FrameStats.Traces;
+    ++m_TotalTraces;
+
+    const bool visible = TraceLineOfSight( looker, start, end );
+
+    m_Results.emplace( key, visible );
+
+    return visible;
+}
+
+bool MonsterVisibilitySystem::ShouldLook( CBaseMonster* monster )
+{
+    const auto look = [&]()
+    {
+        ++m_FrameStats.Looks;
+        monster->m_flLastLookTime = gpGlobals->time;
+        return true;
+    };
+
+    if( m_LookBudget->value <= 0 || monster->m_hEnemy || monster->m_MonsterState == MONSTERSTATE_COMBAT )
+    {
+        return look();
+    }
+
+    if( monster->m_MonsterState != MONSTERSTATE_IDLE && IsNearPlayer( monster ) )
+    {
+        return look();
+    }
+
+    const float timeSinceLook = gpGlobals->time - monster->m_flLastLookTime;
+
+    // Time goes backwards on map change.
+    if( timeSinceLook < 0 || timeSinceLook >= m_LookMaxDelay->value )
+    {
+        return look();
+    }
+
+    if( m_BudgetedLooks < static_cast<int>( m_LookBudget->value ) )
+    {
+        ++m_BudgetedLooks;
+        return look();
+    }
+
+    ++m_FrameStats.LooksDeferred;
+    return false;
+}
+
+std::size_t MonsterVisibilitySystem::KeyHash::operator()( const Key& key ) const
+{
+    std::size_t hash = 0;
+
+    for( const auto& endpoint : {key.First, key.Second} )
+    {
+        for( int value : {endpoint.Entity, endpoint.X, endpoint.Y, endpoint.Z} )
+        {
+            hash = hash * 31 + std::hash<int>{}( value );
+        }
+    }
+
+    return hash;
+}
+
+MonsterVisibilitySystem::Endpoint MonsterVisibilitySystem::MakeEndpoint( CBaseEntity* entity, const Vector& position )
+{
+    return {
+        entity->entindex(),
+        static_cast<int>( std::floor( position.x / EyePositionGridSize ) ),
+        static_cast<int>( std::floor( position.y / EyePositionGridSize ) ),
+        static_cast<int>( std::floor( position.z / EyePositionGridSize ) )};
+}
+
+bool MonsterVisibilitySystem::TraceLineOfSight( CBaseEntity* looker, const Vector& start, const Vector& end )
+{
+    TraceResult tr;
+
+    UTIL_TraceLine( start, end, ignore_monsters, ignore_glass, looker->edict() /*pentIgnore*/, &tr );
+
+    return tr.flFraction == 1.0;
+}
+
+bool MonsterVisibilitySystem::IsNearPlayer( CBaseMonster* monster ) const
+{
+    const float nearDistanceSquared = m_LookNearDistance->value * m_LookNearDistance->value;
+
+    for( auto player : UTIL_FindPlayers() )
+    {
+        if( ( player->pev->origin - monster->pev->origin ).LengthSquared() <= nearDistanceSquared )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,128 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include <spdlog/logger.h>
+
+#include "utils/GameSystem.h"
+
+class CBaseEntity;
+class CBaseMonster;
+
+/**
+ *    @brief Shares line of sight traces between entities for the duration of a frame
+ *    and limits how many idle or distant monsters update their sight each frame.
+ *    @details A trace from A to B has the same result as a trace from B to A as long as neither entity
+ *    is a brush entity, since monsters are ignored by sight traces. Results are keyed by both entities
+ *    and their eye positions rounded to a grid, so monsters that moved slightly since the trace was made
+ *    still share it.
+ */
+class MonsterVisibilitySystem final : public IGameSystem
+{
+public:
+    const char* GetName() const override { return "MonsterVisibility"; }
+
+    bool Initialize() override;
+
+    void PostInitialize() override {}
+
+    void Shutdown() override;
+
+    /**
+     *    @brief Discards results from the previous frame.
+     */
+    void RunFrame();
+
+    /**
+     *    @brief Must be called on map change.
+     */
+    void Clear();
+
+    /**
+     *    @brief Checks whether there is a line of sight from @p start to @p end, reusing results from this frame if possible.
+     *    @param looker Entity looking from @p start. Ignored by the trace.
+     *    @param target Entity at @p end.
+     */
+    bool IsVisible( CBaseEntity* looker, const Vector& start, CBaseEntity* target, const Vector& end );
+
+    /**
+     *    @brief Whether @p monster should update its sight this think.
+     *    @details Monsters without an enemy that are idle or far from all players share a per-frame budget.
+     *    They always look if they haven't done so for a while.
+     */
+    bool ShouldLook( CBaseMonster* monster );
+
+private:
+    struct Endpoint
+    {
+        int Entity;
+        int X, Y, Z;
+
+        constexpr auto operator<=>( const Endpoint& ) const = default;
+    };
+
+    // Endpoints are sorted so both directions map to the same key.
+    struct Key
+    {
+        Endpoint First;
+        Endpoint Second;
+
+        constexpr bool operator==( const Key& ) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()( const Key& key ) const;
+    };
+
+    struct FrameStats
+    {
+        int Traces = 0;
+        int TracesSaved = 0;
+        int Looks = 0;
+        int LooksDeferred = 0;
+    };
+
+    static Endpoint MakeEndpoint( CBaseEntity* entity, const Vector& position );
+
+    static bool TraceLineOfSight( CBaseEntity* looker, const Vector& start, const Vector& end );
+
+    bool IsNearPlayer( CBaseMonster* monster ) const;
+
+private:
+    std::shared_ptr<spdlog::logger> m_Logger;
+
+    cvar_t* m_CacheEnabled{};
+    cvar_t* m_LookBudget{};
+    cvar_t* m_LookMaxDelay{};
+    cvar_t* m_LookNearDistance{};
+    cvar_t* m_Stats{};
+
+    std::unordered_map<Key, bool, KeyHash> m_Results;
+
+    int m_BudgetedLooks = 0;
+
+    FrameStats m_FrameStats;
+    std::uint64_t m_TotalTraces = 0;
+    std::uint64_t m_TotalTracesSaved = 0;
+};
+
+inline MonsterVisibilitySystem g_MonsterVisibility;
@@ -19,6 +19,7 @@
 
 #include "CBaseToggle.h"
 #include "monsters.h"
+#include "MonsterThinkLOD.h"
 
 /**
  *    @brief Enum namespace
@@ -222,6 +223,13 @@ public:
 
     float m_flLastYawTime;
 
+    float m_flLastLookTime = 0; //!< last time Look was run. Not saved, monsters look right away after restoring.
+
+    // AI level of detail. Not saved, monsters start out thinking at the full rate after restoring.
+    AILODTier m_AILODTier = AILODTier::Full;
+    float m_flAILODPromoteTime = 0; //!< keep thinking at the full rate until this time.
+    bool m_InAILODList = false;
+
     int ObjectCaps() override
     {
         int caps = BaseClass::ObjectCaps();
@@ -246,6 +254,11 @@ public:
      */
     void MonsterUse( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_TYPE useType, UseValue value );
 
+    /**
+     *    @brief Makes the monster think at the full rate before running its use function.
+     */
+    void Use( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_TYPE useType, UseValue value = {} ) override;
+
     // overrideable Monster member functions
 
     int BloodColor() override { return m_bloodColor; }
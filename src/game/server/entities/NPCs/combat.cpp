@@ -22,6 +22,7 @@
 
 #include "cbase.h"
 #include "func_break.h"
+#include "MonsterVisibilitySystem.h"
 #include "UserMessages.h"
 
 BEGIN_DATAMAP( CGib )
@@ -846,6 +847,8 @@ bool CBaseMonster::TakeDamage( CBaseEntity* inflictor, CBaseEntity* attacker, fl
     if( 0 == pev->takedamage || flDamage < 1 )
         return false;
 
+    g_MonsterThinkLOD.Promote( this );
+
     if( int cap = g_cfg.GetValue<int>( "frame_dmg_cap"sv, 0, this ); cap > 0 )
     {
         if( gpGlobals->time == m_capdmg_time )
@@ -1206,7 +1209,6 @@ bool CBaseMonster::FInViewCone( Vector* pOrigin )
 
 bool CBaseEntity::FVisible( CBaseEntity* pEntity )
 {
-    TraceResult tr;
     Vector vecLookerOrigin;
     Vector vecTargetOrigin;
 
@@ -1220,16 +1222,8 @@ bool CBaseEntity::FVisible( CBaseEntity* pEntity )
     vecLookerOrigin = pev->origin + pev->view_ofs; // look through the caller's 'eyes'
     vecTargetOrigin = pEntity->EyePosition();
 
-    UTIL_TraceLine(vecLookerOrigin, vecTargetOrigin, ignore_monsters, ignore_glass, edict() /*pentIgnore*/, &tr);
-
-    if( tr.flFraction != 1.0 )
-    {
-        return false; // Line of sight is not established
-    }
-    else
-    {
-        return true; // line of sight is valid.
-    }
+    // Shares the trace with pEntity looking at us this frame.
+    return g_MonsterVisibility.IsVisible( this, vecLookerOrigin, pEntity, vecTargetOrigin );
 }
 
 bool CBaseEntity::FVisible( const Vector& vecOrigin )
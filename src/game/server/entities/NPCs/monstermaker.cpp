@@ -249,7 +249,7 @@ void CMonsterMaker::MakeMonster()
     if( !FStringNull( pev->netname ) )
     {
         // if I have a netname (overloaded), give the child monster that name as a targetname
-        entity->pev->targetname = pev->netname;
+        entity->SetTargetname( pev->netname );
     }
 
     ++m_cLiveChildren; // count this monster
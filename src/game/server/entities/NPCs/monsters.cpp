@@ -151,10 +151,8 @@ void CBaseMonster::BarnacleVictimReleased()
 
 void CBaseMonster::Listen()
 {
-    int iSound;
     int iMySounds;
     float hearingSensitivity;
-    CSound* pCurrentSound;
 
     m_iAudibleList = SOUNDLIST_EMPTY;
     ClearConditions( bits_COND_HEAR_SOUND | bits_COND_SMELL | bits_COND_SMELL_FOOD );
@@ -169,24 +167,27 @@ void CBaseMonster::Listen()
         iMySounds &= m_pSchedule->iSoundMask;
     }
 
-    iSound = CSoundEnt::ActiveList();
-
     // UNDONE: Clear these here?
     ClearConditions( bits_COND_HEAR_SOUND | bits_COND_SMELL_FOOD | bits_COND_SMELL );
     hearingSensitivity = HearingSensitivity();
 
-    while( iSound != SOUNDLIST_EMPTY )
-    {
-        pCurrentSound = CSoundEnt::SoundPointerForIndex( iSound );
-
-        if( nullptr != pCurrentSound &&
-            ( pCurrentSound->m_iType & iMySounds ) != 0 &&
-            ( pCurrentSound->m_vecOrigin - EarPosition() ).Length() <= pCurrentSound->m_iVolume * hearingSensitivity )
+    const Vector earPosition = EarPosition();
 
-        // if ( ( g_pSoundEnt->m_SoundPool[ iSound ].m_iType & iMySounds ) && ( g_pSoundEnt->m_SoundPool[ iSound ].m_vecOrigin - EarPosition()).Length () <= g_pSoundEnt->m_SoundPool[ iSound ].m_iVolume * hearingSensitivity )
+    CSoundEnt::ForEachSoundNear( earPosition, hearingSensitivity, [&]( int iSound, CSound* pCurrentSound )
         {
+            if( ( pCurrentSound->m_iType & iMySounds ) == 0 )
+            {
+                return;
+            }
+
+            const float hearingDistance = pCurrentSound->m_iVolume * hearingSensitivity;
+
+            if( hearingDistance < 0 || ( pCurrentSound->m_vecOrigin - earPosition ).LengthSquared() > hearingDistance * hearingDistance )
+            {
+                return;
+            }
+
             // the monster cares about this sound, and it's close enough to hear.
-            // g_pSoundEnt->m_SoundPool[ iSound ].m_iNextAudible = m_iAudibleList;
             pCurrentSound->m_iNextAudible = m_iAudibleList;
 
             if( pCurrentSound->FIsSound() )
@@ -197,7 +198,6 @@ void CBaseMonster::Listen()
             else
             {
                 // if not a sound, must be a smell - determine if it's just a scent, or if it's a food scent
-                //                if ( g_pSoundEnt->m_SoundPool[ iSound ].m_iType & ( bits_SOUND_MEAT | bits_SOUND_CARCASS ) )
                 if( ( pCurrentSound->m_iType & ( bits_SOUND_MEAT | bits_SOUND_CARCASS ) ) != 0 )
                 {
                     // the detected scent is a food item, so set both conditions.
@@ -212,15 +212,10 @@ void CBaseMonster::Listen()
                 }
             }
 
-            //            m_afSoundTypes |= g_pSoundEnt->m_SoundPool[ iSound ].m_iType;
             m_afSoundTypes |= pCurrentSound->m_iType;
 
             m_iAudibleList = iSound;
-        }
-
-        //        iSound = g_pSoundEnt->m_SoundPool[ iSound ].m_iNext;
-        iSound = pCurrentSound->m_iNext;
-    }
+        } );
 }
 
 float CBaseMonster::FLSoundVolume( CSound* pSound )
@@ -435,7 +430,7 @@ CSound* CBaseMonster::PBestScent()
 
 void CBaseMonster::MonsterThink()
 {
-    pev->nextthink = gpGlobals->time + 0.1; // keep monster thinking.
+    pev->nextthink = gpGlobals->time + g_MonsterThinkLOD.UpdateTier( this ); // keep monster thinking.
 
 
     RunAI();
@@ -490,6 +485,12 @@ void CBaseMonster::MonsterUse( CBaseEntity* pActivator, CBaseEntity* pCaller, US
     // m_IdealMonsterState = MONSTERSTATE_ALERT;
 }
 
+void CBaseMonster::Use( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_TYPE useType, UseValue value )
+{
+    g_MonsterThinkLOD.Promote( this );
+    BaseClass::Use( pActivator, pCaller, useType, value );
+}
+
 int CBaseMonster::IgnoreConditions()
 {
     int iIgnoreConditions = 0;
@@ -19,6 +19,7 @@
  */
 
 #include "cbase.h"
+#include "MonsterVisibilitySystem.h"
 
 void CBaseMonster::SetState( MONSTERSTATE State )
 {
@@ -70,7 +71,16 @@ void CBaseMonster::RunAI()
         // an area where monsters are fighting, and the fight will continue.
         if( UTIL_FindClientInPVS( this ) || ( m_MonsterState == MONSTERSTATE_COMBAT ) )
         {
-            Look( m_flDistLook );
+            if( g_MonsterVisibility.ShouldLook( this ) )
+            {
+                Look( m_flDistLook );
+            }
+            else
+            {
+                // Keep what was seen last time, but the list of sighted entities is only valid right after Look.
+                m_pLink = nullptr;
+            }
+
             Listen(); // check for audible sounds.
 
             // now filter conditions.
@@ -276,6 +276,7 @@ void CCineMonster::PossessEntity()
         // AIScriptLogger->debug("\"{}\" found and used (INT: {})", STRING(pTarget->pev->targetname), FBitSet(pev->spawnflags, SF_SCRIPT_NOINTERRUPT)?"No":"Yes");
 
         pTarget->m_IdealMonsterState = MONSTERSTATE_SCRIPT;
+        g_MonsterThinkLOD.Promote( pTarget );
         if( !FStringNull( m_iszIdle ) )
         {
             StartSequence( pTarget, m_iszIdle, false );
@@ -347,6 +348,7 @@ void CCineAI::PossessEntity()
         AIScriptLogger->debug( "\"{}\" found and used", STRING( pTarget->pev->targetname ) );
 
         pTarget->m_IdealMonsterState = MONSTERSTATE_SCRIPT;
+        g_MonsterThinkLOD.Promote( pTarget );
 
         /*
                 if (m_iszIdle)
@@ -13,12 +13,15 @@
  *
  ****/
 
+#include <algorithm>
+
 #include "cbase.h"
 
 #include "studio.h"
 #include "activity.h"
 #include "activitymap.h"
 #include "animation.h"
+#include "ModelSequenceIndex.h"
 #include "scriptevent.h"
 
 bool ExtractBbox( void* pmodel, int sequence, Vector& mins, Vector& maxs )
@@ -52,23 +55,40 @@ int LookupActivity( void* pmodel, entvars_t* pev, int activity )
     if( !pstudiohdr )
         return 0;
 
-    mstudioseqdesc_t* pseqdesc;
+    const auto sequences = g_ModelSequenceIndex.FindActivity( pstudiohdr, activity );
 
-    pseqdesc = ( mstudioseqdesc_t* )( ( byte* )pstudiohdr + pstudiohdr->seqindex );
+    if( !sequences )
+        return ACTIVITY_NOT_AVAILABLE;
 
-    int weighttotal = 0;
-    int seq = ACTIVITY_NOT_AVAILABLE;
-    for( int i = 0; i < pstudiohdr->numseq; i++ )
+    if( sequences->HasNegativeWeights )
     {
-        if( pseqdesc[i].activity == activity )
+        mstudioseqdesc_t* pseqdesc;
+
+        pseqdesc = ( mstudioseqdesc_t* )( ( byte* )pstudiohdr + pstudiohdr->seqindex );
+
+        int weighttotal = 0;
+        int seq = ACTIVITY_NOT_AVAILABLE;
+        for( int i : sequences->Sequences )
         {
             weighttotal += pseqdesc[i].actweight;
             if( 0 == weighttotal || RANDOM_LONG( 0, weighttotal - 1 ) < pseqdesc[i].actweight )
                 seq = i;
         }
+
+        return seq;
     }
 
-    return seq;
+    const int weighttotal = sequences->CumulativeWeights.back();
+
+    // Without any weights the last sequence is picked.
+    if( 0 == weighttotal )
+        return sequences->Sequences.back();
+
+    // Each sequence is picked with a chance of its weight / total weight, same as the original incremental selection.
+    const int pick = RANDOM_LONG( 0, weighttotal - 1 );
+    const auto it = std::upper_bound( sequences->CumulativeWeights.begin(), sequences->CumulativeWeights.end(), pick );
+
+    return sequences->Sequences[it - sequences->CumulativeWeights.begin()];
 }
 
 int LookupActivityHeaviest( void* pmodel, entvars_t* pev, int activity )
@@ -79,25 +99,12 @@ int LookupActivityHeaviest( void* pmodel, entvars_t* pev, int activity )
     if( !pstudiohdr )
         return 0;
 
-    mstudioseqdesc_t* pseqdesc;
+    const auto sequences = g_ModelSequenceIndex.FindActivity( pstudiohdr, activity );
 
-    pseqdesc = ( mstudioseqdesc_t* )( ( byte* )pstudiohdr + pstudiohdr->seqindex );
-
-    int weight = 0;
-    int seq = ACTIVITY_NOT_AVAILABLE;
-    for( int i = 0; i < pstudiohdr->numseq; i++ )
-    {
-        if( pseqdesc[i].activity == activity )
-        {
-            if( pseqdesc[i].actweight > weight )
-            {
-                weight = pseqdesc[i].actweight;
-                seq = i;
-            }
-        }
-    }
+    if( !sequences )
+        return ACTIVITY_NOT_AVAILABLE;
 
-    return seq;
+    return sequences->Heaviest;
 }
 
 void GetEyePosition( void* pmodel, Vector& vecEyePosition )
@@ -123,17 +130,7 @@ int LookupSequence( void* pmodel, const char* label )
     if( !pstudiohdr )
         return 0;
 
-    mstudioseqdesc_t* pseqdesc;
-
-    pseqdesc = ( mstudioseqdesc_t* )( ( byte* )pstudiohdr + pstudiohdr->seqindex );
-
-    for( int i = 0; i < pstudiohdr->numseq; i++ )
-    {
-        if( stricmp( pseqdesc[i].label, label ) == 0 )
-            return i;
-    }
-
-    return -1;
+    return g_ModelSequenceIndex.FindSequence( pstudiohdr, label );
 }
 
 bool IsSoundEvent( int eventNumber )
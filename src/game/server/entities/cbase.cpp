@@ -20,6 +20,8 @@
 #include "MapState.h"
 #include "pm_shared.h"
 #include "world.h"
+#include "EntityNameIndex.h"
+#include "EntityPartition.h"
 #include "sound/ServerSoundSystem.h"
 #include "utils/ReplacementMaps.h"
 
@@ -27,6 +29,8 @@ static void SetObjectCollisionBox( entvars_t* pev );
 
 int DispatchSpawn( edict_t* pent )
 {
+    EntityNameIndexUpdater nameIndexUpdater{pent};
+
     // Initialize these or entities who don't link to the world won't have anything in here
     pent->v.absmin = pent->v.origin - Vector( 1, 1, 1 );
     pent->v.absmax = pent->v.origin + Vector( 1, 1, 1 );
@@ -45,9 +49,6 @@ int DispatchSpawn( edict_t* pent )
         return 0;
     }
 
-    // We map these keyvalues regardless of the map config
-    entity->m_CustomKeyValues.custom = true;
-
     auto EntityHasSpawned = [&]( SpawnAction code ) -> int
     {
         entity = (CBaseEntity*)GET_PRIVATE( pent );
@@ -65,7 +66,7 @@ int DispatchSpawn( edict_t* pent )
             {
                 entity->UpdateOnRemove();
                 entity->pev->flags |= FL_KILLME;
-                entity->pev->targetname = string_t::Null;
+                entity->SetTargetname( string_t::Null );
                 return -1;
             }
             case SpawnAction::RemoveNow:
@@ -151,6 +152,8 @@ void DispatchKeyValue( edict_t* pentKeyvalue, KeyValueData* pkvd )
     if( !pkvd || !pentKeyvalue )
         return;
 
+    EntityNameIndexUpdater nameIndexUpdater{pentKeyvalue};
+
     if( g_Server.CheckForNewMapStart( false ) )
     {
         // HACK: If we get here that means we're loading a new map and we're setting worldspawn's classname.
@@ -260,10 +263,6 @@ void DispatchSave( edict_t* pent, SAVERESTOREDATA* pSaveData )
             pEntity->pev->nextthink = pEntity->pev->ltime + delta;
         }
 
-        // Move the map into arrays of string_t
-        pEntity->m_KeyValues.Save();
-        pEntity->m_CustomKeyValues.Save();
-
         pTable->location = pSaveData->size;             // Remember entity position for file I/O
         pTable->classname = pEntity->pev->classname; // Remember entity class for respawn
 
@@ -271,6 +270,12 @@ void DispatchSave( edict_t* pent, SAVERESTOREDATA* pSaveData )
         pEntity->Save( saveHelper );
 
         pTable->size = pSaveData->size - pTable->location; // Size of entity block is data size written to block
+
+        if( saveHelper.IsTokenTableFull() )
+        {
+            CSaveRestoreBuffer::Logger->error( "Could not save {} ({}): the save game token table is full, the save is incomplete",
+                STRING( pEntity->pev->classname ), STRING( pEntity->pev->targetname ) );
+        }
     }
 }
 
@@ -282,6 +287,9 @@ void OnFreeEntPrivateData( edict_t* pEdict )
 
         g_EntityDictionary->Destroy( entity );
 
+        g_EntityPartition.Unlink( pEdict );
+        g_EntityNameIndex.Remove( pEdict );
+
         // Zero this out so the engine doesn't try to free it again.
         pEdict->pvPrivateData = nullptr;
     }
@@ -311,6 +319,9 @@ int DispatchRestore( edict_t* pent, SAVERESTOREDATA* pSaveData, int globalEntity
 {
     gpGlobals->time = pSaveData->time;
 
+    // Tracks pent so entities restored over a global entity are updated too.
+    EntityNameIndexUpdater nameIndexUpdater{pent};
+
     CBaseEntity* pEntity = (CBaseEntity*)GET_PRIVATE( pent );
 
     if( pEntity && CSaveRestoreBuffer::IsValidSaveRestoreData( pSaveData ) )
@@ -365,10 +376,6 @@ int DispatchRestore( edict_t* pent, SAVERESTOREDATA* pSaveData, int globalEntity
         pEntity->Restore( restoreHelper );
         pEntity->PostRestore();
 
-        // Move arrays of string_t into the map
-        pEntity->m_KeyValues.Restore();
-        pEntity->m_CustomKeyValues.Restore();
-
         if( ( pEntity->ObjectCaps() & FCAP_MUST_SPAWN ) != 0 )
         {
             if( !pEntity->Spawn() )
@@ -433,6 +440,9 @@ void DispatchObjectCollsionBox( edict_t* pent )
     }
     else
         SetObjectCollisionBox( &pent->v );
+
+    // The engine calls this every time it links an entity, so this keeps the partition in sync with origin and size changes.
+    g_EntityPartition.Link( pent );
 }
 
 // The engine uses the old type description data, so we need to translate it to the game's version.
@@ -507,6 +517,7 @@ static const DataMap* GetOrCreateDataMap( const char* className, const TYPEDESCR
 
         engineDataMap->Map.ClassName = className;
         engineDataMap->Map.Members = {typeDescriptions.get(), static_cast<std::size_t>( fieldCount )};
+        engineDataMap->Map.FieldLookup = DataFieldLookup{engineDataMap->Map.Members};
         engineDataMap->TypeDescriptions = std::move( typeDescriptions );
 
         it = g_EngineTypeDescriptionsToGame.emplace( fields, std::move( engineDataMap ) ).first;
@@ -650,15 +661,18 @@ bool CBaseEntity::RequiredKeyValue( KeyValueData* pkvd )
     {
         std::string name = std::string( pkvd->szKeyName ).substr(4);
 
+        const int id = g_cfg.GetVariableId( name );
+
         auto it = std::find_if( m_ConfigVariables.begin(), m_ConfigVariables.end(), [&]( const auto& variable )
-            { return variable.Name == name; } );
+            { return variable.Id == id; } );
 
         if( it == m_ConfigVariables.end() )
         {
             ConfigurationSystem::ConfigVariable variable{
                 .Name = std::string( name ),
                 .CurrentValue = 0,
-                .InitialValue = 0
+                .InitialValue = 0,
+                .Id = id
             };
             m_ConfigVariables.emplace_back( std::move( variable ) );
             it = m_ConfigVariables.end() - 1;
@@ -702,6 +716,24 @@ void CBaseEntity::SetOrigin( const Vector& origin )
     g_engfuncs.pfnSetOrigin( edict(), origin );
 }
 
+void CBaseEntity::SetClassname( string_t classname )
+{
+    pev->classname = classname;
+    g_EntityNameIndex.Update( this );
+}
+
+void CBaseEntity::SetTargetname( string_t targetname )
+{
+    pev->targetname = targetname;
+    g_EntityNameIndex.Update( this );
+}
+
+void CBaseEntity::SetTarget( string_t target )
+{
+    pev->target = target;
+    g_EntityNameIndex.Update( this );
+}
+
 void CBaseEntity::LoadReplacementFiles()
 {
     LoadFileNameReplacementMap( m_ModelReplacement, m_ModelReplacementFileName );
@@ -1162,50 +1194,3 @@ bool CBaseEntity::AppearFlags( const char* keyname, int value )
     }
     return true;
 }
-
-std::string& CBaseEntity::KeyValueManager::GetValue( std::string_view key )
-{
-    std::string keyname = std::string( key );
-
-    if( KeyValues.find( keyname ) != KeyValues.end() )
-    {
-        return KeyValues.at( keyname );
-    }
-
-    static std::string empty;
-    return empty;
-}
-
-void CBaseEntity::KeyValueManager::SetValue( std::string_view key, std::string_view value )
-{
-    // If we're in multiplayer SaveRestore shouldn't be important, maybe skip this condition?
-    if( auto tsize = KeyValues.size(); tsize >= MAX_KEYVALUEMANAGER_ENTRIES ) {
-        CBaseEntity::Logger->warn( "Couldn't add key-value pair \"{}:{}\" list on size limit {}!", key, value, tsize );
-        return;
-    }
-
-    KeyValues[ std::string( key ) ] = std::string( value );
-}
-
-void CBaseEntity::KeyValueManager::Restore()
-{
-    for( int i = 0; i < size; ++i )
-    {
-        SetValue( STRING( m_Keys[i] ), STRING( m_Values[i] ) );
-    }
-}
-
-void CBaseEntity::KeyValueManager::Save()
-{
-    // Custom keyvalues are always saved
-    if( custom || g_Server.GetMapState()->KeyValueManager )
-    {
-        for( const auto& [ key, value ] : KeyValues )
-        {
-            m_Keys[size] = ALLOC_STRING( key.c_str() );
-            m_Values[size] = ALLOC_STRING( value.c_str() );
-
-            ++size;
-        }
-    }
-}
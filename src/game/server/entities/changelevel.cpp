@@ -246,7 +246,7 @@ void CChangeLevel::ChangeLevelNow( CBaseEntity* pActivator )
             if( pFireAndDie )
             {
                 // Set target and delay
-                pFireAndDie->pev->target = m_changeTarget;
+                pFireAndDie->SetTarget( m_changeTarget );
                 pFireAndDie->m_flDelay = m_changeTargetDelay;
                 pFireAndDie->pev->origin = pPlayer->pev->origin;
                 // Call spawn
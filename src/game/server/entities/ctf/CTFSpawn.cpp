@@ -92,7 +92,7 @@ SpawnAction CTFSpawn::Spawn()
     m_sMaster = pev->classname;
 
     // Change the classname to the owning team's spawn name
-    pev->classname = MAKE_STRING( sTeamSpawnNames[static_cast<int>( team_no )] );
+    SetClassname( MAKE_STRING( sTeamSpawnNames[static_cast<int>( team_no )] ) );
     m_fState = true;
 
     return SpawnAction::Spawn;
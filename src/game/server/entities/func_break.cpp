@@ -720,7 +720,7 @@ void CBreakable::Die()
     }
 
     // Don't fire something that could fire myself
-    pev->targetname = string_t::Null;
+    SetTargetname( string_t::Null );
 
     pev->solid = SOLID_NOT;
     // Fire targets on break
@@ -317,8 +317,8 @@ CBasePlayerWeapon* CBasePlayerWeapon::GetItemToRespawn( const Vector& respawnPoi
     }
 
     // Copy over item settings
-    newWeapon->pev->targetname = pev->targetname;
-    newWeapon->pev->target = pev->target;
+    newWeapon->SetTargetname( pev->targetname );
+    newWeapon->SetTarget( pev->target );
     newWeapon->m_flDelay = m_flDelay;
     newWeapon->pev->model = m_WorldModel;
     newWeapon->pev->sequence = pev->sequence;
@@ -350,7 +350,7 @@ CBasePlayerWeapon* CBasePlayerWeapon::GetItemToRespawn( const Vector& respawnPoi
     DispatchSpawn( newWeapon->edict() );
 
     // Don't allow this weapon to be targeted from now on.
-    pev->targetname = string_t::Null;
+    SetTargetname( string_t::Null );
 
     // This weapon has been picked up, so from now own it should play pickup sounds (when dropped and picked up again).
     m_PlayPickupSound = false;
@@ -552,7 +552,9 @@ void CFuncTrain::Use( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_TYPE us
         pev->spawnflags |= SF_TRAIN_WAIT_RETRIGGER;
         // Pop back to last target if it's available
         if( m_LastTarget )
-            pev->target = m_LastTarget->pev->targetname;
+        {
+            SetTarget( m_LastTarget->pev->targetname );
+        }
         pev->nextthink = 0;
         pev->velocity = g_vecZero;
         StopSound( CHAN_STATIC, STRING( m_MoveSound ) );
@@ -612,7 +614,7 @@ void CFuncTrain::Next()
     // Save last target in case we need to find it again
     pev->message = pev->target;
 
-    pev->target = pTarg->pev->target;
+    SetTarget( pTarg->pev->target );
     m_flWait = pTarg->GetDelay();
 
     if( m_CurrentTarget && m_CurrentTarget->pev->speed != 0 )
@@ -659,7 +661,7 @@ void CFuncTrain::Activate()
             target = World;
         }
 
-        pev->target = target->pev->target;
+        SetTarget( target->pev->target );
         m_CurrentTarget = target; // keep track of this since path corners change our target for us.
 
         SetOrigin( target->pev->origin - ( pev->mins + pev->maxs ) * 0.5 );
@@ -712,7 +714,7 @@ void CFuncTrain::OverrideReset()
     // Are we moving?
     if( pev->velocity != g_vecZero && pev->nextthink != 0 )
     {
-        pev->target = pev->message;
+        SetTarget( pev->message );
         // now find our next target
         pTarg = GetNextTarget();
         if( !pTarg )
@@ -849,7 +851,9 @@ void CSpriteTrain::Use( CBaseEntity* pActivator, CBaseEntity* pCaller, USE_TYPE
         pev->spawnflags |= SF_TRAIN_WAIT_RETRIGGER;
         // Pop back to last target if it's available
         if( m_LastTarget )
-            pev->target = m_LastTarget->pev->targetname;
+        {
+            SetTarget( m_LastTarget->pev->targetname );
+        }
 
         pev->velocity = g_vecZero;
         EmitSound( CHAN_VOICE, STRING( m_StopSound ), m_volume, ATTN_NORM );
@@ -912,7 +916,7 @@ void CSpriteTrain::Next()
     // Save last target in case we need to find it again
     pev->message = pev->target;
 
-    pev->target = pTarg->pev->target;
+    SetTarget( pTarg->pev->target );
     m_flWait = pTarg->GetDelay();
 
     if( m_CurrentTarget && m_CurrentTarget->pev->speed != 0 )
@@ -959,7 +963,7 @@ void CSpriteTrain::Activate()
             target = World;
         }
 
-        pev->target = target->pev->target;
+        SetTarget( target->pev->target );
         m_CurrentTarget = target; // keep track of this since path corners change our target for us.
 
         SetOrigin( target->pev->origin - ( pev->mins + pev->maxs ) * 0.5 );
@@ -1029,7 +1033,7 @@ void CSpriteTrain::OverrideReset()
     // Are we moving?
     if( pev->velocity != g_vecZero && pev->nextthink != 0 )
     {
-        pev->target = pev->message;
+        SetTarget( pev->message );
         // now find our next target
         pTarg = GetNextTarget();
         if( !pTarg )
@@ -2304,7 +2308,7 @@ void CGunTarget::Wait()
 
     m_flWait = pTarget->GetDelay();
 
-    pev->target = pTarget->pev->target;
+    SetTarget( pTarget->pev->target );
     SetThink( &CGunTarget::Next );
     if( m_flWait != 0 )
     { // -1 wait will wait forever!
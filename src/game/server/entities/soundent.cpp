@@ -25,6 +25,9 @@ void CSound::Clear()
     m_flExpireTime = 0;
     m_iNext = SOUNDLIST_EMPTY;
     m_iNextAudible = 0;
+    m_GridCell = 0;
+    m_iGridSlot = -1;
+    m_AllocationNumber = 0;
 }
 
 void CSound::Reset()
@@ -93,12 +96,21 @@ void CSoundEnt::Think()
         }
     }
 
+    UpdateMaxGridVolume();
+
     if( m_fShowReport )
     {
         Logger->trace( "Soundlist: {} / {} ({})\n",
             ISoundsInList( SOUNDLISTTYPE_ACTIVE ), ISoundsInList( SOUNDLISTTYPE_FREE ), ISoundsInList( SOUNDLISTTYPE_ACTIVE ) - m_cLastActiveSounds );
         m_cLastActiveSounds = ISoundsInList( SOUNDLISTTYPE_ACTIVE );
+
+        Logger->trace( "Listen: {} queries, {:.1f} sounds checked per query, {} sounds in {} grid cells\n",
+            m_cListenQueries, m_cListenQueries > 0 ? static_cast<float>( m_cListenSoundsChecked ) / m_cListenQueries : 0.f,
+            m_cGridSounds, m_SoundGrid.size() );
     }
+
+    m_cListenQueries = 0;
+    m_cListenSoundsChecked = 0;
 }
 
 void CSoundEnt::Precache()
@@ -126,6 +138,8 @@ void CSoundEnt::FreeSound( int iSound, int iPrevious )
         pSoundEnt->m_iActiveSound = pSoundEnt->m_SoundPool[iSound].m_iNext;
     }
 
+    pSoundEnt->RemoveFromGrid( iSound );
+
     // make iSound the head of the Free list.
     pSoundEnt->m_SoundPool[iSound].m_iNext = pSoundEnt->m_iFreeSound;
     pSoundEnt->m_iFreeSound = iSound;
@@ -133,7 +147,7 @@ void CSoundEnt::FreeSound( int iSound, int iPrevious )
 
 int CSoundEnt::IAllocSound()
 {
-    if( m_iFreeSound == SOUNDLIST_EMPTY )
+    if( m_iFreeSound == SOUNDLIST_EMPTY && !GrowSoundPool() )
     {
         // no free sound!
         Logger->debug( "Free Sound List is full!" );
@@ -151,6 +165,8 @@ int CSoundEnt::IAllocSound()
 
     m_iActiveSound = iNewSound; // now make the new sound the top of the active list. You're done.
 
+    m_SoundPool[iNewSound].m_AllocationNumber = m_NextAllocationNumber++;
+
     return iNewSound;
 }
 
@@ -174,12 +190,32 @@ void CSoundEnt::InsertSound( int iType, const Vector& vecOrigin, int iVolume, fl
     pSoundEnt->m_SoundPool[iThisSound].m_iType = iType;
     pSoundEnt->m_SoundPool[iThisSound].m_iVolume = iVolume;
     pSoundEnt->m_SoundPool[iThisSound].m_flExpireTime = gpGlobals->time + flDuration;
+
+    g_MonsterThinkLOD.OnSoundInserted( iType, vecOrigin, iVolume );
+
+    // Client sounds are moved by the player every frame.
+    if( iThisSound >= pSoundEnt->m_cReservedSounds )
+    {
+        pSoundEnt->AddToGrid( iThisSound );
+    }
 }
 
 void CSoundEnt::Initialize()
 {
     m_iFreeSound = 0;
     m_iActiveSound = SOUNDLIST_EMPTY;
+    m_cReservedSounds = 0;
+    m_SoundGrid.clear();
+    m_cGridSounds = 0;
+    m_iMaxGridVolume = 0;
+    m_cListenQueries = 0;
+    m_cListenSoundsChecked = 0;
+    m_NextAllocationNumber = 0;
+
+    // Reserve room for the largest list so growing it doesn't move sounds that monsters point to.
+    m_SoundPool.clear();
+    m_SoundPool.reserve( MAX_WORLD_SOUNDS_LIMIT );
+    m_SoundPool.resize( MAX_WORLD_SOUNDS );
 
     int i;
 
@@ -204,6 +240,7 @@ void CSoundEnt::Initialize()
         }
 
         pSoundEnt->m_SoundPool[iSound].m_flExpireTime = SOUND_NEVER_EXPIRE;
+        ++m_cReservedSounds;
     }
 
     if( CVAR_GET_FLOAT( "displaysoundlist" ) == 1 )
@@ -269,7 +306,7 @@ CSound* CSoundEnt::SoundPointerForIndex( int iIndex )
         return nullptr;
     }
 
-    if( iIndex > ( MAX_WORLD_SOUNDS - 1 ) )
+    if( iIndex >= static_cast<int>( pSoundEnt->m_SoundPool.size() ) )
     {
         Logger->debug( "SoundPointerForIndex() - Index too large!" );
         return nullptr;
@@ -297,3 +334,97 @@ int CSoundEnt::ClientSoundIndex( edict_t* pClient )
 
     return iReturn;
 }
+
+bool CSoundEnt::GrowSoundPool()
+{
+    const int oldSize = static_cast<int>( m_SoundPool.size() );
+    const int newSize = std::min( oldSize * 2, MAX_WORLD_SOUNDS_LIMIT );
+
+    if( newSize <= oldSize )
+    {
+        return false;
+    }
+
+    assert( newSize <= static_cast<int>( m_SoundPool.capacity() ) );
+
+    m_SoundPool.resize( newSize );
+
+    // link the new sounds into the free list. The free list is empty when this is called.
+    for( int i = oldSize; i < newSize; ++i )
+    {
+        m_SoundPool[i].Clear();
+        m_SoundPool[i].m_iNext = i + 1;
+    }
+
+    m_SoundPool[newSize - 1].m_iNext = m_iFreeSound;
+    m_iFreeSound = oldSize;
+
+    Logger->debug( "Sound list grown to {} sounds", newSize );
+
+    return true;
+}
+
+std::int64_t CSoundEnt::GetGridCell( int x, int y )
+{
+    return ( static_cast<std::int64_t>( x ) << 32 ) | static_cast<std::uint32_t>( y );
+}
+
+void CSoundEnt::AddToGrid( int iSound )
+{
+    auto& sound = m_SoundPool[iSound];
+
+    sound.m_GridCell = GetGridCell(
+        static_cast<int>( std::floor( sound.m_vecOrigin.x / SOUND_GRID_CELL_SIZE ) ),
+        static_cast<int>( std::floor( sound.m_vecOrigin.y / SOUND_GRID_CELL_SIZE ) ) );
+
+    auto& cell = m_SoundGrid[sound.m_GridCell];
+
+    sound.m_iGridSlot = static_cast<int>( cell.size() );
+    cell.push_back( iSound );
+
+    ++m_cGridSounds;
+    m_iMaxGridVolume = std::max( m_iMaxGridVolume, sound.m_iVolume );
+}
+
+void CSoundEnt::RemoveFromGrid( int iSound )
+{
+    auto& sound = m_SoundPool[iSound];
+
+    if( sound.m_iGridSlot == -1 )
+    {
+        return;
+    }
+
+    if( auto it = m_SoundGrid.find( sound.m_GridCell ); it != m_SoundGrid.end() )
+    {
+        auto& cell = it->second;
+
+        // move the last sound in the cell into this one's slot.
+        const int iLast = cell.back();
+        cell[sound.m_iGridSlot] = iLast;
+        m_SoundPool[iLast].m_iGridSlot = sound.m_iGridSlot;
+        cell.pop_back();
+
+        if( cell.empty() )
+        {
+            m_SoundGrid.erase( it );
+        }
+
+        --m_cGridSounds;
+    }
+
+    sound.m_iGridSlot = -1;
+}
+
+void CSoundEnt::UpdateMaxGridVolume()
+{
+    m_iMaxGridVolume = 0;
+
+    for( int iSound = m_iActiveSound; iSound != SOUNDLIST_EMPTY; iSound = m_SoundPool[iSound].m_iNext )
+    {
+        if( m_SoundPool[iSound].m_iGridSlot != -1 )
+        {
+            m_iMaxGridVolume = std::max( m_iMaxGridVolume, m_SoundPool[iSound].m_iVolume );
+        }
+    }
+}
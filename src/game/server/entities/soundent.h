@@ -15,9 +15,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <EASTL/fixed_vector.h>
+
 #include "CBaseEntity.h"
 
-#define MAX_WORLD_SOUNDS 64 // maximum number of sounds handled by the world at one time.
+#define MAX_WORLD_SOUNDS 64          // number of sounds handled by the world at map start.
+#define MAX_WORLD_SOUNDS_LIMIT 2048 // the sound list grows up to this many sounds when it runs out.
+
+#define SOUND_GRID_CELL_SIZE 512 // size of the cells used to look up sounds by position.
 
 #define bits_SOUND_NONE 0
 #define bits_SOUND_COMBAT (1 << 0)    // gunshots, explosions
@@ -60,6 +71,10 @@ public:
     int m_iNext;          // index of next sound in this list ( Active or Free )
     int m_iNextAudible;      // temporary link that monsters use to build a list of audible sounds
 
+    std::int64_t m_GridCell; // grid cell this sound is stored in. Client sounds are not stored in the grid.
+    int m_iGridSlot;         // index of this sound in its grid cell
+    std::uint64_t m_AllocationNumber; // sounds allocated later have higher numbers, so this gives the active list order.
+
     /**
      *    @brief returns true if the sound is an Audible sound
      */
@@ -101,9 +116,24 @@ public:
      *    TAKE CARE to only call this function for sounds in the Active list!!
      */
     static void FreeSound( int iSound, int iPrevious );
-    static int ActiveList();                         //!< return the head of the active list
-    static int FreeList();                             //!< return the head of the free list
-    static CSound* SoundPointerForIndex( int iIndex ); //!< return a pointer for this index in the sound list
+    static int ActiveList(); //!< return the head of the active list
+    static int FreeList();     //!< return the head of the free list
+
+    /**
+     *    @brief return a pointer for this index in the sound list.
+     *    Pointers stay valid when the sound list grows since room for the largest list is reserved up front.
+     */
+    static CSound* SoundPointerForIndex( int iIndex );
+
+    /**
+     *    @brief Calls @p callback with the index of and a pointer to every active sound that a listener at @p origin
+     *    with the given hearing sensitivity could hear. Some of the sounds passed may be out of range.
+     *    @details Client sounds move every frame so they are always passed. Other sounds are looked up in a grid,
+     *    unless there are so few of them that checking each one is cheaper.
+     *    Sounds are passed in active list order either way, since monsters pick between equally good sounds by it.
+     */
+    template <typename Callback>
+    static void ForEachSoundNear( const Vector& origin, float hearingSensitivity, Callback&& callback );
 
     /**
      *    @brief Clients are numbered from 1 to MAXCLIENTS,
@@ -131,7 +161,114 @@ public:
     bool m_fShowReport;         // if true, dump information about free/active sounds.
 
 private:
-    CSound m_SoundPool[MAX_WORLD_SOUNDS];
+    /**
+     *    @brief Adds more sounds to the free list.
+     *    @return Whether any sounds were added.
+     */
+    bool GrowSoundPool();
+
+    static std::int64_t GetGridCell( int x, int y );
+
+    void AddToGrid( int iSound );
+    void RemoveFromGrid( int iSound );
+
+    /**
+     *    @brief Recomputes the loudest sound in the grid after sounds have been removed.
+     */
+    void UpdateMaxGridVolume();
+
+private:
+    std::vector<CSound> m_SoundPool;
+
+    // Sounds 0 to m_cReservedSounds - 1 belong to clients.
+    int m_cReservedSounds = 0;
+
+    std::uint64_t m_NextAllocationNumber = 0;
+
+    std::unordered_map<std::int64_t, std::vector<int>> m_SoundGrid;
+    int m_cGridSounds = 0;
+    int m_iMaxGridVolume = 0;
+
+    // Number of calls to ForEachSoundNear and sounds passed to them since the last report.
+    int m_cListenQueries = 0;
+    int m_cListenSoundsChecked = 0;
 };
 
 inline CSoundEnt* pSoundEnt;
+
+template <typename Callback>
+void CSoundEnt::ForEachSoundNear( const Vector& origin, float hearingSensitivity, Callback&& callback )
+{
+    if( !pSoundEnt )
+    {
+        return;
+    }
+
+    auto& soundEnt = *pSoundEnt;
+
+    ++soundEnt.m_cListenQueries;
+
+    const auto visit = [&]( int iSound )
+    {
+        ++soundEnt.m_cListenSoundsChecked;
+        callback( iSound, &soundEnt.m_SoundPool[iSound] );
+    };
+
+    // Client sounds are allocated first and never freed, so they are at the end of the active list in reverse order.
+    const auto visitReserved = [&]()
+    {
+        for( int i = soundEnt.m_cReservedSounds - 1; i >= 0; --i )
+        {
+            visit( i );
+        }
+    };
+
+    if( soundEnt.m_cGridSounds == 0 )
+    {
+        visitReserved();
+        return;
+    }
+
+    const float radius = std::max( 0.f, soundEnt.m_iMaxGridVolume * hearingSensitivity );
+
+    const int minX = static_cast<int>( std::floor( ( origin.x - radius ) / SOUND_GRID_CELL_SIZE ) );
+    const int maxX = static_cast<int>( std::floor( ( origin.x + radius ) / SOUND_GRID_CELL_SIZE ) );
+    const int minY = static_cast<int>( std::floor( ( origin.y - radius ) / SOUND_GRID_CELL_SIZE ) );
+    const int maxY = static_cast<int>( std::floor( ( origin.y + radius ) / SOUND_GRID_CELL_SIZE ) );
+
+    const std::int64_t cellCount = std::int64_t( maxX - minX + 1 ) * ( maxY - minY + 1 );
+
+    if( cellCount > soundEnt.m_cGridSounds )
+    {
+        for( int i = soundEnt.m_iActiveSound; i != SOUNDLIST_EMPTY; i = soundEnt.m_SoundPool[i].m_iNext )
+        {
+            visit( i );
+        }
+
+        return;
+    }
+
+    eastl::fixed_vector<int, 64> sounds;
+
+    for( int x = minX; x <= maxX; ++x )
+    {
+        for( int y = minY; y <= maxY; ++y )
+        {
+            if( auto it = soundEnt.m_SoundGrid.find( GetGridCell( x, y ) ); it != soundEnt.m_SoundGrid.end() )
+            {
+                sounds.insert( sounds.end(), it->second.begin(), it->second.end() );
+            }
+        }
+    }
+
+    // Most recently allocated first, like the active list.
+    std::sort( sounds.begin(), sounds.end(), [&]( int lhs, int rhs )
+        { return soundEnt.m_SoundPool[lhs].m_AllocationNumber > soundEnt.m_SoundPool[rhs].m_AllocationNumber; } );
+
+    for( int iSound : sounds )
+    {
+        visit( iSound );
+    }
+
+    visitReserved();
+}
@@ -509,7 +509,7 @@ void CBaseDelay::SUB_UseTargets( CBaseEntity* pActivator, USE_TYPE useType, UseV
         pTemp->pev->button = static_cast<int>( useType );
         pTemp->m_iszKillTarget = m_iszKillTarget;
         pTemp->m_flDelay = 0; // prevent "recursion"
-        pTemp->pev->target = pev->target;
+        pTemp->SetTarget( pev->target );
         pTemp->m_hActivator = pActivator;
 
         return;
@@ -20,6 +20,7 @@
 
 #include "cbase.h"
 #include "CBaseTrigger.h"
+#include "EntityNameIndex.h"
 #include "trains.h" // trigger_camera has train functionality
 #include "CHalfLifeCTFplay.h"
 #include "ctf/ctf_goals.h"
@@ -357,6 +358,7 @@ CMultiManager* CMultiManager::Clone()
     edict_t* pEdict = pMulti->pev->pContainingEntity;
     memcpy( pMulti->pev, pev, sizeof( *pev ) );
     pMulti->pev->pContainingEntity = pEdict;
+    g_EntityNameIndex.Update( pMulti );
 
     pMulti->pev->spawnflags |= SF_MULTIMAN_CLONE;
     pMulti->m_cTargets = m_cTargets;
@@ -638,7 +640,9 @@ void CTriggerHurt::HurtTouch( CBaseEntity* pOther )
 
         SUB_UseTargets( pOther, USE_TOGGLE );
         if( ( pev->spawnflags & SF_TRIGGER_HURT_TARGETONCE ) != 0 )
-            pev->target = string_t::Null;
+        {
+            SetTarget( string_t::Null );
+        }
     }
 }
 
@@ -1112,7 +1116,7 @@ void CTriggerChangeTarget::Use( CBaseEntity* pActivator, CBaseEntity* pCaller, U
 
     if( pTarget )
     {
-        pTarget->pev->target = m_iszNewTarget;
+        pTarget->SetTarget( m_iszNewTarget );
         CBaseMonster* pMonster = pTarget->MyMonsterPointer();
         if( pMonster )
         {
@@ -1734,7 +1738,9 @@ void COFTriggerGeneWormHit::GeneWormHitTouch( CBaseEntity* pOther )
                 SUB_UseTargets( pOther, USE_TOGGLE );
 
                 if( ( pev->spawnflags & SF_GENEWORM_HIT_TARGET_ONCE ) != 0 )
-                    pev->target = string_t::Null;
+                {
+                    SetTarget( string_t::Null );
+                }
             }
         }
     }
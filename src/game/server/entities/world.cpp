@@ -440,7 +440,9 @@ void CWorld::Precache()
                 if( CTriggerEventHandler* event = g_EntityDictionary->Create<CTriggerEventHandler>( "trigger_eventhandler" ); event != nullptr )
                 {
                     event->m_EventType = TriggerEventType::PlayerActivate;
-                    pEntity->pev->targetname = event->pev->target = MAKE_STRING( "EVM_ChapterTitle" );
+                    const auto name = MAKE_STRING( "EVM_ChapterTitle" );
+                    pEntity->SetTargetname( name );
+                    event->SetTarget( name );
                 }
             }
             else
@@ -57,6 +57,16 @@ cvar_t sv_schedule_debug{"sv_schedule_debug", "0", FCVAR_SERVER};
 
 cvar_t mp_classic_mode{ "mp_classic_mode", "0", FCVAR_SERVER };
 
+// 0 means use all available cores.
+cvar_t sv_nodegraph_build_threads{"sv_nodegraph_build_threads", "0", FCVAR_SERVER};
+cvar_t sv_nodegraph_stats{"sv_nodegraph_stats", "0", FCVAR_SERVER};
+
+// Set to 0 to make entity box and sphere queries scan every edict.
+cvar_t sv_entity_partition{"sv_entity_partition", "1", FCVAR_SERVER};
+
+// Set to 0 to make classname, targetname and target lookups scan every edict.
+cvar_t sv_entity_name_index{"sv_entity_name_index", "1", FCVAR_SERVER};
+
 static bool SV_InitServer()
 {
     if( !FileSystem_LoadFileSystem() )
@@ -142,6 +152,11 @@ void GameDLLInit()
 
     CVAR_REGISTER( &sv_schedule_debug );
 
+    CVAR_REGISTER( &sv_nodegraph_build_threads );
+    CVAR_REGISTER( &sv_nodegraph_stats );
+    CVAR_REGISTER( &sv_entity_partition );
+    CVAR_REGISTER( &sv_entity_name_index );
+
     // Link user messages immediately so there are no race conditions.
     LinkUserMessages();
 }
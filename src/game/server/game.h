@@ -50,6 +50,11 @@ extern cvar_t sv_schedule_debug;
 
 extern cvar_t mp_classic_mode;
 
+extern cvar_t sv_nodegraph_build_threads;
+extern cvar_t sv_nodegraph_stats;
+extern cvar_t sv_entity_partition;
+extern cvar_t sv_entity_name_index;
+
 // Engine Cvars
 inline cvar_t* g_psv_gravity;
 inline cvar_t* g_psv_aim;
@@ -16,8 +16,14 @@
 // nodes.cpp - AI node tree stuff.
 //=========================================================
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <limits>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "cbase.h"
 #include "CCorpse.h"
@@ -35,6 +41,18 @@
 
 CGraph WorldGraph;
 
+// These belong to WorldGraph but can't be members since CGraph is saved to disk as-is.
+static CPathSearch g_PathSearch; // Used by FindShortestPath on the main thread.
+static CNodeGrid g_NodeGrid;
+static CNearestNodeCache g_NearestNodeCache;
+
+static struct
+{
+    int Lookups;
+    int CacheHits;
+    int Traces;
+} g_NearestNodeStats;
+
 LINK_ENTITY_TO_CLASS( info_node, CNodeEnt );
 LINK_ENTITY_TO_CLASS( info_node_air, CNodeEnt );
 
@@ -96,6 +114,9 @@ void CGraph::InitGraph()
 
     m_iLastActiveIdleSearch = 0;
     m_iLastCoverSearch = 0;
+
+    g_NodeGrid.Clear();
+    g_NearestNodeCache.Clear();
 }
 
 //=========================================================
@@ -545,6 +566,158 @@ int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 }
 
 
+static int HullLinkMask( int iHull )
+{
+    switch ( iHull )
+    {
+    default:
+    case NODE_SMALL_HULL:
+        return bits_LINK_SMALL_HULL;
+    case NODE_HUMAN_HULL:
+        return bits_LINK_HUMAN_HULL;
+    case NODE_LARGE_HULL:
+        return bits_LINK_LARGE_HULL;
+    case NODE_FLY_HULL:
+        return bits_LINK_FLY_HULL;
+    }
+}
+
+//=========================================================
+// SearchShortestPath - shortest path search from iStart to
+// iDest using links that fit iHullMask and pass canUseLink.
+// Nodes are taken from the queue in order of distance so far
+// plus heuristic( iNode ), which must never overestimate the
+// remaining distance. Writes the path into piPath and returns
+// the number of nodes in it, or 0 if there is none.
+// Only touches search and the graph, so it is safe to call
+// from worker threads if canUseLink is.
+//=========================================================
+template <typename LinkFilter, typename Heuristic>
+static int SearchShortestPath( const CGraph& graph, CPathSearch& search, int* piPath, int iStart, int iDest, int iHullMask,
+    LinkFilter&& canUseLink, Heuristic&& heuristic )
+{
+    if( iStart == iDest )
+    {
+        piPath[0] = iStart;
+        piPath[1] = iDest;
+        return 2;
+    }
+
+    search.Begin( graph.m_cNodes );
+
+    auto& start = search.Visit( iStart );
+    start.ClosestSoFar = 0.0;
+    start.PreviousNode = iStart; // tag this as the origin node
+    search.Queue.Insert( iStart, heuristic( iStart ) ); // insert start node
+
+    while( !search.Queue.Empty() )
+    {
+        // now pull a node out of the queue
+        float flEstimate;
+        const int iCurrentNode = search.Queue.Remove( flEstimate );
+
+        if( iCurrentNode == iDest )
+            break;
+
+        auto& current = search.State( iCurrentNode );
+
+        // A node can be in the queue more than once if a shorter path to it was found after it was added.
+        // Expanding the later entries can't improve on anything, so they are skipped.
+        if( current.Closed )
+            continue;
+
+        current.Closed = true;
+
+        const float flCurrentDistance = current.ClosestSoFar;
+        const CNode& currentNode = graph.m_pNodes[iCurrentNode];
+
+        for( int i = 0; i < currentNode.m_cNumLinks; i++ )
+        { // run through all of this node's neighbors
+            const CLink& link = graph.m_pLinkPool[currentNode.m_iFirstLink + i];
+
+            if( ( link.m_afLinkInfo & iHullMask ) != iHullMask )
+            { // monster is too large to walk this connection
+                continue;
+            }
+
+            const int iVisitNode = link.m_iDestNode;
+            const bool visited = search.Visited( iVisitNode );
+
+            if( visited && search.State( iVisitNode ).Closed )
+                continue;
+
+            if( !canUseLink( iCurrentNode, link ) )
+                continue;
+
+            const float flOurDistance = flCurrentDistance + link.m_flWeight;
+
+            if( !visited || flOurDistance < search.State( iVisitNode ).ClosestSoFar - 0.001 )
+            {
+                auto& visit = search.Visit( iVisitNode );
+                visit.ClosestSoFar = flOurDistance;
+                visit.PreviousNode = iCurrentNode;
+
+                search.Queue.Insert( iVisitNode, flOurDistance + heuristic( iVisitNode ) );
+            }
+        }
+    }
+
+    if( !search.Visited( iDest ) )
+    { // Destination is unreachable, no path found.
+        return 0;
+    }
+
+    // now we must walk backwards through the PreviousNode field, and count how many connections there are in the path
+    int iNumPathNodes = 1; // count the dest
+
+    for( int iCurrentNode = iDest; iCurrentNode != iStart; iCurrentNode = search.State( iCurrentNode ).PreviousNode )
+    {
+        iNumPathNodes++;
+    }
+
+    int iCurrentNode = iDest;
+    for( int i = iNumPathNodes - 1; i >= 0; i-- )
+    {
+        piPath[i] = iCurrentNode;
+        iCurrentNode = search.State( iCurrentNode ).PreviousNode;
+    }
+
+    return iNumPathNodes;
+}
+
+//=========================================================
+// DijkstraShortestPath - SearchShortestPath without a
+// heuristic. Nodes are settled in order of distance through
+// the same priority queue the original search used, so equal
+// length paths are resolved the same way and routing tables
+// come out identical.
+//=========================================================
+template <typename LinkFilter>
+static int DijkstraShortestPath( const CGraph& graph, CPathSearch& search, int* piPath, int iStart, int iDest, int iHullMask, LinkFilter&& canUseLink )
+{
+    return SearchShortestPath( graph, search, piPath, iStart, iDest, iHullMask, canUseLink,
+        []( int )
+        { return 0.f; } );
+}
+
+//=========================================================
+// AStarShortestPath - SearchShortestPath guided by the
+// straight line distance to the destination. Link weights
+// are 2D distances so the 2D distance is used, which never
+// overestimates. Paths have the same length as the ones
+// DijkstraShortestPath finds, but equal length paths may be
+// picked differently.
+//=========================================================
+template <typename LinkFilter>
+static int AStarShortestPath( const CGraph& graph, CPathSearch& search, int* piPath, int iStart, int iDest, int iHullMask, LinkFilter&& canUseLink )
+{
+    const Vector& vecDest = graph.m_pNodes[iDest].m_vecOrigin;
+
+    return SearchShortestPath( graph, search, piPath, iStart, iDest, iHullMask, canUseLink,
+        [&]( int iNode )
+        { return ( graph.m_pNodes[iNode].m_vecOrigin - vecDest ).Length2D(); } );
+}
+
 //=========================================================
 // CGraph - FindShortestPath
 //
@@ -554,10 +727,8 @@ int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 //=========================================================
 int CGraph::FindShortestPath( int* piPath, int iStart, int iDest, int iHull, int afCapMask )
 {
-    int iVisitNode;
     int iCurrentNode;
     int iNumPathNodes;
-    int iHullMask;
 
     if( 0 == m_fGraphPresent || 0 == m_fGraphPointersSet )
     { // protect us in the case that the node graph isn't available or built
@@ -614,102 +785,13 @@ int CGraph::FindShortestPath( int* piPath, int iStart, int iDest, int iHull, int
     }
     else
     {
-        CQueuePriority queue;
-
-        switch ( iHull )
-        {
-        default:
-        case NODE_SMALL_HULL:
-            iHullMask = bits_LINK_SMALL_HULL;
-            break;
-        case NODE_HUMAN_HULL:
-            iHullMask = bits_LINK_HUMAN_HULL;
-            break;
-        case NODE_LARGE_HULL:
-            iHullMask = bits_LINK_LARGE_HULL;
-            break;
-        case NODE_FLY_HULL:
-            iHullMask = bits_LINK_FLY_HULL;
-            break;
-        }
-
-        // Mark all the nodes as unvisited.
-        //
-        int i;
-        for( i = 0; i < m_cNodes; i++ )
-        {
-            m_pNodes[i].m_flClosestSoFar = -1.0;
-        }
-
-        m_pNodes[iStart].m_flClosestSoFar = 0.0;
-        m_pNodes[iStart].m_iPreviousNode = iStart; // tag this as the origin node
-        queue.Insert( iStart, 0.0 );                   // insert start node
-
-        while( !queue.Empty() )
-        {
-            // now pull a node out of the queue
-            float flCurrentDistance;
-            iCurrentNode = queue.Remove( flCurrentDistance );
-
-            // For straight-line weights, the following Shortcut works. For arbitrary weights,
-            // it doesn't.
-            //
-            if( iCurrentNode == iDest )
-                break;
-
-            CNode* pCurrentNode = &m_pNodes[iCurrentNode];
-
-            for( i = 0; i < pCurrentNode->m_cNumLinks; i++ )
-            { // run through all of this node's neighbors
-
-                iVisitNode = INodeLink( iCurrentNode, i );
-                if( ( m_pLinkPool[m_pNodes[iCurrentNode].m_iFirstLink + i].m_afLinkInfo & iHullMask ) != iHullMask )
-                { // monster is too large to walk this connection
-                    // Logger->trace("fat ass {}/{}",m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo, iMonsterHull );
-                    continue;
-                }
-                // check the connection from the current node to the node we're about to mark visited and push into the queue
-                if( m_pLinkPool[m_pNodes[iCurrentNode].m_iFirstLink + i].m_pLinkEnt != nullptr )
-                { // there's a brush ent in the way! Don't mark this node or put it into the queue unless the monster can negotiate it
-
-                    if( !HandleLinkEnt( iCurrentNode, m_pLinkPool[m_pNodes[iCurrentNode].m_iFirstLink + i].m_pLinkEnt, afCapMask, NODEGRAPH_STATIC ) )
-                    { // monster should not try to go this way.
-                        continue;
-                    }
-                }
-                float flOurDistance = flCurrentDistance + m_pLinkPool[m_pNodes[iCurrentNode].m_iFirstLink + i].m_flWeight;
-                if( m_pNodes[iVisitNode].m_flClosestSoFar < -0.5 || flOurDistance < m_pNodes[iVisitNode].m_flClosestSoFar - 0.001 )
-                {
-                    m_pNodes[iVisitNode].m_flClosestSoFar = flOurDistance;
-                    m_pNodes[iVisitNode].m_iPreviousNode = iCurrentNode;
-
-                    queue.Insert( iVisitNode, flOurDistance );
-                }
-            }
-        }
-        if( m_pNodes[iDest].m_flClosestSoFar < -0.5 )
-        { // Destination is unreachable, no path found.
-            return 0;
-        }
-
-        // the queue is not empty
-
-        // now we must walk backwards through the m_iPreviousNode field, and count how many connections there are in the path
-        iCurrentNode = iDest;
-        iNumPathNodes = 1; // count the dest
-
-        while( iCurrentNode != iStart )
-        {
-            iNumPathNodes++;
-            iCurrentNode = m_pNodes[iCurrentNode].m_iPreviousNode;
-        }
-
-        iCurrentNode = iDest;
-        for( i = iNumPathNodes - 1; i >= 0; i-- )
-        {
-            piPath[i] = iCurrentNode;
-            iCurrentNode = m_pNodes[iCurrentNode].m_iPreviousNode;
-        }
+        // Only used before the routing tables are built, where the order of equal length paths doesn't matter.
+        iNumPathNodes = AStarShortestPath( *this, g_PathSearch, piPath, iStart, iDest, HullLinkMask( iHull ),
+            [&]( int iNode, const CLink& link )
+            {
+                // there's a brush ent in the way! Don't use this link unless the monster can negotiate it
+                return link.m_pLinkEnt == nullptr || HandleLinkEnt( iNode, link.m_pLinkEnt, afCapMask, NODEGRAPH_STATIC );
+            } );
     }
 
 #if 0
@@ -752,84 +834,247 @@ int CGraph::FindShortestPath( int* piPath, int iStart, int iDest, int iHull, int
     return iNumPathNodes;
 }
 
-inline unsigned int Hash( const void* p, int len )
+// Convert from [-8192,8192] to [0, 255]
+//
+inline int CALC_RANGE( int x, int lower, int upper )
 {
-    CRC32_t ulCrc;
-    CRC32_INIT( &ulCrc );
-    CRC32_PROCESS_BUFFER( &ulCrc, p, len );
-    return CRC32_FINAL( ulCrc );
+    return NUM_RANGES * ( x - lower ) / ( ( upper - lower + 1 ) );
 }
 
-void inline CalcBounds( int& Lower, int& Upper, int Goal, int Best )
+#define NODE_GRID_CELL_SIZE 256 // Smallest cell size, grows if the map is large enough to need more than NODE_GRID_MAX_DIM cells.
+#define NODE_GRID_MAX_DIM 64
+
+void CNodeGrid::Build( const CNode* pNodes, int cNodes )
 {
-    int Temp = 2 * Goal - Best;
-    if( Best > Goal )
+    Clear();
+
+    if( cNodes <= 0 )
+        return;
+
+    Vector vecMins = pNodes[0].m_vecOriginPeek;
+    Vector vecMaxs = pNodes[0].m_vecOriginPeek;
+
+    for( int i = 1; i < cNodes; i++ )
     {
-        Lower = std::max( 0, Temp );
-        Upper = Best;
+        for( int j = 0; j < 3; j++ )
+        {
+            vecMins[j] = std::min( vecMins[j], pNodes[i].m_vecOriginPeek[j] );
+            vecMaxs[j] = std::max( vecMaxs[j], pNodes[i].m_vecOriginPeek[j] );
+        }
     }
-    else
+
+    const Vector vecSize = vecMaxs - vecMins;
+
+    m_vecMins = vecMins;
+    m_flCellSize = std::max( { static_cast<float>( NODE_GRID_CELL_SIZE ),
+        vecSize.x / NODE_GRID_MAX_DIM, vecSize.y / NODE_GRID_MAX_DIM, vecSize.z / NODE_GRID_MAX_DIM } );
+
+    for( int j = 0; j < 3; j++ )
+    {
+        m_Dims[j] = std::clamp( static_cast<int>( vecSize[j] / m_flCellSize ) + 1, 1, NODE_GRID_MAX_DIM );
+    }
+
+    const auto cellIndex = [this]( const Vector& vecOrigin )
+    {
+        return ( CellCoord( vecOrigin.z, 2 ) * m_Dims[1] + CellCoord( vecOrigin.y, 1 ) ) * m_Dims[0] + CellCoord( vecOrigin.x, 0 );
+    };
+
+    // Count the nodes in each cell, then turn the counts into offsets.
+    m_CellStart.resize( m_Dims[0] * m_Dims[1] * m_Dims[2] + 1, 0 );
+
+    for( int i = 0; i < cNodes; i++ )
+    {
+        ++m_CellStart[cellIndex( pNodes[i].m_vecOriginPeek ) + 1];
+    }
+
+    for( std::size_t i = 1; i < m_CellStart.size(); i++ )
+    {
+        m_CellStart[i] += m_CellStart[i - 1];
+    }
+
+    m_CellNodes.resize( cNodes );
+
+    std::vector<int> next( m_CellStart.begin(), m_CellStart.end() - 1 );
+
+    for( int i = 0; i < cNodes; i++ )
     {
-        Upper = std::min( 255, Temp );
-        Lower = Best;
+        m_CellNodes[next[cellIndex( pNodes[i].m_vecOriginPeek )]++] = i;
     }
 }
 
-// Convert from [-8192,8192] to [0, 255]
-//
-inline int CALC_RANGE( int x, int lower, int upper )
+void CNodeGrid::Clear()
 {
-    return NUM_RANGES * ( x - lower ) / ( ( upper - lower + 1 ) );
+    m_CellStart.clear();
+    m_CellNodes.clear();
+    m_Candidates.clear();
 }
 
+int CNodeGrid::CellCoord( float flValue, int iAxis ) const
+{
+    return std::clamp( static_cast<int>( ( flValue - m_vecMins[iAxis] ) / m_flCellSize ), 0, m_Dims[iAxis] - 1 );
+}
 
-void inline UpdateRange( int& minValue, int& maxValue, int Goal, int Best )
+void CNodeGrid::AddCell( const CNode* pNodes, const Vector& vecOrigin, int afNodeTypes, int x, int y, int z )
 {
-    int Lower, Upper;
-    CalcBounds( Lower, Upper, Goal, Best );
-    if( Upper < maxValue )
-        maxValue = Upper;
-    if( minValue < Lower )
-        minValue = Lower;
+    const int iCell = ( z * m_Dims[1] + y ) * m_Dims[0] + x;
+
+    for( int i = m_CellStart[iCell]; i < m_CellStart[iCell + 1]; i++ )
+    {
+        const int iNode = m_CellNodes[i];
+
+        if( ( pNodes[iNode].m_afNodeInfo & afNodeTypes ) == 0 )
+            continue;
+
+        m_Candidates.push_back( {( vecOrigin - pNodes[iNode].m_vecOriginPeek ).Length(), iNode} );
+        std::push_heap( m_Candidates.begin(), m_Candidates.end(), std::greater<>{} );
+    }
 }
 
-void CGraph::CheckNode( Vector vecOrigin, int iNode )
+//=========================================================
+// Visits the grid in shells of cells around vecOrigin. A node
+// that hasn't been added yet after shell r is at least
+// r * m_flCellSize away, so every candidate closer than that
+// can be handed to the visitor in order of distance.
+//=========================================================
+template <typename Visitor>
+int CNodeGrid::FindNearest( const CNode* pNodes, const Vector& vecOrigin, int afNodeTypes, Visitor&& visitor )
 {
-    // Have we already seen this point before?.
-    //
-    if( m_di[iNode].m_CheckedEvent == m_CheckedCounter )
-        return;
-    m_di[iNode].m_CheckedEvent = m_CheckedCounter;
+    if( IsEmpty() )
+        return NO_NODE;
 
-    float flDist = ( vecOrigin - m_pNodes[iNode].m_vecOriginPeek ).Length();
+    m_Candidates.clear();
 
-    if( flDist < m_flShortest )
+    const int center[3] = {CellCoord( vecOrigin.x, 0 ), CellCoord( vecOrigin.y, 1 ), CellCoord( vecOrigin.z, 2 )};
+
+    int maxRing = 0;
+
+    for( int j = 0; j < 3; j++ )
     {
-        TraceResult tr;
+        maxRing = std::max( {maxRing, center[j], m_Dims[j] - 1 - center[j]} );
+    }
 
-        // make sure that vecOrigin can trace to this node!
-        UTIL_TraceLine( vecOrigin, m_pNodes[iNode].m_vecOriginPeek, ignore_monsters, nullptr, &tr );
+    for( int ring = 0; ring <= maxRing; ring++ )
+    {
+        const int minZ = std::max( center[2] - ring, 0 );
+        const int maxZ = std::min( center[2] + ring, m_Dims[2] - 1 );
+        const int minY = std::max( center[1] - ring, 0 );
+        const int maxY = std::min( center[1] + ring, m_Dims[1] - 1 );
 
-        if( tr.flFraction == 1.0 )
+        for( int z = minZ; z <= maxZ; z++ )
         {
-            m_iNearest = iNode;
-            m_flShortest = flDist;
+            for( int y = minY; y <= maxY; y++ )
+            {
+                if( std::abs( z - center[2] ) == ring || std::abs( y - center[1] ) == ring )
+                {
+                    // On a face of the shell, add the whole row.
+                    for( int x = std::max( center[0] - ring, 0 ); x <= std::min( center[0] + ring, m_Dims[0] - 1 ); x++ )
+                    {
+                        AddCell( pNodes, vecOrigin, afNodeTypes, x, y, z );
+                    }
+                }
+                else
+                {
+                    // Inside the shell, only the ends of the row are new.
+                    if( const int x = center[0] - ring; x >= 0 )
+                    {
+                        AddCell( pNodes, vecOrigin, afNodeTypes, x, y, z );
+                    }
 
-            UpdateRange( m_minX, m_maxX, CALC_RANGE( vecOrigin.x, m_RegionMin[0], m_RegionMax[0] ), m_pNodes[iNode].m_Region[0] );
-            UpdateRange( m_minY, m_maxY, CALC_RANGE( vecOrigin.y, m_RegionMin[1], m_RegionMax[1] ), m_pNodes[iNode].m_Region[1] );
-            UpdateRange( m_minZ, m_maxZ, CALC_RANGE( vecOrigin.z, m_RegionMin[2], m_RegionMax[2] ), m_pNodes[iNode].m_Region[2] );
+                    if( const int x = center[0] + ring; ring > 0 && x < m_Dims[0] )
+                    {
+                        AddCell( pNodes, vecOrigin, afNodeTypes, x, y, z );
+                    }
+                }
+            }
+        }
 
-            // From maxCircle, calculate maximum bounds box. All points must be
-            // simultaneously inside all bounds of the box.
-            //
-            m_minBoxX = CALC_RANGE( vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0] );
-            m_maxBoxX = CALC_RANGE( vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0] );
-            m_minBoxY = CALC_RANGE( vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1] );
-            m_maxBoxY = CALC_RANGE( vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1] );
-            m_minBoxZ = CALC_RANGE( vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2] );
-            m_maxBoxZ = CALC_RANGE( vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2] );
+        const float flBound = ring < maxRing ? ring * m_flCellSize : std::numeric_limits<float>::max();
+
+        while( !m_Candidates.empty() && m_Candidates.front().Dist <= flBound )
+        {
+            std::pop_heap( m_Candidates.begin(), m_Candidates.end(), std::greater<>{} );
+            const auto candidate = m_Candidates.back();
+            m_Candidates.pop_back();
+
+            if( visitor( candidate.Node, candidate.Dist ) )
+            {
+                return candidate.Node;
+            }
         }
     }
+
+    return NO_NODE;
+}
+
+CNearestNodeCache::Key CNearestNodeCache::MakeKey( const Vector& vecOrigin, int afNodeTypes )
+{
+    Key key;
+
+    for( int i = 0; i < 3; i++ )
+    {
+        key.Origin[i] = static_cast<int>( std::floor( vecOrigin[i] / NODE_CACHE_QUANTUM ) );
+    }
+
+    key.NodeTypes = afNodeTypes;
+
+    return key;
+}
+
+std::size_t CNearestNodeCache::KeyHash::operator()( const Key& key ) const
+{
+    std::size_t hash = std::hash<int>{}( key.NodeTypes );
+
+    for( int value : key.Origin )
+    {
+        hash = hash * 31 + std::hash<int>{}( value );
+    }
+
+    return hash;
+}
+
+bool CNearestNodeCache::Find( const Vector& vecOrigin, int afNodeTypes, int& iNode )
+{
+    const auto it = m_Lookup.find( MakeKey( vecOrigin, afNodeTypes ) );
+
+    if( it == m_Lookup.end() )
+        return false;
+
+    // Move to the front to mark it as most recently used.
+    m_Entries.splice( m_Entries.begin(), m_Entries, it->second );
+    iNode = it->second->Node;
+    return true;
+}
+
+void CNearestNodeCache::Insert( const Vector& vecOrigin, int afNodeTypes, int iNode )
+{
+    const Key key = MakeKey( vecOrigin, afNodeTypes );
+
+    if( auto it = m_Lookup.find( key ); it != m_Lookup.end() )
+    {
+        it->second->Node = iNode;
+        m_Entries.splice( m_Entries.begin(), m_Entries, it->second );
+        return;
+    }
+
+    if( m_Entries.size() >= NODE_CACHE_SIZE )
+    {
+        // Reuse the least recently used entry.
+        m_Lookup.erase( m_Entries.back().EntryKey );
+        m_Entries.splice( m_Entries.begin(), m_Entries, std::prev( m_Entries.end() ) );
+        m_Entries.front() = {key, iNode};
+    }
+    else
+    {
+        m_Entries.push_front( {key, iNode} );
+    }
+
+    m_Lookup.emplace( key, m_Entries.begin() );
+}
+
+void CNearestNodeCache::Clear()
+{
+    m_Entries.clear();
+    m_Lookup.clear();
 }
 
 //=========================================================
@@ -850,240 +1095,48 @@ int CGraph::FindNearestNode( const Vector& vecOrigin, int afNodeTypes )
         return -1;
     }
 
+    ++g_NearestNodeStats.Lookups;
+
     // Check with the cache
     //
-    unsigned int iHash = ( CACHE_SIZE - 1 ) & Hash( &vecOrigin, sizeof( vecOrigin ) );
-    if( m_Cache[iHash].v == vecOrigin )
-    {
-        // Logger->trace("Cache Hit.");
-        return m_Cache[iHash].n;
-    }
-    else
+    if( int iNearest; g_NearestNodeCache.Find( vecOrigin, afNodeTypes, iNearest ) )
     {
-        // Logger->trace("Cache Miss.");
+        ++g_NearestNodeStats.CacheHits;
+        return iNearest;
     }
 
-    // Mark all points as unchecked.
-    //
-    m_CheckedCounter++;
-    if( m_CheckedCounter == 0 )
-    {
-        for( int i = 0; i < m_cNodes; i++ )
+    // The first node we can see is the nearest one since they are visited closest first.
+    const int iNearest = g_NodeGrid.FindNearest( m_pNodes, vecOrigin, afNodeTypes, [&]( int iNode, float )
         {
-            m_di[i].m_CheckedEvent = 0;
-        }
-        m_CheckedCounter++;
-    }
+            TraceResult tr;
 
-    m_iNearest = -1;
-    m_flShortest = 999999.0; // just a big number.
+            // make sure that vecOrigin can trace to this node!
+            UTIL_TraceLine( vecOrigin, m_pNodes[iNode].m_vecOriginPeek, ignore_monsters, nullptr, &tr );
+            ++g_NearestNodeStats.Traces;
 
-    // If we can find a visible point, then let CalcBounds set the limits, but if
-    // we have no visible point at all to start with, then don't restrict the limits.
-    //
-#if 1
-    m_minX = 0;
-    m_maxX = 255;
-    m_minY = 0;
-    m_maxY = 255;
-    m_minZ = 0;
-    m_maxZ = 255;
-    m_minBoxX = 0;
-    m_maxBoxX = 255;
-    m_minBoxY = 0;
-    m_maxBoxY = 255;
-    m_minBoxZ = 0;
-    m_maxBoxZ = 255;
-#else
-    m_minBoxX = CALC_RANGE( vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0] );
-    m_maxBoxX = CALC_RANGE( vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0] );
-    m_minBoxY = CALC_RANGE( vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1] );
-    m_maxBoxY = CALC_RANGE( vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1] );
-    m_minBoxZ = CALC_RANGE( vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2] );
-    m_maxBoxZ = CALC_RANGE( vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2] )
-        CalcBounds( m_minX, m_maxX, CALC_RANGE( vecOrigin.x, m_RegionMin[0], m_RegionMax[0] ), m_pNodes[m_iNearest].m_Region[0] );
-    CalcBounds( m_minY, m_maxY, CALC_RANGE( vecOrigin.y, m_RegionMin[1], m_RegionMax[1] ), m_pNodes[m_iNearest].m_Region[1] );
-    CalcBounds( m_minZ, m_maxZ, CALC_RANGE( vecOrigin.z, m_RegionMin[2], m_RegionMax[2] ), m_pNodes[m_iNearest].m_Region[2] );
-#endif
+            return tr.flFraction == 1.0;
+        } );
 
-    int halfX = ( m_minX + m_maxX ) / 2;
-    int halfY = ( m_minY + m_maxY ) / 2;
-    int halfZ = ( m_minZ + m_maxZ ) / 2;
+    g_NearestNodeCache.Insert( vecOrigin, afNodeTypes, iNearest );
+    return iNearest;
+}
 
-    int j;
+void CGraph::BuildNodeGrid()
+{
+    g_NodeGrid.Build( m_pNodes, m_cNodes );
+    g_NearestNodeCache.Clear();
+}
 
-    for( int i = halfX; i >= m_minX; i-- )
+void CGraph::LogFrameStats()
+{
+    if( sv_nodegraph_stats.value != 0 && g_NearestNodeStats.Lookups > 0 )
     {
-        for( j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-            if( rgY > m_maxBoxY )
-                break;
-            if( rgY < m_minBoxY )
-                continue;
-
-            int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-            if( rgZ < m_minBoxZ )
-                continue;
-            if( rgZ > m_maxBoxZ )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[0] );
-        }
+        Logger->info( "FindNearestNode: {} lookups, {} cache hits, {} traces",
+            g_NearestNodeStats.Lookups, g_NearestNodeStats.CacheHits, g_NearestNodeStats.Traces );
     }
 
-    for( int i = std::max( m_minY, halfY + 1 ); i <= m_maxY; i++ )
-    {
-        for( j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-            if( rgZ > m_maxBoxZ )
-                break;
-            if( rgZ < m_minBoxZ )
-                continue;
-            int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-            if( rgX < m_minBoxX )
-                continue;
-            if( rgX > m_maxBoxX )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[1] );
-        }
-    }
-
-    for( int i = std::min( m_maxZ, halfZ ); i >= m_minZ; i-- )
-    {
-        for( j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-            if( rgX > m_maxBoxX )
-                break;
-            if( rgX < m_minBoxX )
-                continue;
-            int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-            if( rgY < m_minBoxY )
-                continue;
-            if( rgY > m_maxBoxY )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[2] );
-        }
-    }
-
-    for( int i = std::max( m_minX, halfX + 1 ); i <= m_maxX; i++ )
-    {
-        for( j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-            if( rgY > m_maxBoxY )
-                break;
-            if( rgY < m_minBoxY )
-                continue;
-
-            int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-            if( rgZ < m_minBoxZ )
-                continue;
-            if( rgZ > m_maxBoxZ )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[0] );
-        }
-    }
-
-    for( int i = std::min( m_maxY, halfY ); i >= m_minY; i-- )
-    {
-        for( j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-            if( rgZ > m_maxBoxZ )
-                break;
-            if( rgZ < m_minBoxZ )
-                continue;
-            int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-            if( rgX < m_minBoxX )
-                continue;
-            if( rgX > m_maxBoxX )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[1] );
-        }
-    }
-
-    for( int i = std::max( m_minZ, halfZ + 1 ); i <= m_maxZ; i++ )
-    {
-        for( j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++ )
-        {
-            if( ( m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes ) == 0 )
-                continue;
-
-            int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-            if( rgX > m_maxBoxX )
-                break;
-            if( rgX < m_minBoxX )
-                continue;
-            int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-            if( rgY < m_minBoxY )
-                continue;
-            if( rgY > m_maxBoxY )
-                continue;
-            CheckNode( vecOrigin, m_di[j].m_SortedBy[2] );
-        }
-    }
-
-#if 0
-    // Verify our answers.
-    //
-    int iNearestCheck = -1;
-    m_flShortest = 8192;// find nodes within this radius
-
-    for( int i = 0; i < m_cNodes; i++ )
-    {
-        float flDist = ( vecOrigin - m_pNodes[i].m_vecOriginPeek ).Length();
-
-        if( flDist < m_flShortest )
-        {
-            // make sure that vecOrigin can trace to this node!
-            UTIL_TraceLine( vecOrigin, m_pNodes[i].m_vecOriginPeek, ignore_monsters, 0, &tr );
-
-            if( tr.flFraction == 1.0 )
-            {
-                iNearestCheck = i;
-                m_flShortest = flDist;
-            }
-        }
-    }
-
-    if( iNearestCheck != m_iNearest )
-    {
-        Logger->trace( "NOT closest {}({},{},{}) {}({},{},{}).",
-            iNearestCheck,
-            m_pNodes[iNearestCheck].m_vecOriginPeek.x,
-            m_pNodes[iNearestCheck].m_vecOriginPeek.y,
-            m_pNodes[iNearestCheck].m_vecOriginPeek.z,
-            m_iNearest,
-            ( m_iNearest == -1 ? 0.0 : m_pNodes[m_iNearest].m_vecOriginPeek.x ),
-            ( m_iNearest == -1 ? 0.0 : m_pNodes[m_iNearest].m_vecOriginPeek.y ),
-            ( m_iNearest == -1 ? 0.0 : m_pNodes[m_iNearest].m_vecOriginPeek.z ) );
-    }
-    if( m_iNearest == -1 )
-    {
-        Logger->trace( "All that work for nothing." );
-    }
-#endif
-    m_Cache[iHash].v = vecOrigin;
-    m_Cache[iHash].n = m_iNearest;
-    return m_iNearest;
-}
+    g_NearestNodeStats = {};
+}
 
 //=========================================================
 // CGraph - ShowNodeConnections - draws a line from the given node
@@ -1145,15 +1198,19 @@ void CGraph::ShowNodeConnections( int iNode )
 // to write progress to. Returns the total number of initial
 // links.
 //
+// This is done in stages: first the node pairs that could
+// possibly be connected are collected, then each pair is
+// traced once for both directions (the trace from one node
+// is the trace back from the other), then the links are
+// written to the pool in the order the nodes appear in.
+//
 // If there's a problem with this process, the index
 // of the offending node will be written to piBadNode
 //=========================================================
 int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
 {
     int i, j, z;
-    edict_t* pTraceEnt;
     int cTotalLinks, cLinksThisNode, cMaxInitialLinks;
-    TraceResult tr;
 
     // !!!BUGBUG - this function returns 0 if there is a problem in the middle of connecting the graph
     // it also returns 0 if none of the nodes in a level can see each other. piBadNode is ALWAYS read
@@ -1181,6 +1238,149 @@ int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
         file.Printf( "----------------------------------------------------------------------------\n" );
     }
 
+    using Clock = std::chrono::high_resolution_clock;
+
+    const auto toMilliseconds = []( Clock::duration duration )
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>( duration ).count();
+    };
+
+    const auto startTime = Clock::now();
+
+    // Stage 1: collect the pairs of nodes that could be connected.
+    // Each pair is stored once, with the lower numbered node first.
+    //
+    std::vector<std::pair<int, int>> candidatePairs;
+    int cCulledPairs = 0;
+
+    // Traces from a node inside the world's solid always start solid, so such a node never links to anything.
+    std::vector<bool> nodeInSolid( m_cNodes );
+    int cNodesInSolid = 0;
+
+    for( i = 0; i < m_cNodes; i++ )
+    {
+        nodeInSolid[i] = UTIL_PointContents( m_pNodes[i].m_vecOrigin ) == CONTENTS_SOLID;
+
+        if( nodeInSolid[i] )
+        {
+            ++cNodesInSolid;
+        }
+    }
+
+    for( i = 0; i < m_cNodes; i++ )
+    {
+        for( j = i + 1; j < m_cNodes; j++ )
+        {
+            if( ( m_pNodes[i].m_afNodeInfo & bits_NODE_GROUP_REALM ) != ( m_pNodes[j].m_afNodeInfo & bits_NODE_GROUP_REALM ) )
+            {
+                // don't connect air nodes to water nodes to land nodes. It just wouldn't be prudent at this juncture.
+                ++cCulledPairs;
+                continue;
+            }
+
+            if( nodeInSolid[i] && nodeInSolid[j] )
+            {
+                // both traces would start solid.
+                ++cCulledPairs;
+                continue;
+            }
+
+            candidatePairs.emplace_back( i, j );
+        }
+    }
+
+    const auto collectTime = Clock::now();
+
+    // Stage 2: trace the candidate pairs.
+    //
+    struct VisibleNode
+    {
+        int Node;
+        edict_t* pLinkEnt; // the brush entity that's the only thing in the way, if any.
+    };
+
+    std::vector<std::vector<VisibleNode>> visibleNodes( m_cNodes );
+    int cTraces = 0;
+
+    const auto traceLine = [&]( int iFrom, int iTo )
+    {
+        TraceResult tr;
+        tr.pHit = nullptr; // clear every time so we don't get stuck with last trace's hit ent
+
+        UTIL_TraceLine( m_pNodes[iFrom].m_vecOrigin,
+            m_pNodes[iTo].m_vecOrigin,
+            ignore_monsters,
+            g_pBodyQueueHead->edict(), //!!!HACKHACK no real ent to supply here, using a global we don't care about
+            &tr );
+
+        ++cTraces;
+        return tr;
+    };
+
+    // Given the trace from a node and the trace back to it, determine whether it can see the other node.
+    const auto checkVisible = []( const TraceResult& trForward, const TraceResult& trBack, edict_t*& pLinkEnt )
+    {
+        pLinkEnt = nullptr;
+
+        if( 0 != trForward.fStartSolid )
+            return false;
+
+        if( trForward.flFraction != 1.0 )
+        { // trace hit a brush ent, the trace backwards must hit it too to make sure that this ent is the only thing in the way.
+            if( trBack.pHit != trForward.pHit || CBaseEntity::Instance( trForward.pHit )->ClassnameIs( "worldspawn" ) )
+            { // even if the ent wasn't there, these nodes couldn't be connected. Skip.
+                return false;
+            }
+
+            pLinkEnt = trForward.pHit;
+        }
+
+        return true;
+    };
+
+    const std::size_t progressInterval = std::max<std::size_t>( candidatePairs.size() / 10, 1 );
+
+    for( std::size_t pair = 0; pair < candidatePairs.size(); pair++ )
+    {
+        const auto [iLow, iHigh] = candidatePairs[pair];
+
+        // Trace from the node that isn't in solid first, if only one of them is.
+        const int iFrom = nodeInSolid[iLow] ? iHigh : iLow;
+        const int iTo = nodeInSolid[iLow] ? iLow : iHigh;
+
+        // Each trace is used both to link its start node and to check the entity hit by the trace in the other direction.
+        const TraceResult trForward = traceLine( iFrom, iTo );
+
+        // If the world is in the way and the trace back would start solid, neither node can link to the other.
+        const bool blockedBySolid = nodeInSolid[iTo] && trForward.flFraction != 1.0 && CBaseEntity::Instance( trForward.pHit )->ClassnameIs( "worldspawn" );
+
+        if( !blockedBySolid )
+        {
+            const TraceResult trBack = traceLine( iTo, iFrom );
+
+            edict_t* pLinkEnt;
+
+            if( checkVisible( trForward, trBack, pLinkEnt ) )
+            {
+                visibleNodes[iFrom].push_back( {iTo, pLinkEnt} );
+            }
+
+            if( checkVisible( trBack, trForward, pLinkEnt ) )
+            {
+                visibleNodes[iTo].push_back( {iFrom, pLinkEnt} );
+            }
+        }
+
+        if( ( pair + 1 ) % progressInterval == 0 )
+        {
+            Logger->debug( "LinkVisibleNodes: traced {} of {} node pairs", pair + 1, candidatePairs.size() );
+        }
+    }
+
+    const auto traceTime = Clock::now();
+
+    // Stage 3: write the links to the pool.
+    //
     cTotalLinks = 0; // start with no connections
 
     // to keep track of the maximum number of initial links any node had so far.
@@ -1206,78 +1406,29 @@ int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
 
         m_pNodes[i].m_iFirstLink = cTotalLinks;
 
-        // now build a list of every other node that this node can see
-        for( j = 0; j < m_cNodes; j++ )
+        // Pairs were traced in order so these are already sorted by node number.
+        for( const auto& visible : visibleNodes[i] )
         {
-            if( j == i )
-            { // don't connect to self!
-                continue;
-            }
+            j = visible.Node;
 
-#if 0
-
-            if( ( m_pNodes[i].m_afNodeInfo & bits_NODE_WATER ) != ( m_pNodes[j].m_afNodeInfo & bits_NODE_WATER ) )
+            // there is a solid_bsp ent in the way of these two nodes, so we must record several things about in order to keep
+            // track of it in the pathfinding code, as well as through save and restore of the node graph. ANY data that is manipulated
+            // as part of the process of adding a LINKENT to a connection here must also be done in CGraph::SetGraphPointers, where reloaded
+            // graphs are prepared for use.
+            if( visible.pLinkEnt )
             {
-                // don't connect water nodes to air nodes or land nodes. It just wouldn't be prudent at this juncture.
-                continue;
-            }
-#else
-            if( ( m_pNodes[i].m_afNodeInfo & bits_NODE_GROUP_REALM ) != ( m_pNodes[j].m_afNodeInfo & bits_NODE_GROUP_REALM ) )
-            {
-                // don't connect air nodes to water nodes to land nodes. It just wouldn't be prudent at this juncture.
-                continue;
-            }
-#endif
-
-            tr.pHit = nullptr; // clear every time so we don't get stuck with last trace's hit ent
-            pTraceEnt = nullptr;
-
-            UTIL_TraceLine( m_pNodes[i].m_vecOrigin,
-                m_pNodes[j].m_vecOrigin,
-                ignore_monsters,
-                g_pBodyQueueHead->edict(), //!!!HACKHACK no real ent to supply here, using a global we don't care about
-                &tr );
+                // get a pointer
+                pLinkPool[cTotalLinks].m_pLinkEnt = VARS( visible.pLinkEnt );
 
+                // record the modelname, so that we can save/load node trees
+                memcpy( pLinkPool[cTotalLinks].m_szLinkEntModelname, STRING( VARS( visible.pLinkEnt )->model ), 4 );
 
-            if( 0 != tr.fStartSolid )
-                continue;
-
-            if( tr.flFraction != 1.0 )
-            { // trace hit a brush ent, trace backwards to make sure that this ent is the only thing in the way.
-
-                pTraceEnt = tr.pHit; // store the ent that the trace hit, for comparison
-
-                UTIL_TraceLine( m_pNodes[j].m_vecOrigin,
-                    m_pNodes[i].m_vecOrigin,
-                    ignore_monsters,
-                    g_pBodyQueueHead->edict(), //!!!HACKHACK no real ent to supply here, using a global we don't care about
-                    &tr );
-
-                auto hitEnt = CBaseEntity::Instance( pTraceEnt );
-
-                // there is a solid_bsp ent in the way of these two nodes, so we must record several things about in order to keep
-                // track of it in the pathfinding code, as well as through save and restore of the node graph. ANY data that is manipulated
-                // as part of the process of adding a LINKENT to a connection here must also be done in CGraph::SetGraphPointers, where reloaded
-                // graphs are prepared for use.
-                if( tr.pHit == pTraceEnt && !hitEnt->ClassnameIs( "worldspawn" ) )
+                // set the flag for this ent that indicates that it is attached to the world graph
+                // if this ent is removed from the world, it must also be removed from the connections
+                // that it formerly blocked.
+                if( !FBitSet( VARS( visible.pLinkEnt )->flags, FL_GRAPHED ) )
                 {
-                    // get a pointer
-                    pLinkPool[cTotalLinks].m_pLinkEnt = VARS( tr.pHit );
-
-                    // record the modelname, so that we can save/load node trees
-                    memcpy( pLinkPool[cTotalLinks].m_szLinkEntModelname, STRING( VARS( tr.pHit )->model ), 4 );
-
-                    // set the flag for this ent that indicates that it is attached to the world graph
-                    // if this ent is removed from the world, it must also be removed from the connections
-                    // that it formerly blocked.
-                    if( !FBitSet( VARS( tr.pHit )->flags, FL_GRAPHED ) )
-                    {
-                        VARS( tr.pHit )->flags += FL_GRAPHED;
-                    }
-                }
-                else
-                { // even if the ent wasn't there, these nodes couldn't be connected. Skip.
-                    continue;
+                    VARS( visible.pLinkEnt )->flags += FL_GRAPHED;
                 }
             }
 
@@ -1287,7 +1438,7 @@ int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
 
                 if( !FNullEnt( pLinkPool[cTotalLinks].m_pLinkEnt ) )
                 { // record info about the ent in the way, if any.
-                    file.Printf( "  Entity on connection: %s, name: %s  Model: %s", STRING( VARS( pTraceEnt )->classname ), STRING( VARS( pTraceEnt )->targetname ), STRING( VARS( tr.pHit )->model ) );
+                    file.Printf( "  Entity on connection: %s, name: %s  Model: %s", STRING( VARS( visible.pLinkEnt )->classname ), STRING( VARS( visible.pLinkEnt )->targetname ), STRING( VARS( visible.pLinkEnt )->model ) );
                 }
 
                 file.Printf( "\n" );
@@ -1313,11 +1464,6 @@ int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
                 return 0;
             }
 
-            if( cLinksThisNode == 0 )
-            {
-                file.Printf( "**NO INITIAL LINKS**\n" );
-            }
-
             // record the connection info in the link pool
             m_pNodes[i].m_cNumLinks = cLinksThisNode;
 
@@ -1339,6 +1485,12 @@ int CGraph::LinkVisibleNodes( CLink* pLinkPool, FSFile& file, int* piBadNode )
     file.Printf( "\n%4d Total Initial Connections - %4d Maximum connections for a single node.\n", cTotalLinks, cMaxInitialLinks );
     file.Printf( "----------------------------------------------------------------------------\n\n\n" );
 
+    const auto endTime = Clock::now();
+
+    Logger->info( "LinkVisibleNodes: {} node pairs, {} culled ({} nodes in solid), {} traces, {} links in {} ms (collect: {} ms, trace: {} ms, link: {} ms)",
+        m_cNodes * ( m_cNodes - 1 ) / 2, cCulledPairs, cNodesInSolid, cTraces, cTotalLinks, toMilliseconds( endTime - startTime ),
+        toMilliseconds( collectTime - startTime ), toMilliseconds( traceTime - collectTime ), toMilliseconds( endTime - traceTime ) );
+
     return cTotalLinks;
 }
 
@@ -1755,6 +1907,9 @@ void CTestHull::BuildNodeGraph()
     file.Printf( "----------------------------------------------------------------------------\n" );
     file.Printf( "Walk Rejection:\n" );
 
+    const auto walkStartTime = std::chrono::high_resolution_clock::now();
+    int cWalkMoves = 0;
+
     for( i = 0; i < WorldGraph.m_cNodes; i++ )
     {
         pSrcNode = &WorldGraph.m_pNodes[i];
@@ -1844,6 +1999,8 @@ void CTestHull::BuildNodeGraph()
                         if( ( step + stepSize ) >= ( flDist - 1 ) )
                             stepSize = ( flDist - step ) - 1;
 
+                        ++cWalkMoves;
+
                         if( !WALK_MOVE( edict(), flYaw, stepSize, MoveMode ) )
                         { // can't take the next step
 
@@ -1911,6 +2068,9 @@ void CTestHull::BuildNodeGraph()
     }
     file.Printf( "-------------------------------------------------------------------------------\n\n\n" );
 
+    CGraph::Logger->info( "Walk rejection: {} walk moves in {} ms", cWalkMoves,
+        std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now() - walkStartTime ).count() );
+
     cPoolLinks -= WorldGraph.RejectInlineLinks( pTempPool, file );
 
     // now malloc a pool just large enough to hold the links that are actually used
@@ -2188,26 +2348,14 @@ int CQueue::Remove( float& fPriority )
 //=========================================================
 // CQueue constructor
 //=========================================================
-CQueuePriority::CQueuePriority()
-{
-    m_cSize = 0;
-}
+CQueuePriority::CQueuePriority() = default;
 
 //=========================================================
 // inserts a value into the priority queue
 //=========================================================
 void CQueuePriority::Insert( int iValue, float fPriority )
 {
-
-    if( Full() )
-    {
-        printf( "Queue is full!\n" );
-        return;
-    }
-
-    m_heap[m_cSize].Priority = fPriority;
-    m_heap[m_cSize].Id = iValue;
-    m_cSize++;
+    m_heap.push_back( {iValue, fPriority} );
     Heap_SiftUp();
 }
 
@@ -2220,11 +2368,14 @@ int CQueuePriority::Remove( float& fPriority )
     int iReturn = m_heap[0].Id;
     fPriority = m_heap[0].Priority;
 
-    m_cSize--;
+    m_heap[0] = m_heap.back();
+    m_heap.pop_back();
 
-    m_heap[0] = m_heap[m_cSize];
+    if( !m_heap.empty() )
+    {
+        Heap_SiftDown( 0 );
+    }
 
-    Heap_SiftDown( 0 );
     return iReturn;
 }
 
@@ -2234,15 +2385,16 @@ int CQueuePriority::Remove( float& fPriority )
 
 void CQueuePriority::Heap_SiftDown( int iSubRoot )
 {
+    const int cSize = Size();
     int parent = iSubRoot;
     int child = HEAP_LEFT_CHILD( parent );
 
     tag_HEAP_NODE Ref = m_heap[parent];
 
-    while( child < m_cSize )
+    while( child < cSize )
     {
         int rightchild = HEAP_RIGHT_CHILD( parent );
-        if( rightchild < m_cSize )
+        if( rightchild < cSize )
         {
             if( m_heap[rightchild].Priority < m_heap[child].Priority )
             {
@@ -2261,22 +2413,56 @@ void CQueuePriority::Heap_SiftDown( int iSubRoot )
 
 void CQueuePriority::Heap_SiftUp()
 {
-    int child = m_cSize - 1;
+    int child = Size() - 1;
     while( 0 != child )
     {
         int parent = HEAP_PARENT( child );
         if( m_heap[parent].Priority <= m_heap[child].Priority )
             break;
 
-        tag_HEAP_NODE Tmp;
-        Tmp = m_heap[child];
-        m_heap[child] = m_heap[parent];
-        m_heap[parent] = Tmp;
+        std::swap( m_heap[child], m_heap[parent] );
 
         child = parent;
     }
 }
 
+void CPathSearch::Begin( int cNodes )
+{
+    if( static_cast<int>( m_States.size() ) != cNodes )
+    {
+        m_States.assign( cNodes, NodeState{} );
+        m_Generation = 0;
+    }
+
+    ++m_Generation;
+
+    // Stamps from before the counter wrapped around would look current again.
+    if( m_Generation == 0 )
+    {
+        for( auto& state : m_States )
+        {
+            state.Generation = 0;
+        }
+
+        m_Generation = 1;
+    }
+
+    Queue.Clear();
+}
+
+CPathSearch::NodeState& CPathSearch::Visit( int iNode )
+{
+    auto& state = m_States[iNode];
+
+    if( state.Generation != m_Generation )
+    {
+        state.Generation = m_Generation;
+        state.Closed = false;
+    }
+
+    return state;
+}
+
 //=========================================================
 // CGraph - FLoadGraph - attempts to load a node graph from disk.
 // if the current level is maps/snar.bsp, maps/graphs/snar.nod
@@ -2290,6 +2476,9 @@ bool CGraph::FLoadGraph( const char* szMapName )
 
     const std::string fileName{std::string{"maps/graphs/"} + szMapName + ".nod"};
 
+    // Cached results refer to nodes of the previous graph.
+    g_NearestNodeCache.Clear();
+
     // Note: Allow loading graphs only from the mod directory itself.
     // Do not allow loading from other games since they may have a different graph format.
     const auto buffer = FileSystem_LoadFileIntoBuffer( fileName.c_str(), FileContentFormat::Binary, "GAMECONFIG" );
@@ -2444,6 +2633,10 @@ bool CGraph::FLoadGraph( const char* szMapName )
         Logger->warn( "Node graph was longer than expected by {} bytes!", length );
     }
 
+    // The grid isn't saved, it's cheap enough to build on load.
+    //
+    BuildNodeGrid();
+
     return true;
 }
 
@@ -2548,6 +2741,9 @@ bool CGraph::FSetGraphPointers()
         }
     }
 
+    // The world has been (re)spawned, so cached traces to nodes may no longer be valid.
+    g_NearestNodeCache.Clear();
+
     // the pointers are now set.
     m_fGraphPointersSet = 1;
     return true;
@@ -2980,306 +3176,420 @@ void CGraph::BuildRegionTables()
     // Initialize the cache.
     //
     memset( m_Cache, 0, sizeof( m_Cache ) );
+
+    BuildNodeGrid();
 }
 
-void CGraph::ComputeStaticRoutingTables()
+namespace
 {
-    int nRoutes = m_cNodes * m_cNodes;
-#define FROM_TO(x, y) ((x)*m_cNodes + (y))
-    short* Routes = new short[nRoutes];
+/**
+ *    @brief Output of one (hull, capability) routing table computation.
+ *    Worker threads fill these in, the main thread merges them into @c CGraph::m_pRouteInfo in a fixed order
+ *    so the result does not depend on the number of threads used.
+ */
+struct RoutingTableJob
+{
+    int Hull = 0;
+    int Cap = 0;
 
-    int* pMyPath = new int[m_cNodes];
-    unsigned short* BestNextNodes = new unsigned short[m_cNodes];
-    char* pRoute = new char[m_cNodes * 2];
+    std::vector<std::vector<char>> CompressedRoutes; // One compressed routing table per source node.
+    std::vector<int> CompressedSizes;
+    std::vector<std::pair<int, int>> UnsortedNodes; // Nodes that could not be encoded. Logged by the main thread.
 
+    std::chrono::high_resolution_clock::duration Time{};
+};
+}
 
-    if( Routes && pMyPath && BestNextNodes && pRoute )
+static int CapMaskForIndex( int iCap )
+{
+    switch ( iCap )
     {
-        int nTotalCompressedSize = 0;
-        for( int iHull = 0; iHull < MAX_NODE_HULLS; iHull++ )
-        {
-            for( int iCap = 0; iCap < 2; iCap++ )
-            {
-                int iCapMask;
-                switch ( iCap )
-                {
-                default:
-                    iCapMask = 0;
-                    break;
+    default:
+        return 0;
 
-                case 1:
-                    iCapMask = bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE;
-                    break;
-                }
+    case 1:
+        return bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE;
+    }
+}
 
+//=========================================================
+// Encodes the relative offset of iLastNode from iFrom for
+// a repeat phrase. Returns false if it doesn't fit in a char.
+//=========================================================
+static bool EncodeRouteOffset( char*& p, int iLastNode, int iFrom, int cNodes )
+{
+    int a = iLastNode - iFrom;
+    int b = iLastNode - iFrom + cNodes;
+    int c = iLastNode - iFrom - cNodes;
+    if( -128 <= a && a <= 127 )
+    {
+        *p++ = a;
+    }
+    else if( -128 <= b && b <= 127 )
+    {
+        *p++ = b;
+    }
+    else if( -128 <= c && c <= 127 )
+    {
+        *p++ = c;
+    }
+    else
+    {
+        return false;
+    }
 
-                // Initialize Routing table to uncalculated.
-                //
-                int iFrom;
-                for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
+    return true;
+}
+
+//=========================================================
+// Computes and compresses the routing table of every node
+// for a single hull and capability. Runs on a worker thread.
+//=========================================================
+static void ComputeRoutingTable( const CGraph& graph, RoutingTableJob& job, const std::vector<bool>& usableLinks )
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const int cNodes = graph.m_cNodes;
+    const int iHullMask = HullLinkMask( job.Hull );
+
+#define FROM_TO(x, y) ((x)*cNodes + (y))
+    // Initialize Routing table to uncalculated.
+    //
+    std::vector<short> Routes( cNodes * cNodes, -1 );
+
+    // A path between a node and itself is always 2 entries long.
+    std::vector<int> pMyPath( std::max( cNodes, 2 ) );
+    CPathSearch search;
+    std::vector<unsigned short> BestNextNodes( cNodes );
+    std::vector<char> pRoute( cNodes * 2 );
+
+    job.CompressedRoutes.resize( cNodes );
+    job.CompressedSizes.resize( cNodes );
+
+    for( int iFrom = 0; iFrom < cNodes; iFrom++ )
+    {
+        for( int iTo = cNodes - 1; iTo >= 0; iTo-- )
+        {
+            if( Routes[FROM_TO( iFrom, iTo )] != -1 )
+                continue;
+
+            int cPathSize = DijkstraShortestPath( graph, search, pMyPath.data(), iFrom, iTo, iHullMask,
+                [&]( int, const CLink& link )
                 {
-                    for( int iTo = 0; iTo < m_cNodes; iTo++ )
+                    return usableLinks[&link - graph.m_pLinkPool];
+                } );
+
+            // Use the computed path to update the routing table.
+            //
+            if( cPathSize > 1 )
+            {
+                for( int iNode = 0; iNode < cPathSize - 1; iNode++ )
+                {
+                    int iStart = pMyPath[iNode];
+                    int iNext = pMyPath[iNode + 1];
+                    for( int iNode1 = iNode + 1; iNode1 < cPathSize; iNode1++ )
                     {
-                        Routes[FROM_TO( iFrom, iTo )] = -1;
+                        int iEnd = pMyPath[iNode1];
+                        Routes[FROM_TO( iStart, iEnd )] = iNext;
                     }
                 }
+            }
+            else
+            {
+                Routes[FROM_TO( iFrom, iTo )] = iFrom;
+                Routes[FROM_TO( iTo, iFrom )] = iTo;
+            }
+        }
+    }
 
-                for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
-                {
-                    for( int iTo = m_cNodes - 1; iTo >= 0; iTo-- )
-                    {
-                        if( Routes[FROM_TO( iFrom, iTo )] != -1 )
-                            continue;
+    for( int iFrom = 0; iFrom < cNodes; iFrom++ )
+    {
+        for( int iTo = 0; iTo < cNodes; iTo++ )
+        {
+            BestNextNodes[iTo] = Routes[FROM_TO( iFrom, iTo )];
+        }
 
-                        int cPathSize = FindShortestPath( pMyPath, iFrom, iTo, iHull, iCapMask );
+        // Compress this node's routing table.
+        //
+        int iLastNode = 9999999; // just really big.
+        int cSequence = 0;
+        int cRepeats = 0;
+        int CompressedSize = 0;
+        char* p = pRoute.data();
+        for( int i = 0; i < cNodes; i++ )
+        {
+            bool CanRepeat = ( ( BestNextNodes[i] == iLastNode ) && cRepeats < 127 );
+            bool CanSequence = ( BestNextNodes[i] == i && cSequence < 128 );
 
-                        // Use the computed path to update the routing table.
-                        //
-                        if( cPathSize > 1 )
-                        {
-                            for( int iNode = 0; iNode < cPathSize - 1; iNode++ )
-                            {
-                                int iStart = pMyPath[iNode];
-                                int iNext = pMyPath[iNode + 1];
-                                for( int iNode1 = iNode + 1; iNode1 < cPathSize; iNode1++ )
-                                {
-                                    int iEnd = pMyPath[iNode1];
-                                    Routes[FROM_TO( iStart, iEnd )] = iNext;
-                                }
-                            }
-#if 0
-                            // Well, at first glance, this should work, but actually it's safer
-                            // to be told explictly that you can take a series of node in a
-                            // particular direction. Some links don't appear to have links in
-                            // the opposite direction.
-                            //
-                            for( iNode = cPathSize - 1; iNode >= 1; iNode-- )
-                            {
-                                int iStart = pMyPath[iNode];
-                                int iNext = pMyPath[iNode - 1];
-                                for( int iNode1 = iNode - 1; iNode1 >= 0; iNode1-- )
-                                {
-                                    int iEnd = pMyPath[iNode1];
-                                    Routes[FROM_TO( iStart, iEnd )] = iNext;
-                                }
-                            }
-#endif
-                        }
-                        else
-                        {
-                            Routes[FROM_TO( iFrom, iTo )] = iFrom;
-                            Routes[FROM_TO( iTo, iFrom )] = iTo;
-                        }
-                    }
+            if( 0 != cRepeats )
+            {
+                if( CanRepeat )
+                {
+                    cRepeats++;
                 }
-
-                for( iFrom = 0; iFrom < m_cNodes; iFrom++ )
+                else
                 {
-                    for( int iTo = 0; iTo < m_cNodes; iTo++ )
-                    {
-                        BestNextNodes[iTo] = Routes[FROM_TO( iFrom, iTo )];
-                    }
-
-                    // Compress this node's routing table.
+                    // Emit the repeat phrase.
                     //
-                    int iLastNode = 9999999; // just really big.
-                    int cSequence = 0;
-                    int cRepeats = 0;
-                    int CompressedSize = 0;
-                    char* p = pRoute;
-                    for( int i = 0; i < m_cNodes; i++ )
+                    CompressedSize += 2; // (count-1, iLastNode-i)
+                    *p++ = cRepeats - 1;
+                    if( !EncodeRouteOffset( p, iLastNode, iFrom, cNodes ) )
                     {
-                        bool CanRepeat = ( ( BestNextNodes[i] == iLastNode ) && cRepeats < 127 );
-                        bool CanSequence = ( BestNextNodes[i] == i && cSequence < 128 );
-
-                        if( 0 != cRepeats )
-                        {
-                            if( CanRepeat )
-                            {
-                                cRepeats++;
-                            }
-                            else
-                            {
-                                // Emit the repeat phrase.
-                                //
-                                CompressedSize += 2; // (count-1, iLastNode-i)
-                                *p++ = cRepeats - 1;
-                                int a = iLastNode - iFrom;
-                                int b = iLastNode - iFrom + m_cNodes;
-                                int c = iLastNode - iFrom - m_cNodes;
-                                if( -128 <= a && a <= 127 )
-                                {
-                                    *p++ = a;
-                                }
-                                else if( -128 <= b && b <= 127 )
-                                {
-                                    *p++ = b;
-                                }
-                                else if( -128 <= c && c <= 127 )
-                                {
-                                    *p++ = c;
-                                }
-                                else
-                                {
-                                    Logger->debug( "Nodes need sorting ({},{})!", iLastNode, iFrom );
-                                }
-                                cRepeats = 0;
-
-                                if( CanSequence )
-                                {
-                                    // Start a sequence.
-                                    //
-                                    cSequence++;
-                                }
-                                else
-                                {
-                                    // Start another repeat.
-                                    //
-                                    cRepeats++;
-                                }
-                            }
-                        }
-                        else if( 0 != cSequence )
-                        {
-                            if( CanSequence )
-                            {
-                                cSequence++;
-                            }
-                            else
-                            {
-                                // It may be advantageous to combine
-                                // a single-entry sequence phrase with the
-                                // next repeat phrase.
-                                //
-                                if( cSequence == 1 && CanRepeat )
-                                {
-                                    // Combine with repeat phrase.
-                                    //
-                                    cRepeats = 2;
-                                    cSequence = 0;
-                                }
-                                else
-                                {
-                                    // Emit the sequence phrase.
-                                    //
-                                    CompressedSize += 1; // (-count)
-                                    *p++ = -cSequence;
-                                    cSequence = 0;
-
-                                    // Start a repeat sequence.
-                                    //
-                                    cRepeats++;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            if( CanSequence )
-                            {
-                                // Start a sequence phrase.
-                                //
-                                cSequence++;
-                            }
-                            else
-                            {
-                                // Start a repeat sequence.
-                                //
-                                cRepeats++;
-                            }
-                        }
-                        iLastNode = BestNextNodes[i];
+                        job.UnsortedNodes.emplace_back( iLastNode, iFrom );
                     }
-                    if( 0 != cRepeats )
+                    cRepeats = 0;
+
+                    if( CanSequence )
                     {
-                        // Emit the repeat phrase.
+                        // Start a sequence.
                         //
-                        CompressedSize += 2;
-                        *p++ = cRepeats - 1;
-#if 0
-                        iLastNode = iFrom + *pRoute;
-                        if( iLastNode >= m_cNodes ) iLastNode -= m_cNodes;
-                        else if( iLastNode < 0 ) iLastNode += m_cNodes;
-#endif
-                        int a = iLastNode - iFrom;
-                        int b = iLastNode - iFrom + m_cNodes;
-                        int c = iLastNode - iFrom - m_cNodes;
-                        if( -128 <= a && a <= 127 )
-                        {
-                            *p++ = a;
-                        }
-                        else if( -128 <= b && b <= 127 )
-                        {
-                            *p++ = b;
-                        }
-                        else if( -128 <= c && c <= 127 )
-                        {
-                            *p++ = c;
-                        }
-                        else
-                        {
-                            Logger->debug( "Nodes need sorting ({},{})!", iLastNode, iFrom );
-                        }
+                        cSequence++;
                     }
-                    if( 0 != cSequence )
+                    else
                     {
-                        // Emit the Sequence phrase.
+                        // Start another repeat.
                         //
-                        CompressedSize += 1;
-                        *p++ = -cSequence;
+                        cRepeats++;
                     }
-
-                    // Go find a place to store this thing and point to it.
+                }
+            }
+            else if( 0 != cSequence )
+            {
+                if( CanSequence )
+                {
+                    cSequence++;
+                }
+                else
+                {
+                    // It may be advantageous to combine
+                    // a single-entry sequence phrase with the
+                    // next repeat phrase.
                     //
-                    int nRoute = p - pRoute;
-                    if( m_pRouteInfo )
+                    if( cSequence == 1 && CanRepeat )
                     {
-                        int i;
-                        for( i = 0; i < m_nRouteInfo - nRoute; i++ )
-                        {
-                            if( memcmp( m_pRouteInfo + i, pRoute, nRoute ) == 0 )
-                            {
-                                break;
-                            }
-                        }
-                        if( i < m_nRouteInfo - nRoute )
-                        {
-                            m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = i;
-                        }
-                        else
-                        {
-                            char* Tmp = (char*)calloc( sizeof(char), ( m_nRouteInfo + nRoute ) );
-                            memcpy( Tmp, m_pRouteInfo, m_nRouteInfo );
-                            free( m_pRouteInfo );
-                            m_pRouteInfo = Tmp;
-                            memcpy( m_pRouteInfo + m_nRouteInfo, pRoute, nRoute );
-                            m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = m_nRouteInfo;
-                            m_nRouteInfo += nRoute;
-                            nTotalCompressedSize += CompressedSize;
-                        }
+                        // Combine with repeat phrase.
+                        //
+                        cRepeats = 2;
+                        cSequence = 0;
                     }
                     else
                     {
-                        m_nRouteInfo = nRoute;
-                        m_pRouteInfo = (char*)calloc( sizeof(char), nRoute );
-                        memcpy( m_pRouteInfo, pRoute, nRoute );
-                        m_pNodes[iFrom].m_pNextBestNode[iHull][iCap] = 0;
-                        nTotalCompressedSize += CompressedSize;
+                        // Emit the sequence phrase.
+                        //
+                        CompressedSize += 1; // (-count)
+                        *p++ = -cSequence;
+                        cSequence = 0;
+
+                        // Start a repeat sequence.
+                        //
+                        cRepeats++;
                     }
                 }
             }
+            else
+            {
+                if( CanSequence )
+                {
+                    // Start a sequence phrase.
+                    //
+                    cSequence++;
+                }
+                else
+                {
+                    // Start a repeat sequence.
+                    //
+                    cRepeats++;
+                }
+            }
+            iLastNode = BestNextNodes[i];
+        }
+        if( 0 != cRepeats )
+        {
+            // Emit the repeat phrase.
+            //
+            CompressedSize += 2;
+            *p++ = cRepeats - 1;
+            if( !EncodeRouteOffset( p, iLastNode, iFrom, cNodes ) )
+            {
+                job.UnsortedNodes.emplace_back( iLastNode, iFrom );
+            }
         }
-        Logger->debug( "Size of Routes = {}", nTotalCompressedSize );
+        if( 0 != cSequence )
+        {
+            // Emit the Sequence phrase.
+            //
+            CompressedSize += 1;
+            *p++ = -cSequence;
+        }
+
+        job.CompressedRoutes[iFrom].assign( pRoute.data(), p );
+        job.CompressedSizes[iFrom] = CompressedSize;
     }
+#undef FROM_TO
 
-    delete[] Routes;
-    delete[] BestNextNodes;
-    delete[] pRoute;
-    delete[] pMyPath;
+    job.Time = std::chrono::high_resolution_clock::now() - start;
+}
 
-    Routes = nullptr;
-    BestNextNodes = nullptr;
-    pRoute = nullptr;
-    pMyPath = nullptr;
+//=========================================================
+// CGraph - ComputeStaticRoutingTables - computes the
+// compressed routing tables for every hull and capability.
+// The (hull, cap) tables are independent so they are
+// computed on sv_nodegraph_build_threads worker threads,
+// then merged into m_pRouteInfo in hull, cap, node order so
+// the result is identical to a single threaded build.
+//=========================================================
+void CGraph::ComputeStaticRoutingTables()
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const auto toMilliseconds = []( Clock::duration duration )
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>( duration ).count();
+    };
+
+    const auto startTime = Clock::now();
+
+    // Resolve link entities up front so the path searches don't touch entities and can run on worker threads.
+    std::vector<bool> usableLinks[2];
+
+    for( int iCap = 0; iCap < 2; iCap++ )
+    {
+        const int iCapMask = CapMaskForIndex( iCap );
+
+        usableLinks[iCap].resize( m_cLinks, true );
+
+        for( int iNode = 0; iNode < m_cNodes; iNode++ )
+        {
+            const CNode& node = m_pNodes[iNode];
+
+            for( int i = 0; i < node.m_cNumLinks; i++ )
+            {
+                const int iLink = node.m_iFirstLink + i;
+
+                if( auto pevLinkEnt = m_pLinkPool[iLink].m_pLinkEnt; pevLinkEnt != nullptr )
+                {
+                    usableLinks[iCap][iLink] = HandleLinkEnt( iNode, pevLinkEnt, iCapMask, NODEGRAPH_STATIC );
+                }
+            }
+        }
+    }
+
+    std::vector<RoutingTableJob> jobs;
+
+    for( int iHull = 0; iHull < MAX_NODE_HULLS; iHull++ )
+    {
+        for( int iCap = 0; iCap < 2; iCap++ )
+        {
+            auto& job = jobs.emplace_back();
+            job.Hull = iHull;
+            job.Cap = iCap;
+        }
+    }
+
+    int threadCount = static_cast<int>( sv_nodegraph_build_threads.value );
+
+    if( threadCount <= 0 )
+    {
+        threadCount = static_cast<int>( std::thread::hardware_concurrency() );
+    }
+
+    threadCount = std::clamp( threadCount, 1, static_cast<int>( jobs.size() ) );
+
+    const auto linksTime = Clock::now();
+
+    {
+        std::atomic<std::size_t> nextJob{0};
+
+        const auto worker = [&]()
+        {
+            for( std::size_t i; ( i = nextJob++ ) < jobs.size(); )
+            {
+                ComputeRoutingTable( *this, jobs[i], usableLinks[jobs[i].Cap] );
+            }
+        };
+
+        // The main thread does its share of the work as well.
+        std::vector<std::thread> threads;
+        threads.reserve( threadCount - 1 );
+
+        for( int i = 1; i < threadCount; i++ )
+        {
+            threads.emplace_back( worker );
+        }
+
+        worker();
+
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+    }
+
+    const auto pathsTime = Clock::now();
+
+    int nTotalCompressedSize = 0;
+
+    for( const auto& job : jobs )
+    {
+        Logger->debug( "Hull {} cap {}: routing table computed in {} ms", job.Hull, job.Cap, toMilliseconds( job.Time ) );
+
+        for( const auto& [iLastNode, iFrom] : job.UnsortedNodes )
+        {
+            Logger->debug( "Nodes need sorting ({},{})!", iLastNode, iFrom );
+        }
+
+        for( int iFrom = 0; iFrom < m_cNodes; iFrom++ )
+        {
+            const char* pRoute = job.CompressedRoutes[iFrom].data();
+            const int CompressedSize = job.CompressedSizes[iFrom];
+
+            // Go find a place to store this thing and point to it.
+            //
+            int nRoute = static_cast<int>( job.CompressedRoutes[iFrom].size() );
+            if( m_pRouteInfo )
+            {
+                int i;
+                for( i = 0; i < m_nRouteInfo - nRoute; i++ )
+                {
+                    if( memcmp( m_pRouteInfo + i, pRoute, nRoute ) == 0 )
+                    {
+                        break;
+                    }
+                }
+                if( i < m_nRouteInfo - nRoute )
+                {
+                    m_pNodes[iFrom].m_pNextBestNode[job.Hull][job.Cap] = i;
+                }
+                else
+                {
+                    char* Tmp = (char*)calloc( sizeof(char), ( m_nRouteInfo + nRoute ) );
+                    memcpy( Tmp, m_pRouteInfo, m_nRouteInfo );
+                    free( m_pRouteInfo );
+                    m_pRouteInfo = Tmp;
+                    memcpy( m_pRouteInfo + m_nRouteInfo, pRoute, nRoute );
+                    m_pNodes[iFrom].m_pNextBestNode[job.Hull][job.Cap] = m_nRouteInfo;
+                    m_nRouteInfo += nRoute;
+                    nTotalCompressedSize += CompressedSize;
+                }
+            }
+            else
+            {
+                m_nRouteInfo = nRoute;
+                m_pRouteInfo = (char*)calloc( sizeof(char), nRoute );
+                memcpy( m_pRouteInfo, pRoute, nRoute );
+                m_pNodes[iFrom].m_pNextBestNode[job.Hull][job.Cap] = 0;
+                nTotalCompressedSize += CompressedSize;
+            }
+        }
+    }
+
+    Logger->debug( "Size of Routes = {}", nTotalCompressedSize );
+
+    const auto endTime = Clock::now();
+
+    Logger->info( "Computed routing tables for {} nodes on {} thread(s) in {} ms (link entities: {} ms, paths: {} ms, merge: {} ms)",
+        m_cNodes, threadCount, toMilliseconds( endTime - startTime ),
+        toMilliseconds( linksTime - startTime ), toMilliseconds( pathsTime - linksTime ), toMilliseconds( endTime - pathsTime ) );
 
 #if 0
     TestRoutingTables();
@@ -18,7 +18,10 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <spdlog/logger.h>
 
@@ -55,11 +58,11 @@ public:
     //
     int m_pNextBestNode[MAX_NODE_HULLS][2];
 
-    // Used in finding the shortest path. m_fClosestSoFar is -1 if not visited.
-    // Then it is the distance to the source. If another path uses this node
-    // and has a closer distance, then m_iPreviousNode is also updated.
+    // No longer used in finding the shortest path (see CPathSearch), kept so the
+    // node layout in .nod files doesn't change. SortNodes uses m_iPreviousNode
+    // as scratch space.
     //
-    float m_flClosestSoFar; // Used in finding the shortest path.
+    float m_flClosestSoFar;
     int m_iPreviousNode;
 
     short m_sHintType;       // there is something interesting in the world at this node's position
@@ -140,6 +143,9 @@ public:
     // search each range. After the search is exhausted, we know we have the closest
     // node.
     //
+    // FindNearestNode now uses CNodeGrid instead. These and the old 128 entry cache
+    // are kept so the layout of .nod files doesn't change.
+    //
 #define CACHE_SIZE 128
 #define NUM_RANGES 256
     DIST_INFO* m_di; // This is m_cNodes long, but the entries don't correspond to CNode entries.
@@ -194,12 +200,15 @@ public:
     bool FLoadGraph( const char* szMapName );
     bool FSaveGraph( const char* szMapName );
     bool FSetGraphPointers();
-    void CheckNode( Vector vecOrigin, int iNode );
 
     void BuildRegionTables();
+    void BuildNodeGrid();
     void ComputeStaticRoutingTables();
     void TestRoutingTables();
 
+    // Logs and resets the FindNearestNode statistics for this frame.
+    void LogFrameStats();
+
     void HashInsert( int iSrcNode, int iDestNode, int iKey );
     void HashSearch( int iSrcNode, int iDestNode, int& iKey );
     void HashChoosePrimes( int TableSize );
@@ -330,30 +339,146 @@ private:
 
 //=========================================================
 // CQueuePriority - Priority queue (smallest item out first).
-//
+// Grows as needed, Clear() keeps the memory around so a
+// queue can be reused between searches without allocating.
 //=========================================================
 class CQueuePriority
 {
 public:
     CQueuePriority(); // constructor
-    inline bool Full() { return ( m_cSize == MAX_STACK_NODES ); }
-    inline bool Empty() { return ( m_cSize == 0 ); }
-    // inline int Tail ( float & ) { return ( m_queue[ m_tail ].Id ); }
-    inline int Size() { return ( m_cSize ); }
+    inline bool Empty() { return m_heap.empty(); }
+    inline int Size() { return static_cast<int>( m_heap.size() ); }
+    inline void Clear() { m_heap.clear(); }
     void Insert( int, float );
     int Remove( float& );
 
 private:
-    int m_cSize;
     struct tag_HEAP_NODE
     {
         int Id;
         float Priority;
-    } m_heap[MAX_STACK_NODES];
+    };
+    std::vector<tag_HEAP_NODE> m_heap;
     void Heap_SiftDown(int);
     void Heap_SiftUp();
 };
 
+//=========================================================
+// CPathSearch - scratch state for a shortest path search.
+// Node state is stamped with the generation of the search
+// that wrote it, so starting a new search doesn't have to
+// reset every node in the graph.
+//=========================================================
+class CPathSearch
+{
+public:
+    struct NodeState
+    {
+        float ClosestSoFar; // Distance to the source.
+        int PreviousNode;
+        unsigned int Generation;
+        bool Closed; // Shortest distance is known, don't visit again.
+    };
+
+    // Starts a new search over a graph of cNodes nodes.
+    void Begin( int cNodes );
+
+    inline bool Visited( int iNode ) const { return m_States[iNode].Generation == m_Generation; }
+    inline NodeState& State( int iNode ) { return m_States[iNode]; }
+
+    // Marks the node as visited by this search and returns its state.
+    NodeState& Visit( int iNode );
+
+    CQueuePriority Queue;
+
+private:
+    std::vector<NodeState> m_States;
+    unsigned int m_Generation = 0;
+};
+
+//=========================================================
+// CNodeGrid - uniform grid over the node positions. Lets
+// FindNearestNode visit nodes in order of distance without
+// having to look at every node in the graph.
+//=========================================================
+class CNodeGrid
+{
+public:
+    void Build( const CNode* pNodes, int cNodes );
+    void Clear();
+
+    inline bool IsEmpty() const { return m_CellStart.empty(); }
+
+    // Calls visitor( iNode, flDist ) for every node matching afNodeTypes in order of increasing
+    // distance to vecOrigin until it returns true. Returns that node, or NO_NODE.
+    template <typename Visitor>
+    int FindNearest( const CNode* pNodes, const Vector& vecOrigin, int afNodeTypes, Visitor&& visitor );
+
+private:
+    struct Candidate
+    {
+        float Dist;
+        int Node;
+
+        bool operator>( const Candidate& other ) const { return Dist > other.Dist; }
+    };
+
+    int CellCoord( float flValue, int iAxis ) const;
+    void AddCell( const CNode* pNodes, const Vector& vecOrigin, int afNodeTypes, int x, int y, int z );
+
+    Vector m_vecMins;
+    float m_flCellSize = 0;
+    int m_Dims[3]{};
+
+    std::vector<int> m_CellStart; // Index into m_CellNodes of each cell's first node. One extra entry marks the end.
+    std::vector<int> m_CellNodes;
+
+    std::vector<Candidate> m_Candidates; // Min-heap of nodes found so far, kept around between queries.
+};
+
+//=========================================================
+// CNearestNodeCache - least recently used cache of
+// FindNearestNode results, keyed by the query position
+// rounded to NODE_CACHE_QUANTUM units and the node types.
+//=========================================================
+#define NODE_CACHE_SIZE 1024
+#define NODE_CACHE_QUANTUM 4
+
+class CNearestNodeCache
+{
+public:
+    // Returns true and sets iNode if the result for this query is cached.
+    bool Find( const Vector& vecOrigin, int afNodeTypes, int& iNode );
+    void Insert( const Vector& vecOrigin, int afNodeTypes, int iNode );
+    void Clear();
+
+private:
+    struct Key
+    {
+        int Origin[3];
+        int NodeTypes;
+
+        bool operator==( const Key& ) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()( const Key& key ) const;
+    };
+
+    struct Entry
+    {
+        Key EntryKey;
+        int Node;
+    };
+
+    static Key MakeKey( const Vector& vecOrigin, int afNodeTypes );
+
+    // Most recently used entry first.
+    std::list<Entry> m_Entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_Lookup;
+};
+
 //=========================================================
 // hints - these MUST coincide with the HINTS listed under
 // info_node in the FGD file!
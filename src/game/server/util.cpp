@@ -26,6 +26,8 @@
 #include "shake.h"
 #include "UserMessages.h"
 #include "sound/MaterialSystem.h"
+#include "entities/EntityNameIndex.h"
+#include "entities/EntityPartition.h"
 
 float UTIL_WeaponTimeBase()
 {
@@ -123,111 +125,157 @@ void UTIL_MoveToOrigin( edict_t* pent, const Vector& vecGoal, float flDist, int
 }
 
 
-int UTIL_EntitiesInBox( CBaseEntity** pList, int listMax, const Vector& mins, const Vector& maxs, int flagMask )
+static bool EntityInBox( const edict_t* pEdict, const Vector& mins, const Vector& maxs, int flagMask )
 {
-    edict_t* pEdict = UTIL_GetEntityList();
-    CBaseEntity* pEntity;
-    int count;
+    if( 0 != pEdict->free ) // Not in use
+        return false;
 
-    count = 0;
+    if( 0 != flagMask && ( pEdict->v.flags & flagMask ) == 0 ) // Does it meet the criteria?
+        return false;
 
-    if( !pEdict )
-        return count;
+    if( mins.x > pEdict->v.absmax.x ||
+        mins.y > pEdict->v.absmax.y ||
+        mins.z > pEdict->v.absmax.z ||
+        maxs.x < pEdict->v.absmin.x ||
+        maxs.y < pEdict->v.absmin.y ||
+        maxs.z < pEdict->v.absmin.z )
+        return false;
 
-    // Ignore world.
-    ++pEdict;
+    return true;
+}
 
-    for( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
-    {
-        if( 0 != pEdict->free ) // Not in use
-            continue;
+static bool MonsterInSphere( const edict_t* pEdict, const Vector2D& origin, const Vector& center, float radiusSquared )
+{
+    float distance, delta;
 
-        if( 0 != flagMask && ( pEdict->v.flags & flagMask ) == 0 ) // Does it meet the criteria?
-            continue;
+    if( 0 != pEdict->free ) // Not in use
+        return false;
 
-        if( mins.x > pEdict->v.absmax.x ||
-            mins.y > pEdict->v.absmax.y ||
-            mins.z > pEdict->v.absmax.z ||
-            maxs.x < pEdict->v.absmin.x ||
-            maxs.y < pEdict->v.absmin.y ||
-            maxs.z < pEdict->v.absmin.z )
-            continue;
+    if( ( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) == 0 ) // Not a client/monster ?
+        return false;
 
-        pEntity = CBaseEntity::Instance( pEdict );
-        if( !pEntity )
-            continue;
+    // Use origin for X & Y since they are centered for all monsters
+    // Now X
+    delta = center.x - origin.x; //(pEdict->v.absmin.x + pEdict->v.absmax.x)*0.5;
+    delta *= delta;
 
-        pList[count] = pEntity;
-        count++;
+    if( delta > radiusSquared )
+        return false;
+    distance = delta;
 
-        if( count >= listMax )
-            return count;
-    }
+    // Now Y
+    delta = center.y - origin.y; //(pEdict->v.absmin.y + pEdict->v.absmax.y)*0.5;
+    delta *= delta;
 
-    return count;
-}
+    distance += delta;
+    if( distance > radiusSquared )
+        return false;
 
+    // Now Z
+    delta = center.z - ( pEdict->v.absmin.z + pEdict->v.absmax.z ) * 0.5;
+    delta *= delta;
 
-int UTIL_MonstersInSphere( CBaseEntity** pList, int listMax, const Vector& center, float radius )
-{
-    edict_t* pEdict = UTIL_GetEntityList();
-    CBaseEntity* pEntity;
-    int count;
-    float distance, delta;
+    distance += delta;
+    if( distance > radiusSquared )
+        return false;
 
-    count = 0;
-    float radiusSquared = radius * radius;
+    return true;
+}
 
-    if( !pEdict )
-        return count;
+/**
+ *    @brief Calls @p callback in edict order for every entity that passes @p filter and may overlap the given 2D region.
+ *    Stops when the callback returns false.
+ *    Uses the entity partition unless it has been disabled or can't handle the region.
+ *    @p filter is passed the entity's origin to test: the origin it was linked at when using the partition,
+ *    since that is what its cells are based on, or its current origin otherwise.
+ */
+template <typename Filter, typename Callback>
+static void ForEachEntityInRegion( float minX, float minY, float maxX, float maxY, Filter&& filter, Callback&& callback )
+{
+    edict_t* pEdicts = UTIL_GetEntityList();
 
-    // Ignore world.
-    ++pEdict;
+    if( !pEdicts )
+        return;
+
+    // Gathered up front so callbacks can run other queries or move entities.
+    EntityPartition::CandidateList candidates;
 
-    for( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
+    if( 0 != sv_entity_partition.value && g_EntityPartition.Query( minX, minY, maxX, maxY, candidates ) )
     {
-        if( 0 != pEdict->free ) // Not in use
-            continue;
+        for( int index : candidates )
+        {
+            if( index >= gpGlobals->maxEntities )
+                break;
 
-        if( ( pEdict->v.flags & ( FL_CLIENT | FL_MONSTER ) ) == 0 ) // Not a client/monster ?
-            continue;
+            edict_t* pEdict = pEdicts + index;
 
-        // Use origin for X & Y since they are centered for all monsters
-        // Now X
-        delta = center.x - pEdict->v.origin.x; //(pEdict->v.absmin.x + pEdict->v.absmax.x)*0.5;
-        delta *= delta;
+            if( !filter( pEdict, g_EntityPartition.GetLinkedOrigin( index ) ) )
+                continue;
 
-        if( delta > radiusSquared )
-            continue;
-        distance = delta;
+            CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
+            if( !pEntity )
+                continue;
 
-        // Now Y
-        delta = center.y - pEdict->v.origin.y; //(pEdict->v.absmin.y + pEdict->v.absmax.y)*0.5;
-        delta *= delta;
+            if( !callback( pEntity ) )
+                return;
+        }
 
-        distance += delta;
-        if( distance > radiusSquared )
-            continue;
+        return;
+    }
 
-        // Now Z
-        delta = center.z - ( pEdict->v.absmin.z + pEdict->v.absmax.z ) * 0.5;
-        delta *= delta;
+    // Ignore world.
+    for( int i = 1; i < gpGlobals->maxEntities; i++ )
+    {
+        edict_t* pEdict = pEdicts + i;
 
-        distance += delta;
-        if( distance > radiusSquared )
+        if( !filter( pEdict, pEdict->v.origin.Make2D() ) )
             continue;
 
-        pEntity = CBaseEntity::Instance( pEdict );
+        CBaseEntity* pEntity = CBaseEntity::Instance( pEdict );
         if( !pEntity )
             continue;
 
-        pList[count] = pEntity;
-        count++;
-
-        if( count >= listMax )
-            return count;
+        if( !callback( pEntity ) )
+            return;
     }
+}
 
+int UTIL_EntitiesInBox( CBaseEntity** pList, int listMax, const Vector& mins, const Vector& maxs, int flagMask )
+{
+    int count = 0;
+
+    if( listMax <= 0 )
+        return count;
+
+    ForEachEntityInRegion( mins.x, mins.y, maxs.x, maxs.y,
+        [&]( const edict_t* pEdict, const Vector2D& )
+        { return EntityInBox( pEdict, mins, maxs, flagMask ); },
+        [&]( CBaseEntity* pEntity )
+        {
+            pList[count++] = pEntity;
+            return count < listMax;
+        } );
+
+    return count;
+}
+
+int UTIL_MonstersInSphere( CBaseEntity** pList, int listMax, const Vector& center, float radius )
+{
+    int count = 0;
+
+    if( listMax <= 0 )
+        return count;
+
+    const float radiusSquared = radius * radius;
+
+    ForEachEntityInRegion( center.x - radius, center.y - radius, center.x + radius, center.y + radius,
+        [&]( const edict_t* pEdict, const Vector2D& origin )
+        { return MonsterInSphere( pEdict, origin, center, radiusSquared ); },
+        [&]( CBaseEntity* pEntity )
+        {
+            pList[count++] = pEntity;
+            return count < listMax;
+        } );
 
     return count;
 }
@@ -266,7 +314,7 @@ CBaseEntity* UTIL_FindEntityByString( CBaseEntity* pStartEntity, const char* szK
 }
 
 template <typename Accessor>
-CBaseEntity* UTIL_FindEntityByAccessor( CBaseEntity* pStartEntity, const char* szName, Accessor accessor )
+CBaseEntity* UTIL_FindEntityByAccessor( CBaseEntity* pStartEntity, const char* szName, EntityNameField field, Accessor accessor )
 {
     if( !szName )
     {
@@ -279,57 +327,54 @@ CBaseEntity* UTIL_FindEntityByAccessor( CBaseEntity* pStartEntity, const char* s
 
     int index = pStartEntity ? ( pStartEntity->entindex() + 1 ) : 1;
 
-    // TODO: the engine checks the highest entity index that's been used, not maxentities
-
     // Allow the use of wildcards at the end of a token to perform prefix matching.
-    if( token.ends_with( '*' ) )
+    const bool prefix = token.ends_with( '*' );
+
+    if( prefix )
     {
         token = token.substr( 0, token.size() - 1 );
+    }
 
-        for( ; index < gpGlobals->maxEntities; ++index )
+    const auto matches = [&]( edict_t* edict )
+    {
+        if( edict->free )
         {
-            auto edict = &list[index];
-
-            if( edict->free )
-            {
-                continue;
-            }
+            return false;
+        }
 
-            auto str = accessor( &edict->v );
+        auto str = accessor( &edict->v );
 
-            if( FStringNull( str ) )
-            {
-                continue;
-            }
+        if( FStringNull( str ) )
+        {
+            return false;
+        }
 
-            if( std::string_view( STRING( str ) ).starts_with( token ) )
-            {
-                return GET_PRIVATE<CBaseEntity>( edict );
-            }
+        if( prefix )
+        {
+            return std::string_view( STRING( str ) ).starts_with( token );
         }
-    }
-    else
+
+        return token == STRING( str );
+    };
+
+    if( 0 != sv_entity_name_index.value )
     {
-        for( ; index < gpGlobals->maxEntities; ++index )
+        if( const int found = g_EntityNameIndex.FindNext( field, token, prefix, index ); found != -1 && found < gpGlobals->maxEntities )
         {
-            auto edict = &list[index];
-
-            if( edict->free )
-            {
-                continue;
-            }
+            return GET_PRIVATE<CBaseEntity>( &list[found] );
+        }
 
-            auto str = accessor( &edict->v );
+        return nullptr;
+    }
 
-            if( FStringNull( str ) )
-            {
-                continue;
-            }
+    // TODO: the engine checks the highest entity index that's been used, not maxentities
+    for( ; index < gpGlobals->maxEntities; ++index )
+    {
+        auto edict = &list[index];
 
-            if( token == STRING( str ) )
-            {
-                return GET_PRIVATE<CBaseEntity>( edict );
-            }
+        if( matches( edict ) )
+        {
+            return GET_PRIVATE<CBaseEntity>( edict );
         }
     }
 
@@ -338,7 +383,7 @@ CBaseEntity* UTIL_FindEntityByAccessor( CBaseEntity* pStartEntity, const char* s
 
 CBaseEntity* UTIL_FindEntityByClassname( CBaseEntity* pStartEntity, const char* szName )
 {
-    return UTIL_FindEntityByAccessor( pStartEntity, szName, []( auto entity )
+    return UTIL_FindEntityByAccessor( pStartEntity, szName, EntityNameField::Classname, []( auto entity )
         { return entity->classname; } );
 }
 
@@ -368,13 +413,13 @@ CBaseEntity* UTIL_FindEntityByTargetname( CBaseEntity* pStartEntity, const char*
         return nullptr;
     }
 
-    return UTIL_FindEntityByAccessor( pStartEntity, szName, []( auto entity )
+    return UTIL_FindEntityByAccessor( pStartEntity, szName, EntityNameField::Targetname, []( auto entity )
         { return entity->targetname; } );
 }
 
 CBaseEntity* UTIL_FindEntityByTarget( CBaseEntity* pStartEntity, const char* szName )
 {
-    return UTIL_FindEntityByAccessor( pStartEntity, szName, []( auto entity )
+    return UTIL_FindEntityByAccessor( pStartEntity, szName, EntityNameField::Target, []( auto entity )
         { return entity->target; } );
 }
 
@@ -1340,7 +1385,8 @@ void UTIL_Remove( CBaseEntity* entity )
 
         entity->UpdateOnRemove();
         entity->pev->flags |= FL_KILLME;
-        entity->pev->targetname = string_t::Null;
+        entity->SetTargetname( string_t::Null );
+
     }
 }
 
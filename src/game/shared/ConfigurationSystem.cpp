@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cctype>
 #include <charconv>
+#include <chrono>
 #include <optional>
 #include <regex>
 #include <tuple>
@@ -202,6 +203,11 @@ bool ConfigurationSystem::Initialize()
 
             SetValue( name, value ); },
         CommandLibraryPrefix::No );
+
+    g_ConCommands.CreateCommand( 
+        "cfg_benchmark", [this]( const auto& args )
+        { RunLookupBenchmark( args.Count() > 1 ? std::max( 1, atoi( args.Argument( 1 ) ) ) : 1000 ); },
+        CommandLibraryPrefix::No );
 #else
     g_ClientUserMessages.RegisterHandler( "ConfigVars", &ConfigurationSystem::MsgFunc_ConfigVars, this );
 #endif
@@ -249,6 +255,7 @@ void ConfigurationSystem::HandleNetworkDataBlock( NetworkDataBlock& block )
     else
     {
         m_ConfigVariables.clear();
+        RebuildVariableIndices();
         m_NextNetworkedIndex = 0;
 
         for( const auto& varData : block.Data )
@@ -295,6 +302,7 @@ void ConfigurationSystem::LoadConfigurationFiles()
             it = m_ConfigVariables.erase( it );
         }
     }
+    RebuildVariableIndices();
     m_CustomMaps.clear();
     m_CustomMapIndex.clear();
 
@@ -323,10 +331,7 @@ void ConfigurationSystem::LoadConfigurationFiles()
 
 void ConfigurationSystem::DefineVariable( std::string name, float initialValue, const ConfigVarConstraints& constraints )
 {
-    auto it = std::find_if( m_ConfigVariables.begin(), m_ConfigVariables.end(), [&]( const auto& variable )
-        { return variable.Name == name; } );
-
-    if( it != m_ConfigVariables.end() )
+    if( FindVariable( GetVariableId( name ), nullptr ) )
     {
         m_Logger->error( "Cannot define variable \"{}\": already defined", name );
         assert( !"Variable already defined" );
@@ -369,61 +374,96 @@ void ConfigurationSystem::DefineVariable( std::string name, float initialValue,
         .NetworkIndex = networkIndex,
         .Flags = VarFlag_IsExplicitlyDefined};
 
-    m_ConfigVariables.emplace_back( std::move( variable ) );
+    AddVariable( m_ConfigVariables, std::move( variable ) );
 }
 
-template <typename T>
-T ConfigurationSystem::GetValue( 
-    std::string_view name,
-    std::optional<T> defaultValue,
-    CBaseEntity* entity
-) const
+int ConfigurationSystem::GetVariableId( std::string_view name ) const
 {
-    std::optional<ConfigVariable> variable;
+    if( const auto it = m_VariableIds.find( name ); it != m_VariableIds.end() )
+    {
+        return it->second;
+    }
 
-#ifndef CLIENT_DLL
-    if( entity != nullptr )
+    const int id = static_cast<int>( m_VariableIndices.size() );
+
+    m_VariableIds.emplace( std::string{name}, id );
+    m_VariableIndices.push_back( UndefinedVariableIndex );
+
+    return id;
+}
+
+ConfigurationSystem::ConfigVariable& ConfigurationSystem::AddVariable( std::vector<ConfigVariable>& variables, ConfigVariable&& variable )
+{
+    variable.Id = GetVariableId( variable.Name );
+
+    auto& added = variables.emplace_back( std::move( variable ) );
+
+    if( &variables == &m_ConfigVariables )
     {
-        std::vector<ConfigVariable>& config_map = entity->m_ConfigVariables;
+        m_VariableIndices[added.Id] = static_cast<int>( m_ConfigVariables.size() - 1 );
+    }
+
+    return added;
+}
+
+void ConfigurationSystem::RebuildVariableIndices()
+{
+    std::fill( m_VariableIndices.begin(), m_VariableIndices.end(), UndefinedVariableIndex );
 
-        if( const auto it = std::find_if( config_map.begin(), config_map.end(),
-            [&]( const auto& variable )
-                { return variable.Name == name; } );
-                    it != config_map.end() )
-                        { variable = *it; }
+    for( std::size_t i = 0; i < m_ConfigVariables.size(); ++i )
+    {
+        m_VariableIndices[m_ConfigVariables[i].Id] = static_cast<int>( i );
+    }
+}
 
-        if( !variable.has_value() && entity->m_config >= 0 && entity->m_config < (int)m_CustomMaps.size() )
+const ConfigurationSystem::ConfigVariable* ConfigurationSystem::FindVariable( int id, CBaseEntity* entity ) const
+{
+#ifndef CLIENT_DLL
+    if( entity != nullptr )
+    {
+        // Entities only override a few variables, so a linear search is fastest here.
+        for( const auto& variable : entity->m_ConfigVariables )
         {
-            config_map = m_CustomMaps.at( entity->m_config );
+            if( variable.Id == id )
+            {
+                return &variable;
+            }
+        }
 
-            if( const auto it = std::find_if( config_map.begin(), config_map.end(),
-                [&]( const auto& variable )
-                    { return variable.Name == name; } );
-                        it != config_map.end() )
-                            { variable = *it; }
+        if( entity->m_config >= 0 && entity->m_config < (int)m_CustomMaps.size() )
+        {
+            for( const auto& variable : m_CustomMaps[entity->m_config] )
+            {
+                if( variable.Id == id )
+                {
+                    return &variable;
+                }
+            }
         }
     }
 #endif
 
-    if( !variable.has_value() )
+    if( const int index = m_VariableIndices[id]; index != UndefinedVariableIndex )
     {
-        if( const auto it = std::find_if( m_ConfigVariables.begin(), m_ConfigVariables.end(),
-            [&]( const auto& variable )
-                { return variable.Name == name; } );
-                    it != m_ConfigVariables.end() )
-                        { variable = *it; }
+        return &m_ConfigVariables[index];
     }
 
-    if( variable.has_value() )
+    return nullptr;
+}
+
+template <typename T>
+T ConfigurationSystem::GetValue( int id, std::string_view name, std::optional<T> defaultValue, CBaseEntity* entity ) const
+{
+    if( const auto variable = FindVariable( id, entity ); variable )
     {
         if constexpr ( std::is_same_v<T, bool> )
-            return ( static_cast<int>( variable.value().CurrentValue ) >= 1 );
+            return ( static_cast<int>( variable->CurrentValue ) >= 1 );
         if constexpr ( std::is_same_v<T, int> )
-            return static_cast<int>( variable.value().CurrentValue );
+            return static_cast<int>( variable->CurrentValue );
         if constexpr ( std::is_same_v<T, float> )
-            return variable.value().CurrentValue;
+            return variable->CurrentValue;
         if constexpr ( std::is_same_v<T, std::string> )
-            return variable.value().StringValue;
+            return variable->StringValue;
     }
 
     m_Logger->debug( "Undefined variable {}{}", name, m_SkillLevel );
@@ -437,29 +477,57 @@ T ConfigurationSystem::GetValue(
     return defaultValue.value();
 }
 
+template <typename T>
+T ConfigurationSystem::GetValue( 
+    std::string_view name,
+    std::optional<T> defaultValue,
+    CBaseEntity* entity
+) const
+{
+    return GetValue<T>( GetVariableId( name ), name, defaultValue, entity );
+}
+
+template <typename T>
+T ConfigurationSystem::GetValue( const ConfigVarHandle& handle, std::optional<T> defaultValue, CBaseEntity* entity ) const
+{
+    if( handle.m_Id == InvalidVariableId )
+    {
+        handle.m_Id = GetVariableId( handle.m_Name );
+    }
+
+    return GetValue<T>( handle.m_Id, handle.m_Name, defaultValue, entity );
+}
+
 template float ConfigurationSystem::GetValue<float>( std::string_view name, std::optional<float> defaultValue, CBaseEntity* entity ) const;
 template int ConfigurationSystem::GetValue<int>( std::string_view name, std::optional<int> defaultValue, CBaseEntity* entity ) const;
 template bool ConfigurationSystem::GetValue<bool>( std::string_view name, std::optional<bool> defaultValue, CBaseEntity* entity ) const;
 template std::string ConfigurationSystem::GetValue<std::string>( std::string_view name, std::optional<std::string> defaultValue, CBaseEntity* entity ) const;
 
+template float ConfigurationSystem::GetValue<float>( const ConfigVarHandle& handle, std::optional<float> defaultValue, CBaseEntity* entity ) const;
+template int ConfigurationSystem::GetValue<int>( const ConfigVarHandle& handle, std::optional<int> defaultValue, CBaseEntity* entity ) const;
+template bool ConfigurationSystem::GetValue<bool>( const ConfigVarHandle& handle, std::optional<bool> defaultValue, CBaseEntity* entity ) const;
+template std::string ConfigurationSystem::GetValue<std::string>( const ConfigVarHandle& handle, std::optional<std::string> defaultValue, CBaseEntity* entity ) const;
+
 void ConfigurationSystem::SetValue( std::string_view name, std::variant<float, int, bool, std::string_view> value, std::optional<CBaseEntity*> target )
 {
-    std::vector<ConfigVariable>& m_TargetMap = m_ConfigVariables;
+    std::vector<ConfigVariable>* targetMap = &m_ConfigVariables;
 
 #ifndef CLIENT_DLL
     if( target.has_value() )
     {
         if( auto entity = target.value(); entity != nullptr )
         {
-            m_TargetMap = entity->m_ConfigVariables;
+            targetMap = &entity->m_ConfigVariables;
         }
     }
 #endif
 
-    auto it = std::find_if( m_TargetMap.begin(), m_TargetMap.end(), [&]( const auto& variable )
-        { return variable.Name == name; } );
+    const int id = GetVariableId( name );
+
+    auto it = std::find_if( targetMap->begin(), targetMap->end(), [&]( const auto& variable )
+        { return variable.Id == id; } );
 
-    if( it == m_TargetMap.end() )
+    if( it == targetMap->end() )
     {
         ConfigVariable variable{
             .Name = std::string{name},
@@ -467,9 +535,9 @@ void ConfigurationSystem::SetValue( std::string_view name, std::variant<float, i
             .InitialValue = 0
         };
 
-        m_TargetMap.emplace_back( std::move( variable ) );
+        AddVariable( *targetMap, std::move( variable ) );
 
-        it = m_TargetMap.end() - 1;
+        it = targetMap->end() - 1;
     }
 
     float fValue = 0;
@@ -651,8 +719,10 @@ bool ConfigurationSystem::ParseConfiguration( json& input, const bool CustomMap
             if( CustomMap )
             {
                 // -TODO Should move this in within SetValue and just target the right vector.
+                const int id = GetVariableId( name );
+
                 auto it = std::find_if( config_map.begin(), config_map.end(), [&]( const auto& variable )
-                    { return variable.Name == name; } );
+                    { return variable.Id == id; } );
 
                 if( it == config_map.end() )
                 {
@@ -662,7 +732,7 @@ bool ConfigurationSystem::ParseConfiguration( json& input, const bool CustomMap
                         .InitialValue = 0
                     };
             
-                    config_map.emplace_back( std::move( variable ) );
+                    AddVariable( config_map, std::move( variable ) );
             
                     it = config_map.end() - 1;
                 }
@@ -738,6 +808,81 @@ void ConfigurationSystem::MsgFunc_ConfigVars( BufferReader& reader )
 
 
 #ifndef CLIENT_DLL
+void ConfigurationSystem::RunLookupBenchmark( int iterations ) const
+{
+    if( m_ConfigVariables.empty() )
+    {
+        Con_Printf( "No configuration variables defined\n" );
+        return;
+    }
+
+    std::vector<std::string> names;
+    names.reserve( m_ConfigVariables.size() );
+
+    for( const auto& variable : m_ConfigVariables )
+    {
+        names.push_back( variable.Name );
+    }
+
+    // Handles refer to the names, so they must not move after this.
+    std::vector<ConfigVarHandle> handles;
+    handles.reserve( names.size() );
+
+    for( const auto& name : names )
+    {
+        handles.emplace_back( name );
+    }
+
+    float sum = 0;
+
+    const auto measure = [&]( auto&& lookup )
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        for( int i = 0; i < iterations; ++i )
+        {
+            for( std::size_t j = 0; j < names.size(); ++j )
+            {
+                sum += lookup( j );
+            }
+        }
+
+        const std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+        return ( names.size() * iterations ) / std::max( duration.count(), 1e-9 );
+    };
+
+    // The lookup GetValue used before variables had IDs: a linear search that copies the variable.
+    const double linearRate = measure( [&]( std::size_t j )
+        {
+            std::optional<ConfigVariable> variable;
+
+            if( const auto it = std::find_if( m_ConfigVariables.begin(), m_ConfigVariables.end(), [&]( const auto& candidate )
+                    { return candidate.Name == names[j]; } );
+                it != m_ConfigVariables.end() )
+            {
+                variable = *it;
+            }
+
+            return variable ? variable->CurrentValue : 0.f;
+        } );
+
+    const double nameRate = measure( [&]( std::size_t j )
+        { return GetValue<float>( names[j], 0.f ); } );
+
+    const double handleRate = measure( [&]( std::size_t j )
+        { return GetValue<float>( handles[j], 0.f ); } );
+
+    // Keep the lookups from being optimized away.
+    volatile float result = sum;
+    (void)result;
+
+    Con_Printf( "%zu variables, %d iterations\n", names.size(), iterations );
+    Con_Printf( "Linear search: %.0f lookups/sec\n", linearRate );
+    Con_Printf( "By name: %.0f lookups/sec\n", nameRate );
+    Con_Printf( "By handle: %.0f lookups/sec\n", handleRate );
+}
+
 int ConfigurationSystem::CustomConfigurationFile( const char* filename )
 {
     std::string name = std::string( filename );
@@ -22,6 +22,7 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <fmt/core.h>
@@ -31,6 +32,7 @@
 #include "networking/NetworkDataSystem.h"
 #include "utils/json_fwd.h"
 #include "utils/GameSystem.h"
+#include "utils/heterogeneous_lookup.h"
 
 class BufferReader;
 
@@ -66,6 +68,28 @@ struct ConfigVarConstraints
     ConfigVarType Type{ConfigVarType::Float};
 };
 
+/**
+ *    @brief Refers to a configuration variable by ID so lookups don't have to compare names.
+ *    @details Handles can be created during static initialization.
+ *    The name is resolved to an ID on first use, and that ID stays valid for the lifetime of the program.
+ */
+class ConfigVarHandle final
+{
+public:
+    explicit constexpr ConfigVarHandle( std::string_view name )
+        : m_Name( name )
+    {
+    }
+
+    constexpr std::string_view GetName() const { return m_Name; }
+
+private:
+    friend class ConfigurationSystem;
+
+    std::string_view m_Name;
+    mutable int m_Id = -1;
+};
+
 /**
  *    @brief Loads skill variables from files and provides a means of looking them up.
  */
@@ -84,6 +108,9 @@ private:
 
     static constexpr int SingleMessageSize = sizeof( MessageIndex ) + sizeof(float);
 
+    static constexpr int InvalidVariableId = -1;
+    static constexpr int UndefinedVariableIndex = -1;
+
     enum VarFlag
     {
         VarFlag_IsExplicitlyDefined = 1 << 0,
@@ -100,6 +127,7 @@ public:
         ConfigVarConstraints Constraints;
         int NetworkIndex = NotNetworkedIndex;
         int Flags = 0;
+        int Id = InvalidVariableId;
     };
 
     const char* GetName() const override { return "Configuration"; }
@@ -124,6 +152,18 @@ public:
     template <typename T>
     T GetValue( std::string_view name, std::optional<T> defaultValue = std::nullopt, CBaseEntity* entity = nullptr ) const;
 
+    /**
+     *    @brief Gets the value for a given skill variable without looking up its name.
+     */
+    template <typename T>
+    T GetValue( const ConfigVarHandle& handle, std::optional<T> defaultValue = std::nullopt, CBaseEntity* entity = nullptr ) const;
+
+    /**
+     *    @brief Gets the ID for a variable name, creating one if the name hasn't been seen before.
+     *    IDs are never reused, even if the variable is removed.
+     */
+    int GetVariableId( std::string_view name ) const;
+
     void SetValue( std::string_view name, std::variant<float, int, bool, std::string_view> value, std::optional<CBaseEntity*> target = std::nullopt );
 
 #ifndef CLIENT_DLL
@@ -140,6 +180,28 @@ private:
 
     bool ParseConfiguration( json& input, const bool CustomMap );
 
+    /**
+     *    @brief Finds the variable for @p id, checking the entity's own variables and its custom configuration first.
+     */
+    const ConfigVariable* FindVariable( int id, CBaseEntity* entity ) const;
+
+    template <typename T>
+    T GetValue( int id, std::string_view name, std::optional<T> defaultValue, CBaseEntity* entity ) const;
+
+    /**
+     *    @brief Adds a variable with the given name to @p variables. Keeps the index up to date if it's the global list.
+     */
+    ConfigVariable& AddVariable( std::vector<ConfigVariable>& variables, ConfigVariable&& variable );
+
+    /**
+     *    @brief Must be called whenever variables are removed from @c m_ConfigVariables.
+     */
+    void RebuildVariableIndices();
+
+#ifndef CLIENT_DLL
+    void RunLookupBenchmark( int iterations ) const;
+#endif
+
 #ifdef CLIENT_DLL
     void MsgFunc_ConfigVars( BufferReader& reader );
 #endif
@@ -151,6 +213,12 @@ private:
 
     std::vector<ConfigVariable> m_ConfigVariables;
 
+    // Every variable name seen so far. Handles cache the ID so this is only searched once per handle.
+    mutable std::unordered_map<std::string, int, TransparentStringHash, TransparentEqual> m_VariableIds;
+
+    // Index into m_ConfigVariables for each ID, or UndefinedVariableIndex.
+    mutable std::vector<int> m_VariableIndices;
+
     int m_NextNetworkedIndex = 0;
 
     bool m_LoadingConfigurationFiles = false;
@@ -66,6 +66,9 @@ bool GameLibrary::Initialize()
     g_ConCommands.CreateCommand( "log_setentlevels", [this]( const auto& args )
         { SetEntLogLevels( args ); } );
 
+    g_ConCommands.CreateCommand( "stringpool_stats", []( const auto& )
+        { PrintStringPoolStats(); } );
+
     return true;
 }
 
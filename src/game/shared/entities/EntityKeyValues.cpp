@@ -0,0 +1,133 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <cstring>
+
+#include "cbase.h"
+#include "EntityKeyValues.h"
+
+const EntityKeyValues::Pair* EntityKeyValues::Find( std::string_view key ) const
+{
+    for( const auto& pair : m_Pairs )
+    {
+        if( key == STRING( pair.Key ) )
+        {
+            return &pair;
+        }
+    }
+
+    return nullptr;
+}
+
+const char* EntityKeyValues::GetValue( std::string_view key ) const
+{
+    if( auto pair = Find( key ); pair )
+    {
+        return STRING( pair->Value );
+    }
+
+    return "";
+}
+
+void EntityKeyValues::SetValue( std::string_view key, std::string_view value )
+{
+    if( auto pair = Find( key ); pair )
+    {
+        pair->Value = ALLOC_STRING_VIEW( value );
+        return;
+    }
+
+    m_Pairs.push_back( Pair{ALLOC_STRING_VIEW( key ), ALLOC_STRING_VIEW( value )} );
+}
+
+std::size_t DataFieldEntityKeyValuesSerializer::GetFieldSize() const
+{
+    return sizeof( EntityKeyValues );
+}
+
+void DataFieldEntityKeyValuesSerializer::Serialize( CSave& save, const std::byte* fields, std::size_t count ) const
+{
+    auto address = reinterpret_cast<const EntityKeyValues*>( fields );
+
+    for( std::size_t i = 0; i < count; ++i, ++address )
+    {
+        const auto pairs = address->GetPairs();
+
+        save.WriteValue( int( pairs.size() ) );
+
+        for( const auto& pair : pairs )
+        {
+            for( auto string : {STRING( pair.Key ), STRING( pair.Value )} )
+            {
+                save.WriteBytes( reinterpret_cast<const std::byte*>( string ), std::strlen( string ) + 1 );
+            }
+        }
+    }
+}
+
+void DataFieldEntityKeyValuesSerializer::Deserialize( CRestore& restore, std::byte* fields, std::size_t count ) const
+{
+    auto address = reinterpret_cast<EntityKeyValues*>( fields );
+
+    const auto readString = [&]()
+    {
+        const std::string_view string{reinterpret_cast<const char*>( restore.GetReadAddress() )};
+        restore.ReadBytes( nullptr, string.size() + 1 );
+        return string;
+    };
+
+    for( std::size_t i = 0; i < count; ++i, ++address )
+    {
+        const int pairCount = restore.ReadValue<int>();
+
+        for( int pair = 0; pair < pairCount && !restore.HasOverflowed(); ++pair )
+        {
+            const auto key = readString();
+            const auto value = readString();
+
+            if( restore.HasOverflowed() )
+            {
+                break;
+            }
+
+            address->SetValue( key, value );
+        }
+    }
+}
+
+bool DataFieldEntityKeyValuesSerializer::IsEmpty( const std::byte* fields, std::size_t count ) const
+{
+    auto address = reinterpret_cast<const EntityKeyValues*>( fields );
+
+    for( std::size_t i = 0; i < count; ++i, ++address )
+    {
+        if( !address->IsEmpty() )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DataFieldEntityKeyValuesSerializer::Clear( std::byte* fields, std::size_t count ) const
+{
+    auto address = reinterpret_cast<EntityKeyValues*>( fields );
+
+    for( std::size_t i = 0; i < count; ++i, ++address )
+    {
+        address->Clear();
+    }
+}
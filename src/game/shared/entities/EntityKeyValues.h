@@ -0,0 +1,83 @@
+/***
+ *
+ *    Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *    This product contains software technology licensed from Id
+ *    Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *    All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include <EASTL/fixed_vector.h>
+
+#include "Platform.h"
+#include "DataFieldSerializers.h"
+
+/**
+ *    @brief Keyvalues set on an entity, stored as pairs of pooled strings.
+ *    @details The first few pairs are stored inline. Entities with more spill over to the heap.
+ */
+class EntityKeyValues final
+{
+public:
+    struct Pair
+    {
+        string_t Key;
+        string_t Value;
+    };
+
+    bool IsEmpty() const { return m_Pairs.empty(); }
+
+    std::span<const Pair> GetPairs() const { return {m_Pairs.data(), m_Pairs.size()}; }
+
+    /**
+     *    @brief Gets the value for @p key, or an empty string if it isn't set.
+     */
+    const char* GetValue( std::string_view key ) const;
+
+    bool HasValue( std::string_view key ) const { return Find( key ) != nullptr; }
+
+    void SetValue( std::string_view key, std::string_view value );
+
+    void Clear() { m_Pairs.clear(); }
+
+private:
+    static constexpr std::size_t InlineCount = 4;
+
+    const Pair* Find( std::string_view key ) const;
+
+    Pair* Find( std::string_view key )
+    {
+        return const_cast<Pair*>( static_cast<const EntityKeyValues*>( this )->Find( key ) );
+    }
+
+    eastl::fixed_vector<Pair, InlineCount, true> m_Pairs;
+};
+
+/**
+ *    @brief Writes the number of pairs followed by each key and value as null terminated strings.
+ */
+class DataFieldEntityKeyValuesSerializer final : public IDataFieldSerializer
+{
+public:
+    std::size_t GetFieldSize() const override;
+    void Serialize( CSave& save, const std::byte* fields, std::size_t count ) const override;
+    void Deserialize( CRestore& restore, std::byte* fields, std::size_t count ) const override;
+    bool IsEmpty( const std::byte* fields, std::size_t count ) const override;
+    void Clear( std::byte* fields, std::size_t count ) const override;
+
+    static const DataFieldEntityKeyValuesSerializer Instance;
+};
+
+inline const DataFieldEntityKeyValuesSerializer DataFieldEntityKeyValuesSerializer::Instance;
@@ -17,6 +17,7 @@
 #include "CBaseEntity.h"
 
 #ifndef CLIENT_DLL
+#include "EntityNameIndex.h"
 #include "EntityTemplateSystem.h"
 #endif
 
@@ -161,13 +162,8 @@ BEGIN_DATAMAP_NOBASE(CBaseEntity)
     DEFINE_FIELD( m_UseLocked, FIELD_INTEGER ),
     DEFINE_FIELD( m_uselos, FIELD_BOOLEAN ),
 
-    DEFINE_FIELD( m_KeyValues.size, FIELD_INTEGER ),
-    DEFINE_ARRAY( m_KeyValues.m_Keys, FIELD_STRING, MAX_KEYVALUEMANAGER_ENTRIES ),
-    DEFINE_ARRAY( m_KeyValues.m_Values, FIELD_STRING, MAX_KEYVALUEMANAGER_ENTRIES ),
-    DEFINE_FIELD( m_CustomKeyValues.custom, FIELD_BOOLEAN ),
-    DEFINE_FIELD( m_CustomKeyValues.size, FIELD_INTEGER ),
-    DEFINE_ARRAY( m_CustomKeyValues.m_Keys, FIELD_STRING, MAX_KEYVALUEMANAGER_ENTRIES ),
-    DEFINE_ARRAY( m_CustomKeyValues.m_Values, FIELD_STRING, MAX_KEYVALUEMANAGER_ENTRIES ),
+    DEFINE_CUSTOM_FIELD( m_KeyValues, DataFieldEntityKeyValuesSerializer::Instance ),
+    DEFINE_CUSTOM_FIELD( m_CustomKeyValues, DataFieldEntityKeyValuesSerializer::Instance ),
 
     DEFINE_FIELD( m_CustomHullMin, FIELD_VECTOR ),
     DEFINE_FIELD( m_CustomHullMax, FIELD_VECTOR ),
@@ -192,6 +188,7 @@ void CBaseEntity::Construct()
 
 #ifndef CLIENT_DLL
     g_EntityTemplates.MaybeApplyTemplate( this );
+    g_EntityNameIndex.Update( this );
 #endif
 }
 
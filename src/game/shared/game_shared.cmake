@@ -22,6 +22,8 @@ function(add_game_shared_sources target)
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityClassificationSystem.cpp
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityClassificationSystem.h
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityDictionary.h
+            ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityKeyValues.cpp
+            ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityKeyValues.h
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/entity_shared.cpp
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/entity_utils.cpp
             ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/entity_utils.h
@@ -14,10 +14,14 @@
  ****/
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <regex>
+#include <stdexcept>
 
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
@@ -36,12 +40,52 @@ constexpr std::size_t MinimumFileDataSize = MAX_QPATH + "uncompressed"sv.size()
 namespace
 {
 constexpr std::string_view NetworkDataDirectory{"networkdata"sv};
+
+// The file name is the same for all encodings; the encoding is detected from the contents.
+// A file left over from a server that used another encoding is decoded using its own header,
+// and rejected by the header check if its format isn't supported.
 const std::string NetworkDataFileName{fmt::format( "{}/data.json", NetworkDataDirectory )};
+
+/**
+ *    @brief Binary files start with this header. JSON files start with '{' so they can't be mistaken for one.
+ *    @details Layout: 4 byte magic, format version, encoding, compression, reserved byte,
+ *    payload size as a 32 bit little endian integer.
+ */
+constexpr std::array<std::uint8_t, 4> BinaryMagic{'H', 'L', 'N', 'D'};
+constexpr std::uint8_t BinaryFormatVersion = 1;
+constexpr std::size_t BinaryHeaderSize = 12;
+
+enum class NetworkDataCompression : std::uint8_t
+{
+    None = 0
+};
+
+constexpr std::string_view GetEncodingName( NetworkDataEncoding encoding )
+{
+    switch( encoding )
+    {
+    case NetworkDataEncoding::Json: return "JSON";
+    case NetworkDataEncoding::MessagePack: return "MessagePack";
+    case NetworkDataEncoding::Cbor: return "CBOR";
+    }
+
+    return "Unknown";
+}
+
+double ToMilliseconds( std::chrono::high_resolution_clock::duration duration )
+{
+    return std::chrono::duration<double, std::milli>( duration ).count();
+}
 }
 
 bool NetworkDataSystem::Initialize()
 {
     m_Logger = g_Logging.CreateLogger( "net_data" );
+
+#ifndef CLIENT_DLL
+    m_Encoding = g_ConCommands.CreateCVar( "net_data_encoding", "1" );
+#endif
+
     return true;
 }
 
@@ -85,6 +129,8 @@ void NetworkDataSystem::RemoveNetworkDataFiles( const char* pathID )
 #ifndef CLIENT_DLL
 bool NetworkDataSystem::GenerateNetworkDataFile()
 {
+    const auto start = std::chrono::high_resolution_clock::now();
+
     const auto output = TryGenerateNetworkData();
 
     if( !output )
@@ -92,6 +138,8 @@ bool NetworkDataSystem::GenerateNetworkDataFile()
         return false;
     }
 
+    m_Logger->debug( "Network data generated in {:.3f} ms", ToMilliseconds( std::chrono::high_resolution_clock::now() - start ) );
+
     // Remove any existing files first to prevent problems if it isn't purged by the filesystem on open.
     RemoveNetworkDataFiles( "GAMECONFIG" );
 
@@ -188,18 +236,63 @@ bool NetworkDataSystem::TryWriteNetworkDataFile( const std::string& fileName, co
         return false;
     }
 
+    const auto encoding = GetEncoding();
+
     try
     {
-        // The engine generally accepts invalid UTF8 text in things like filenames so ignore invalid UTF8.
-        auto fileData = output.dump( -1, ' ', false, nlohmann::detail::error_handler_t::ignore );
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::uint8_t> fileData;
 
-        // Pad the file with whitespace to reach the minium valid size.
-        if( fileData.size() < MinimumFileDataSize )
+        if( encoding == NetworkDataEncoding::Json )
         {
-            fileData.append( MinimumFileDataSize - fileData.size(), ' ' );
+            // The engine generally accepts invalid UTF8 text in things like filenames so ignore invalid UTF8.
+            const auto text = output.dump( -1, ' ', false, nlohmann::detail::error_handler_t::ignore );
+
+            fileData.assign( text.begin(), text.end() );
+
+            // Pad the file with whitespace to reach the minium valid size.
+            if( fileData.size() < MinimumFileDataSize )
+            {
+                fileData.resize( MinimumFileDataSize, ' ' );
+            }
+        }
+        else
+        {
+            // Binary encodings don't validate UTF8 so invalid text is passed through as-is.
+            fileData.resize( BinaryHeaderSize );
+
+            if( encoding == NetworkDataEncoding::MessagePack )
+            {
+                json::to_msgpack( output, fileData );
+            }
+            else
+            {
+                json::to_cbor( output, fileData );
+            }
+
+            const auto payloadSize = static_cast<std::uint32_t>( fileData.size() - BinaryHeaderSize );
+
+            std::copy( BinaryMagic.begin(), BinaryMagic.end(), fileData.begin() );
+            fileData[4] = BinaryFormatVersion;
+            fileData[5] = static_cast<std::uint8_t>( encoding );
+            fileData[6] = static_cast<std::uint8_t>( NetworkDataCompression::None );
+            fileData[7] = 0;
+
+            for( std::size_t i = 0; i < sizeof( payloadSize ); ++i )
+            {
+                fileData[8 + i] = static_cast<std::uint8_t>( ( payloadSize >> ( i * 8 ) ) & 0xFF );
+            }
+
+            // The payload size tells the parser where the padding begins.
+            if( fileData.size() < MinimumFileDataSize )
+            {
+                fileData.resize( MinimumFileDataSize, 0 );
+            }
         }
 
-        m_Logger->debug( "Network data saved: {} bytes", fileData.size() );
+        m_Logger->debug( "Network data saved: {} bytes ({}, serialized in {:.3f} ms)", fileData.size(),
+            GetEncodingName( encoding ), ToMilliseconds( std::chrono::high_resolution_clock::now() - start ) );
 
         file.Write( fileData.data(), fileData.size() );
 
@@ -207,13 +300,78 @@ bool NetworkDataSystem::TryWriteNetworkDataFile( const std::string& fileName, co
     }
     catch ( const std::exception& e )
     {
-        m_Logger->critical( "Error converting JSON to UTF8 text: {}", e.what() );
+        m_Logger->critical( "Error encoding network data as {}: {}", GetEncodingName( encoding ), e.what() );
         return false;
     }
 }
+
+NetworkDataEncoding NetworkDataSystem::GetEncoding() const
+{
+    const int value = static_cast<int>( m_Encoding->value );
+
+    if( value < static_cast<int>( NetworkDataEncoding::Json ) || value > static_cast<int>( NetworkDataEncoding::Cbor ) )
+    {
+        m_Logger->warn( "Invalid network data encoding {}, using MessagePack", value );
+        return NetworkDataEncoding::MessagePack;
+    }
+
+    return static_cast<NetworkDataEncoding>( value );
+}
 #else
 const std::regex VersionRegex{R"(^(\d+)\.(\d+)\.(\d+)$)"};
 
+/**
+ *    @brief Decodes network data in any of the supported encodings.
+ *    @exception std::exception If the data is invalid.
+ */
+static json DecodeNetworkData( const std::vector<std::uint8_t>& fileData, NetworkDataEncoding& encoding )
+{
+    if( fileData.size() < BinaryHeaderSize || !std::equal( BinaryMagic.begin(), BinaryMagic.end(), fileData.begin() ) )
+    {
+        encoding = NetworkDataEncoding::Json;
+        return json::parse( fileData );
+    }
+
+    if( fileData[4] != BinaryFormatVersion )
+    {
+        throw std::runtime_error( fmt::format( "Unsupported binary format version {} (expected {})", fileData[4], BinaryFormatVersion ) );
+    }
+
+    if( fileData[6] != static_cast<std::uint8_t>( NetworkDataCompression::None ) )
+    {
+        throw std::runtime_error( fmt::format( "Unsupported compression type {}", fileData[6] ) );
+    }
+
+    std::uint32_t payloadSize = 0;
+
+    for( std::size_t i = 0; i < sizeof( payloadSize ); ++i )
+    {
+        payloadSize |= static_cast<std::uint32_t>( fileData[8 + i] ) << ( i * 8 );
+    }
+
+    if( payloadSize > fileData.size() - BinaryHeaderSize )
+    {
+        throw std::runtime_error( fmt::format( "Payload size {} exceeds file size {}", payloadSize, fileData.size() ) );
+    }
+
+    const auto begin = fileData.begin() + BinaryHeaderSize;
+    const auto end = begin + payloadSize;
+
+    switch( static_cast<NetworkDataEncoding>( fileData[5] ) )
+    {
+    case NetworkDataEncoding::MessagePack:
+        encoding = NetworkDataEncoding::MessagePack;
+        return json::from_msgpack( begin, end );
+
+    case NetworkDataEncoding::Cbor:
+        encoding = NetworkDataEncoding::Cbor;
+        return json::from_cbor( begin, end );
+
+    default:
+        throw std::runtime_error( fmt::format( "Unsupported encoding {}", fileData[5] ) );
+    }
+}
+
 bool NetworkDataSystem::TryLoadNetworkDataFile()
 {
     const auto fileData = TryLoadDataFromFile( NetworkDataFileName );
@@ -263,7 +421,26 @@ std::optional<std::vector<std::uint8_t>> NetworkDataSystem::TryLoadDataFromFile(
 
 bool NetworkDataSystem::TryParseNetworkData( const std::vector<std::uint8_t>& fileData )
 {
-    json input = json::parse( fileData );
+    const auto parseStart = std::chrono::high_resolution_clock::now();
+
+    json input;
+    NetworkDataEncoding encoding{};
+
+    try
+    {
+        input = DecodeNetworkData( fileData, encoding );
+    }
+    catch ( const std::exception& e )
+    {
+        m_Logger->error( R"(Error loading network data: Network data could not be decoded
+    Reason: {})",
+            e.what() );
+        return false;
+    }
+
+    const auto processStart = std::chrono::high_resolution_clock::now();
+
+    m_Logger->debug( "Network data parsed in {:.3f} ms ({})", ToMilliseconds( processStart - parseStart ), GetEncodingName( encoding ) );
 
     if( !input.is_object() )
     {
@@ -425,6 +602,8 @@ bool NetworkDataSystem::TryParseNetworkData( const std::vector<std::uint8_t>& fi
         consumer.Handler->OnEndNetworkDataProcessing();
     }
 
+    m_Logger->debug( "Network data processed in {:.3f} ms", ToMilliseconds( std::chrono::high_resolution_clock::now() - processStart ) );
+
     return success;
 }
 
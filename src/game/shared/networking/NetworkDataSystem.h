@@ -28,6 +28,8 @@
 #include "utils/GameSystem.h"
 #include "utils/JSONSystem.h"
 
+struct cvar_t;
+
 /**
  *    @brief Version of the network data protocol.
  *    Used to verify that the server and client are using the same version.
@@ -83,6 +85,17 @@ public:
     virtual void HandleNetworkDataBlock( NetworkDataBlock& block ) = 0;
 };
 
+/**
+ *    @brief Encodings the network data file can use.
+ *    Binary encodings are much faster to generate and parse and produce smaller files. JSON is useful for debugging.
+ */
+enum class NetworkDataEncoding : std::uint8_t
+{
+    Json = 0,
+    MessagePack,
+    Cbor
+};
+
 /**
  *    @brief Handles the generation, transfer and deserialization of network data sent using a file.
  */
@@ -119,6 +132,8 @@ public:
 private:
     std::optional<json> TryGenerateNetworkData();
     bool TryWriteNetworkDataFile( const std::string& fileName, const json& output );
+
+    NetworkDataEncoding GetEncoding() const;
 #else
     bool TryLoadNetworkDataFile();
 
@@ -130,6 +145,10 @@ private:
 private:
     std::shared_ptr<spdlog::logger> m_Logger;
     std::vector<HandlerData> m_Handlers;
+
+#ifndef CLIENT_DLL
+    cvar_t* m_Encoding{};
+#endif
 };
 
 inline NetworkDataSystem g_NetworkData;
@@ -2919,7 +2919,9 @@ void PM_PlayerMove( qboolean server )
         return;
     }
 
-    if( !g_cfg.GetValue<bool>( "player_collision"sv, true ) && pmove->dead == 0 && pmove->deadflag == DEAD_NO )
+    static const ConfigVarHandle PlayerCollision{"player_collision"sv};
+
+    if( !g_cfg.GetValue<bool>( PlayerCollision, true ) && pmove->dead == 0 && pmove->deadflag == DEAD_NO )
     {
         int numphysent = -1;
 
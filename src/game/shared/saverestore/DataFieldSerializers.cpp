@@ -13,10 +13,23 @@
  *
  ****/
 
+#include <algorithm>
+
 #include "cbase.h"
 #include "DataFieldSerializers.h"
 #include "DataMap.h"
 
+bool IDataFieldSerializer::IsEmpty( const std::byte* fields, std::size_t count ) const
+{
+    return std::all_of( fields, fields + count * GetFieldSize(), []( std::byte value )
+        { return value == std::byte{0}; } );
+}
+
+void IDataFieldSerializer::Clear( std::byte* fields, std::size_t count ) const
+{
+    std::memset( fields, 0, count * GetFieldSize() );
+}
+
 void DataFieldTimeSerializer::Serialize( CSave& save, const std::byte* fields, std::size_t count ) const
 {
     auto values = reinterpret_cast<float*>( save.GetWriteAddress() );
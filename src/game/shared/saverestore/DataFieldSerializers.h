@@ -40,6 +40,16 @@ public:
      *    @brief Reads fields from the buffer and writes them to the destination.
      */
     virtual void Deserialize( CRestore& restore, std::byte* fields, std::size_t count ) const = 0;
+
+    /**
+     *    @brief Returns whether the fields are all zero. Empty fields are not saved.
+     */
+    virtual bool IsEmpty( const std::byte* fields, std::size_t count ) const;
+
+    /**
+     *    @brief Resets the fields to zero before they are restored.
+     */
+    virtual void Clear( std::byte* fields, std::size_t count ) const;
 };
 
 /**
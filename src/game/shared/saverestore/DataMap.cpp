@@ -13,9 +13,114 @@
  *
  ****/
 
+#include <bit>
+#include <cctype>
+
 #include "cbase.h"
 #include "DataMap.h"
 
+DataFieldLookup::DataFieldLookup( std::span<const DataMember> members )
+{
+    int fieldCount = 0;
+
+    for( const auto& member : members )
+    {
+        if( std::holds_alternative<DataFieldDescription>( member ) )
+        {
+            ++fieldCount;
+        }
+    }
+
+    if( fieldCount == 0 )
+    {
+        return;
+    }
+
+    // Keep at least half of the slots empty.
+    m_Slots.resize( std::bit_ceil( static_cast<unsigned int>( fieldCount * 2 ) ) );
+
+    const unsigned int mask = m_Slots.size() - 1;
+
+    for( std::size_t i = 0; i < members.size(); ++i )
+    {
+        auto field = std::get_if<DataFieldDescription>( &members[i] );
+
+        if( !field || !field->fieldName )
+        {
+            continue;
+        }
+
+        const unsigned int hash = HashFieldName( field->fieldName );
+
+        unsigned int slot = hash & mask;
+
+        while( m_Slots[slot].Index != -1 )
+        {
+            slot = ( slot + 1 ) & mask;
+        }
+
+        m_Slots[slot] = Slot{hash, static_cast<int>( i )};
+    }
+}
+
+unsigned int DataFieldLookup::HashFieldName( const char* fieldName )
+{
+    // FNV-1a on the lowercase name since field names are compared case-insensitively.
+    unsigned int hash = 2166136261u;
+
+    for( ; '\0' != *fieldName; ++fieldName )
+    {
+        hash ^= static_cast<unsigned char>( std::tolower( static_cast<unsigned char>( *fieldName ) ) );
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+int DataFieldLookup::Find( std::span<const DataMember> members, const char* fieldName, int startField ) const
+{
+    if( m_Slots.empty() )
+    {
+        return -1;
+    }
+
+    const unsigned int hash = HashFieldName( fieldName );
+    const unsigned int mask = m_Slots.size() - 1;
+
+    // Match the original rotating search: the first match at or after startField wins, otherwise the first match overall.
+    const int start = startField % static_cast<int>( members.size() );
+
+    int best = -1;
+    int bestDistance = 0;
+
+    for( unsigned int slot = hash & mask; m_Slots[slot].Index != -1; slot = ( slot + 1 ) & mask )
+    {
+        const auto& entry = m_Slots[slot];
+
+        if( entry.Hash != hash )
+        {
+            continue;
+        }
+
+        const auto& field = std::get<DataFieldDescription>( members[entry.Index] );
+
+        if( stricmp( field.fieldName, fieldName ) != 0 )
+        {
+            continue;
+        }
+
+        const int distance = ( entry.Index - start + static_cast<int>( members.size() ) ) % static_cast<int>( members.size() );
+
+        if( best == -1 || distance < bestDistance )
+        {
+            best = entry.Index;
+            bestDistance = distance;
+        }
+    }
+
+    return best;
+}
+
 BASEPTR DataMap_FindFunctionAddress( const DataMap& dataMap, const char* name )
 {
     for( auto map = &dataMap; map; map = map->BaseMap )
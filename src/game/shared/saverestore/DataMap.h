@@ -20,6 +20,7 @@
 #include <string>
 #include <type_traits>
 #include <variant>
+#include <vector>
 
 #include "Platform.h"
 #include "ClassData.h"
@@ -183,6 +184,37 @@ struct DataFunctionDescription
 
 using DataMember = std::variant<DataFieldDescription, DataFunctionDescription>;
 
+/**
+ *    @brief Case-insensitive hash table mapping field names to their index in a data map's member list.
+ */
+class DataFieldLookup final
+{
+public:
+    DataFieldLookup() = default;
+    explicit DataFieldLookup( std::span<const DataMember> members );
+
+    bool IsEmpty() const { return m_Slots.empty(); }
+
+    /**
+     *    @brief Finds the field named @p fieldName.
+     *    If multiple fields share the name, returns the first one at or after @p startField, wrapping around to the start.
+     *    @return Index of the field in @p members, or -1 if there is no such field.
+     */
+    int Find( std::span<const DataMember> members, const char* fieldName, int startField ) const;
+
+private:
+    static unsigned int HashFieldName( const char* fieldName );
+
+    struct Slot
+    {
+        unsigned int Hash = 0;
+        int Index = -1;
+    };
+
+    // Size is always a power of 2.
+    std::vector<Slot> m_Slots;
+};
+
 /**
  *    @brief Stores a list of type descriptions and a reference to a base class data map.
  */
@@ -196,6 +228,11 @@ struct DataMap final
     const DataMap* BaseMap{};
 
     std::span<const DataMember> Members;
+
+    /**
+     *    @brief Built along with the data map so restoring can find fields without searching @c Members.
+     */
+    DataFieldLookup FieldLookup;
 };
 
 #define DECLARE_DATAMAP_COMMON()             \
@@ -291,7 +328,8 @@ public:                                      \
     return {                                                   \
         .ClassName{className},                                 \
         .BaseMap{ThisClass::GetBaseMap()},                     \
-        .Members{std::begin( members ), std::end( members ) - 1}}; \
+        .Members{std::begin( members ), std::end( members ) - 1}, \
+        .FieldLookup = DataFieldLookup{{std::begin( members ), std::end( members ) - 1}}}; \
     }
 
 #define DEFINE_DUMMY_DATAMAP(thisClass) \
@@ -313,6 +351,10 @@ public:                                      \
 #define DEFINE_GLOBAL_FIELD(fieldName, fieldType) \
     RAW_DEFINE_FIELD( fieldName, fieldType, &FieldTypeToSerializerMapper<fieldType>::Serializer, 1, FTYPEDESC_GLOBAL )
 
+// For types with their own serializer. The field type is only used to parse entvars keyvalues.
+#define DEFINE_CUSTOM_FIELD(fieldName, serializer) \
+    RAW_DEFINE_FIELD( fieldName, FIELD_CHARACTER, &serializer, 1, 0 )
+
 // Normally, converting one pointer to member function type to another is not allowed.
 // Converting a pointer to pointer does work, so this works as expected on the platforms we support.
 template <typename TFunctionPointer>
@@ -13,7 +13,10 @@
  *
  ****/
 
+#include <algorithm>
 #include <bit>
+#include <string>
+#include <vector>
 
 #include "cbase.h"
 #include "DataMap.h"
@@ -94,12 +97,215 @@ unsigned int CSaveRestoreBuffer::HashString( const char* pszToken )
     return hash;
 }
 
+namespace
+{
+/**
+ *    @brief Game side hash index of the engine's token table.
+ *    @details The engine owns the token array and its size, so tokens are still placed where the original probing would
+ *    put them to keep save files identical. Lookups go through this index instead of probing the engine's table.
+ *    The index is rebuilt whenever the engine hands us a different table.
+ */
+class TokenTableIndex final
+{
+public:
+    void Sync( SAVERESTOREDATA& data );
+
+    int Find( const char* token, unsigned int hash );
+
+    void Add( const char* token, unsigned int hash, int index );
+
+    bool HasActivity() const { return m_HasActivity; }
+
+    /**
+     *    @brief Whether a token could not be added because the engine's table is full.
+     *    Stays set until the engine hands us a different table.
+     */
+    bool IsFull( const SAVERESTOREDATA& data ) const { return m_Full && &data == m_Data && data.pTokens == m_Tokens; }
+
+    /**
+     *    @brief Marks the table as full.
+     *    @return Whether it was already marked.
+     */
+    bool SetFull();
+
+    void LogStats( spdlog::logger& logger );
+
+private:
+    struct Slot
+    {
+        unsigned int Hash = 0;
+        int Index = -1;
+    };
+
+    void Rebuild( SAVERESTOREDATA& data );
+
+    void Insert( unsigned int hash, int index );
+
+    void SetSentinel( int index );
+
+    const SAVERESTOREDATA* m_Data{};
+    char** m_Tokens{};
+    int m_TokenCount = 0;
+
+    // Size is always a power of 2.
+    std::vector<Slot> m_Slots;
+
+    int m_Used = 0;
+    int m_MaxProbe = 0;
+    bool m_HasActivity = false;
+    bool m_Full = false;
+
+    // Used to detect a new table allocated at the same address as the old one.
+    int m_SentinelIndex = -1;
+    const char* m_SentinelPointer{};
+    std::string m_SentinelToken;
+};
+
+static TokenTableIndex g_TokenTableIndex;
+
+void TokenTableIndex::Sync( SAVERESTOREDATA& data )
+{
+    m_HasActivity = true;
+
+    // An empty index is always rebuilt since there's no sentinel to check; this only happens before the first token is added.
+    if( &data == m_Data && data.pTokens == m_Tokens && data.tokenCount == m_TokenCount && m_SentinelIndex != -1 )
+    {
+        if( m_Tokens[m_SentinelIndex] == m_SentinelPointer && m_SentinelToken == m_SentinelPointer )
+        {
+            return;
+        }
+    }
+
+    Rebuild( data );
+}
+
+void TokenTableIndex::Rebuild( SAVERESTOREDATA& data )
+{
+    m_Data = &data;
+    m_Tokens = data.pTokens;
+    m_TokenCount = data.tokenCount;
+
+    m_Slots.assign( std::bit_ceil( static_cast<unsigned int>( m_TokenCount * 2 ) ), Slot{} );
+    m_Used = 0;
+    m_MaxProbe = 0;
+    m_Full = false;
+    m_SentinelIndex = -1;
+    m_SentinelPointer = nullptr;
+    m_SentinelToken.clear();
+
+    // Pick up tokens loaded from a save game.
+    for( int i = 0; i < m_TokenCount; ++i )
+    {
+        if( const char* token = m_Tokens[i]; token )
+        {
+            const unsigned int hash = CSaveRestoreBuffer::HashString( token );
+
+            // Keep the first occurrence like the original probing would.
+            if( Find( token, hash ) == -1 )
+            {
+                Insert( hash, i );
+            }
+        }
+    }
+
+    if( m_Used > 0 )
+    {
+        for( int i = 0; i < m_TokenCount; ++i )
+        {
+            if( m_Tokens[i] )
+            {
+                SetSentinel( i );
+                break;
+            }
+        }
+    }
+}
+
+int TokenTableIndex::Find( const char* token, unsigned int hash )
+{
+    const unsigned int mask = m_Slots.size() - 1;
+
+    int probe = 0;
+
+    for( unsigned int slot = hash & mask; m_Slots[slot].Index != -1; slot = ( slot + 1 ) & mask, ++probe )
+    {
+        const auto& entry = m_Slots[slot];
+
+        if( entry.Hash == hash && strcmp( m_Tokens[entry.Index], token ) == 0 )
+        {
+            m_MaxProbe = std::max( m_MaxProbe, probe );
+            return entry.Index;
+        }
+    }
+
+    m_MaxProbe = std::max( m_MaxProbe, probe );
+
+    return -1;
+}
+
+void TokenTableIndex::Insert( unsigned int hash, int index )
+{
+    const unsigned int mask = m_Slots.size() - 1;
+
+    unsigned int slot = hash & mask;
+
+    while( m_Slots[slot].Index != -1 )
+    {
+        slot = ( slot + 1 ) & mask;
+    }
+
+    m_Slots[slot] = Slot{hash, index};
+    ++m_Used;
+}
+
+void TokenTableIndex::Add( const char* token, unsigned int hash, int index )
+{
+    m_Tokens[index] = const_cast<char*>( token );
+    Insert( hash, index );
+    SetSentinel( index );
+}
+
+bool TokenTableIndex::SetFull()
+{
+    const bool wasFull = m_Full;
+    m_Full = true;
+    return wasFull;
+}
+
+void TokenTableIndex::SetSentinel( int index )
+{
+    m_SentinelIndex = index;
+    m_SentinelPointer = m_Tokens[index];
+    m_SentinelToken = m_SentinelPointer;
+}
+
+void TokenTableIndex::LogStats( spdlog::logger& logger )
+{
+    if( !m_HasActivity )
+    {
+        return;
+    }
+
+    m_HasActivity = false;
+
+    if( m_TokenCount > 0 )
+    {
+        logger.debug( "Token table: {} of {} tokens used (load factor {:.2f}), max probe length {}",
+            m_Used, m_TokenCount, static_cast<float>( m_Used ) / m_TokenCount, m_MaxProbe );
+    }
+}
+}
+
+void CSaveRestoreBuffer::LogTokenTableStats()
+{
+    if( Logger )
+    {
+        g_TokenTableIndex.LogStats( *Logger );
+    }
+}
+
 unsigned short CSaveRestoreBuffer::TokenHash( const char* pszToken )
 {
-#if _DEBUG
-    static int tokensparsed = 0;
-    tokensparsed++;
-#endif
     if( 0 == m_data.tokenCount || nullptr == m_data.pTokens )
     {
         // if we're here it means trigger_changelevel is trying to actually save something when it's not supposed to.
@@ -107,36 +313,48 @@ unsigned short CSaveRestoreBuffer::TokenHash( const char* pszToken )
         return 0;
     }
 
-    const unsigned short hash = (unsigned short)( HashString( pszToken ) % ( unsigned )m_data.tokenCount );
+    g_TokenTableIndex.Sync( m_data );
 
-    for( int i = 0; i < m_data.tokenCount; i++ )
+    const unsigned int fullHash = HashString( pszToken );
+
+    if( const int index = g_TokenTableIndex.Find( pszToken, fullHash ); index != -1 )
     {
-#if _DEBUG
-        static bool beentheredonethat = false;
-        if( i > 50 && !beentheredonethat )
-        {
-            beentheredonethat = true;
-            Logger->error( "CSaveRestoreBuffer :: TokenHash() is getting too full!" );
-        }
-#endif
+        return index;
+    }
 
+    // Place new tokens where the original linear probing would so the table layout is unchanged.
+    const unsigned short hash = (unsigned short)( fullHash % ( unsigned )m_data.tokenCount );
+
+    for( int i = 0; i < m_data.tokenCount; i++ )
+    {
         int index = hash + i;
         if( index >= m_data.tokenCount )
             index -= m_data.tokenCount;
 
-        if( !m_data.pTokens[index] || strcmp( pszToken, m_data.pTokens[index] ) == 0 )
+        if( !m_data.pTokens[index] )
         {
-            m_data.pTokens[index] = (char*)pszToken;
+            g_TokenTableIndex.Add( pszToken, fullHash, index );
             return index;
         }
     }
 
     // Token hash table full!!!
-    // [Consider doing overflow table(s) after the main table & limiting linear hash table search]
-    Logger->error( "CSaveRestoreBuffer :: TokenHash() is COMPLETELY FULL!" );
+    // The engine allocates this table so it can't be grown from here. Nothing is added to the index for this token,
+    // and the table is flagged so saves stop writing and report the failure instead of writing fields with a bogus token.
+    if( !g_TokenTableIndex.SetFull() )
+    {
+        Logger->error( "CSaveRestoreBuffer :: TokenHash() is COMPLETELY FULL! ({} tokens) Unable to add \"{}\"",
+            m_data.tokenCount, pszToken );
+    }
+
     return 0;
 }
 
+bool CSaveRestoreBuffer::IsTokenTableFull() const
+{
+    return g_TokenTableIndex.IsFull( m_data );
+}
+
 bool CSaveRestoreBuffer::IsValidSaveRestoreData( SAVERESTOREDATA* data )
 {
     const bool isValid = nullptr != data && nullptr != data->pTokens && data->tokenCount > 0;
@@ -178,11 +396,18 @@ bool CSave::WriteFields( void* baseData, const DataMap& completeDataMap, const D
             continue;
         }
 
-        if( DataEmpty( fields, field->fieldSize * serializer->GetFieldSize() ) )
+        if( serializer->IsEmpty( fields, field->fieldSize ) )
             continue;
 
         auto fieldSize = WriteHeader( field->fieldName, 0 );
 
+        if( IsTokenTableFull() )
+        {
+            m_CurrentDataMap = nullptr;
+            m_CurrentCompleteDataMap = nullptr;
+            return false;
+        }
+
         const auto startPosition = m_data.pCurrentData;
 
         serializer->Serialize( *this, fields, field->fieldSize );
@@ -208,6 +433,11 @@ std::byte* CSave::WriteBytes( const std::byte* bytes, std::size_t sizeInBytes )
 {
     const int size = int( sizeInBytes );
 
+    if( IsTokenTableFull() )
+    {
+        return nullptr;
+    }
+
     if( m_data.size + size > m_data.bufferSize )
     {
         Logger->error( "Save/Restore overflow!" );
@@ -225,7 +455,7 @@ std::byte* CSave::WriteBytes( const std::byte* bytes, std::size_t sizeInBytes )
 
 bool CSave::HasOverflowed() const
 {
-    return m_data.size >= m_data.bufferSize;
+    return m_data.size >= m_data.bufferSize || IsTokenTableFull();
 }
 
 short* CSave::WriteHeader( const char* name, short size )
@@ -255,16 +485,6 @@ void CSave::WriteCount( short* destination, int count )
     *destination = count;
 }
 
-bool CSave::DataEmpty( const std::byte* pdata, int size )
-{
-    for( int i = 0; i < size; i++ )
-    {
-        if( std::byte{0} != pdata[i] )
-            return false;
-    }
-    return true;
-}
-
 bool CRestore::ReadFields( void* baseData, const DataMap& completeDataMap, const DataMap& currentDataMap )
 {
     const int headerSize = BufferReadValue<short>();
@@ -310,8 +530,7 @@ bool CRestore::ReadFields( void* baseData, const DataMap& completeDataMap, const
                 continue;
             }
 
-            std::memset( reinterpret_cast<std::byte*>( baseData ) + field->fieldOffset, 0,
-                field->fieldSize * serializer->GetFieldSize() );
+            serializer->Clear( reinterpret_cast<std::byte*>( baseData ) + field->fieldOffset, field->fieldSize );
         }
     }
 
@@ -332,47 +551,39 @@ bool CRestore::ReadFields( void* baseData, const DataMap& completeDataMap, const
 
 int CRestore::ReadField( void* baseData, const DataMap& dataMap, const char* fieldName, int startField, std::byte* data, int size )
 {
-    for( std::size_t i = 0; i < dataMap.Members.size(); ++i )
+    const int fieldNumber = dataMap.FieldLookup.Find( dataMap.Members, fieldName, startField );
+
+    if( fieldNumber == -1 )
     {
-        const int fieldNumber = ( i + startField ) % int( dataMap.Members.size() );
-        const auto& member = dataMap.Members[fieldNumber];
+        return -1;
+    }
 
-        auto field = std::get_if<DataFieldDescription>( &member );
+    const auto& field = std::get<DataFieldDescription>( dataMap.Members[fieldNumber] );
 
-        if( !field )
-        {
-            continue;
-        }
+    if( !m_global || ( field.flags & FTYPEDESC_GLOBAL ) == 0 )
+    {
+        auto serializer = field.Serializer;
 
-        if( !stricmp( field->fieldName, fieldName ) )
+        if( !serializer )
         {
-            if( !m_global || ( field->flags & FTYPEDESC_GLOBAL ) == 0 )
-            {
-                auto serializer = field->Serializer;
-
-                if( !serializer )
-                {
-                    Logger->error( "Bad field type" );
-                    continue;
-                }
+            Logger->error( "Bad field type" );
+            return -1;
+        }
 
-                m_ReadStartAddress = m_ReadAddress = data;
-                m_ReadSize = size;
-                m_HasOverflowed = false;
+        m_ReadStartAddress = m_ReadAddress = data;
+        m_ReadSize = size;
+        m_HasOverflowed = false;
 
-                serializer->Deserialize( *this, reinterpret_cast<std::byte*>( baseData ) + field->fieldOffset, field->fieldSize );
-            }
+        serializer->Deserialize( *this, reinterpret_cast<std::byte*>( baseData ) + field.fieldOffset, field.fieldSize );
+    }
 #if 0
-            else
-            {
-                Logger->debug( "Skipping global field {}", pName );
-            }
-#endif
-            return fieldNumber;
-        }
+    else
+    {
+        Logger->debug( "Skipping global field {}", pName );
     }
+#endif
 
-    return -1;
+    return fieldNumber;
 }
 
 void CRestore::BufferReadHeader( HEADER& header )
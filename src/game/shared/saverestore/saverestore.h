@@ -43,6 +43,19 @@ public:
 
     unsigned short TokenHash( const char* pszToken );
 
+    /**
+     *    @brief Whether a token could not be added to the engine's token table.
+     *    Nothing is written to a save once this happens since the field names can't be stored.
+     */
+    bool IsTokenTableFull() const;
+
+    static unsigned int HashString( const char* pszToken );
+
+    /**
+     *    @brief Logs token table usage if a save or restore happened since the last call.
+     */
+    static void LogTokenTableStats();
+
     const SAVERESTOREDATA& GetData() const { return m_data; }
 
     // Data is only valid if it's a valid pointer and if it has a token list
@@ -55,7 +68,6 @@ public:
 protected:
     SAVERESTOREDATA& m_data;
     void BufferRewind( int size );
-    unsigned int HashString( const char* pszToken );
 
 protected:
     const DataMap* m_CurrentCompleteDataMap{};
@@ -85,8 +97,6 @@ public:
 private:
     short* WriteHeader( const char* name, short size );
     void WriteCount( short* destination, int count );
-
-    static bool DataEmpty( const std::byte* pdata, int size );
 };
 
 struct HEADER
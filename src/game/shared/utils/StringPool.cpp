@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <functional>
+
 #include "cbase.h"
 
 #include "StringPool.h"
@@ -18,19 +21,104 @@ const char* StringPool::Allocate( const char* string )
 
 const char* StringPool::Allocate( std::string_view string )
 {
-    if( auto it = m_Pool.find( string ); it != m_Pool.end() )
+    ++m_Stats.Lookups;
+
+    // Keep the load factor at or below 1/2 so probe sequences stay short.
+    if( ( m_Stats.StringCount + 1 ) * 2 > m_Table.size() )
     {
-        return it->second.get();
+        GrowTable();
+    }
+
+    const std::size_t hash = std::hash<std::string_view>{}( string );
+    const std::size_t mask = m_Table.size() - 1;
+
+    std::size_t index = hash & mask;
+
+    while( m_Table[index].String )
+    {
+        const auto& slot = m_Table[index];
+
+        if( slot.Hash == hash && std::string_view{slot.String, slot.Length} == string )
+        {
+            ++m_Stats.Hits;
+            return slot.String;
+        }
+
+        index = ( index + 1 ) & mask;
     }
 
-    auto destination{std::make_unique<char[]>( string.size() + 1 )};
+    char* destination = AllocateBytes( string.size() + 1 );
 
-    std::strncpy( destination.get(), string.data(), string.size() );
+    std::memcpy( destination, string.data(), string.size() );
     destination[string.size()] = '\0';
 
-    const std::string_view key{destination.get(), string.size()};
+    m_Table[index] = Slot{destination, string.size(), hash};
+
+    ++m_Stats.StringCount;
+
+    return destination;
+}
+
+void StringPool::Reset()
+{
+    std::fill( m_Table.begin(), m_Table.end(), Slot{} );
+
+    m_CurrentBlock = 0;
+    m_BlockOffset = 0;
+
+    m_Stats.BytesUsed = 0;
+    m_Stats.StringCount = 0;
+    m_Stats.Lookups = 0;
+    m_Stats.Hits = 0;
+}
+
+char* StringPool::AllocateBytes( std::size_t size )
+{
+    // Find a block with enough room, reusing blocks left over from before the last reset.
+    while( m_CurrentBlock < m_Blocks.size() && m_BlockOffset + size > m_Blocks[m_CurrentBlock].Size )
+    {
+        ++m_CurrentBlock;
+        m_BlockOffset = 0;
+    }
+
+    if( m_CurrentBlock == m_Blocks.size() )
+    {
+        // Strings larger than a block get a block of their own.
+        const std::size_t blockSize = std::max( BlockSize, size );
+        m_Blocks.push_back( Block{std::make_unique<char[]>( blockSize ), blockSize} );
+        m_Stats.BytesReserved += blockSize;
+    }
+
+    char* data = m_Blocks[m_CurrentBlock].Data.get() + m_BlockOffset;
+
+    m_BlockOffset += size;
+    m_Stats.BytesUsed += size;
+
+    return data;
+}
+
+void StringPool::GrowTable()
+{
+    std::vector<Slot> table( std::max( InitialTableSize, m_Table.size() * 2 ) );
 
-    m_Pool.emplace( key, std::move( destination ) );
+    const std::size_t mask = table.size() - 1;
+
+    for( const auto& slot : m_Table )
+    {
+        if( !slot.String )
+        {
+            continue;
+        }
+
+        std::size_t index = slot.Hash & mask;
+
+        while( table[index].String )
+        {
+            index = ( index + 1 ) & mask;
+        }
+
+        table[index] = slot;
+    }
 
-    return key.data();
+    m_Table = std::move( table );
 }
@@ -1,12 +1,28 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 
+/**
+ *    @brief Interns strings in large blocks of memory so each distinct string is stored once.
+ *    @details Strings are bump-allocated from chunked blocks and looked up through an open addressing hash table.
+ *    Pointers stay valid until @c Reset is called.
+ */
 class StringPool final
 {
 public:
+    struct Stats
+    {
+        std::size_t BytesUsed = 0;
+        std::size_t BytesReserved = 0;
+        std::size_t StringCount = 0;
+        std::uint64_t Lookups = 0;
+        std::uint64_t Hits = 0;
+    };
+
     StringPool() = default;
     ~StringPool() = default;
 
@@ -20,6 +36,41 @@ public:
 
     const char* Allocate( std::string_view string );
 
+    /**
+     *    @brief Forgets all strings. The memory blocks are kept and reused for the next set of strings.
+     */
+    void Reset();
+
+    const Stats& GetStats() const { return m_Stats; }
+
 private:
-    std::unordered_map<std::string_view, std::unique_ptr<char[]>> m_Pool;
+    static constexpr std::size_t BlockSize = 64 * 1024;
+    static constexpr std::size_t InitialTableSize = 4096;
+
+    struct Block
+    {
+        std::unique_ptr<char[]> Data;
+        std::size_t Size = 0;
+    };
+
+    struct Slot
+    {
+        const char* String = nullptr;
+        std::size_t Length = 0;
+        std::size_t Hash = 0;
+    };
+
+    char* AllocateBytes( std::size_t size );
+
+    void GrowTable();
+
+private:
+    std::vector<Block> m_Blocks;
+    std::size_t m_CurrentBlock = 0;
+    std::size_t m_BlockOffset = 0;
+
+    // Size is always a power of 2.
+    std::vector<Slot> m_Table;
+
+    Stats m_Stats;
 };
@@ -111,8 +111,20 @@ string_t ALLOC_ESCAPED_STRING( const char* str )
 
 void ClearStringPool()
 {
-    // This clears the pool and frees memory
-    g_StringPool = StringPool{};
+    // Keeps the pool's memory around so the next map can reuse it.
+    g_StringPool.Reset();
+}
+
+void PrintStringPoolStats()
+{
+    const auto& stats = g_StringPool.GetStats();
+
+    const double hitRate = stats.Lookups > 0 ? ( static_cast<double>( stats.Hits ) / stats.Lookups ) * 100.0 : 0.0;
+
+    Con_Printf( "String pool: %zu strings, %zu bytes used, %zu bytes reserved\n",
+        stats.StringCount, stats.BytesUsed, stats.BytesReserved );
+    Con_Printf( "%llu lookups, %llu hits (%.1f%%)\n",
+        static_cast<unsigned long long>( stats.Lookups ), static_cast<unsigned long long>( stats.Hits ), hitRate );
 }
 
 static bool g_PrintBufferingEnabled = false;
@@ -114,6 +114,11 @@ string_t ALLOC_ESCAPED_STRING( const char* str );
 
 void ClearStringPool();
 
+/**
+ *    @brief Prints string pool memory usage and lookup counters to the console.
+ */
+void PrintStringPoolStats();
+
 bool Con_IsPrintBufferingEnabled();
 
 void Con_SetPrintBufferingEnabled( bool enabled );
@@ -8,23 +8,51 @@
  *
  ****/
 
+#include <atomic>
+#include <mutex>
+
 #include "cmdlib.h"
 #define NO_THREAD_NAMES
 #include "threads.h"
 
 #define MAX_THREADS 64
 
-int dispatch;
+std::atomic<int> dispatch;
 int workcount;
-int oldf;
+std::atomic<int> oldf;
 qboolean pacifier;
 
 qboolean threaded;
 
+// Only taken when the pacifier advances, so threads print each step once and in order.
+static std::mutex pacifierlock;
+
+/*
+=============
+UpdatePacifier
+
+=============
+*/
+static void UpdatePacifier(int f)
+{
+	std::lock_guard<std::mutex> guard(pacifierlock);
+
+	if (f <= oldf)
+		return;
+
+	oldf = f;
+	if (pacifier)
+	{
+		printf("%i...", f);
+		fflush(stdout);
+	}
+}
+
 /*
 =============
 GetThreadWork
 
+Work items are handed out with an atomic counter, so this doesn't take the thread lock.
 =============
 */
 int GetThreadWork(void)
@@ -32,25 +60,14 @@ int GetThreadWork(void)
 	int r;
 	int f;
 
-	ThreadLock();
+	r = dispatch.fetch_add(1);
 
-	if (dispatch == workcount)
-	{
-		ThreadUnlock();
+	if (r >= workcount)
 		return -1;
-	}
 
-	f = 10 * dispatch / workcount;
-	if (f != oldf)
-	{
-		oldf = f;
-		if (pacifier)
-			printf("%i...", f);
-	}
-
-	r = dispatch;
-	dispatch++;
-	ThreadUnlock();
+	f = 10 * r / workcount;
+	if (f > oldf.load(std::memory_order_relaxed))
+		UpdatePacifier(f);
 
 	return r;
 }
@@ -276,28 +293,51 @@ void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int))
 #endif
 
 /*
-=======================================================================
+===================================================================
+
+STD::THREAD
 
-  SINGLE THREAD
+Used on every other platform. -threads N sets the number of threads,
+otherwise one thread is used per hardware thread.
 
-=======================================================================
+===================================================================
 */
 
 #ifndef USED
 
-int numthreads = 1;
+#include <thread>
+#include <vector>
+
+int numthreads = -1;
+static std::mutex crit;
 
 void ThreadSetDefault(void)
 {
-	numthreads = 1;
+	if (numthreads == -1) // not set manually
+	{
+		numthreads = std::thread::hardware_concurrency();
+		if (numthreads < 1)
+			numthreads = 1;
+	}
+
+	if (numthreads > MAX_THREADS)
+		numthreads = MAX_THREADS;
+
+	qprintf("%i threads\n", numthreads);
 }
 
 void ThreadLock(void)
 {
+	if (!threaded)
+		return;
+	crit.lock();
 }
 
 void ThreadUnlock(void)
 {
+	if (!threaded)
+		return;
+	crit.unlock();
 }
 
 /*
@@ -310,16 +350,32 @@ void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int))
 	int i;
 	int start, end;
 
+	start = I_FloatTime();
 	dispatch = 0;
 	workcount = workcnt;
 	oldf = -1;
 	pacifier = showpacifier;
-	start = I_FloatTime();
-#ifdef NeXT
-	if (pacifier)
-		setbuf(stdout, NULL);
-#endif
-	func(0);
+
+	if (numthreads <= 1)
+	{
+		// no need to lock anything
+		func(0);
+	}
+	else
+	{
+		std::vector<std::thread> work_threads;
+		work_threads.reserve(numthreads);
+
+		threaded = true;
+
+		for (i = 0; i < numthreads; i++)
+			work_threads.emplace_back(func, i);
+
+		for (auto& thread : work_threads)
+			thread.join();
+
+		threaded = false;
+	}
 
 	end = I_FloatTime();
 	if (pacifier)
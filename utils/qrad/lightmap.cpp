@@ -1048,17 +1048,75 @@ float r_avertexnormals[NUMVERTEXNORMALS][3] = {
 
 #define VectorMaximum(a) (max((a)[0], max((a)[1], (a)[2])))
 
+// A light that reaches a sample unless something is in the way.
+typedef struct
+{
+	directlight_t* light;
+	vec3_t add;
+	vec3_t stop;
+	int contents; // contents the line from the sample has to end in
+} samplelight_t;
+
+#define MAX_SAMPLE_LIGHTS 32
+
+/*
+=============
+AddSampleLights
+
+Traces the lines to a batch of lights together, then adds the
+visible ones in the order they were found.
+=============
+*/
+void AddSampleLights(vec3_t pos, samplelight_t* lights, int count, vec3_t* sample, byte* styles)
+{
+	vec3_t stops[MAX_SAMPLE_LIGHTS];
+	int results[MAX_SAMPLE_LIGHTS];
+	int i;
+	int style_index;
+	samplelight_t* sl;
+
+	for (i = 0; i < count; i++)
+		VectorCopy(lights[i].stop, stops[i]);
+
+	TestLines(0, pos, stops, count, results);
+
+	for (i = 0, sl = lights; i < count; i++, sl++)
+	{
+		if (results[i] != sl->contents)
+			continue; // occluded
+
+		for (style_index = 0; style_index < MAXLIGHTMAPS; style_index++)
+			if (styles[style_index] == sl->light->style || styles[style_index] == 255)
+				break;
+
+		if (style_index == MAXLIGHTMAPS)
+		{
+			printf("WARNING: Too many direct light styles on a face(%f,%f,%f)\n",
+				pos[0], pos[1], pos[2]);
+			continue;
+		}
+
+		if (styles[style_index] == 255)
+			styles[style_index] = sl->light->style;
+
+		VectorAdd(sample[style_index], sl->add, sample[style_index]);
+	}
+}
+
 void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byte* styles)
 {
 	int i;
 	directlight_t* l;
 	vec3_t add;
 	vec3_t delta;
+	vec3_t stop;
 	float dot, dot2;
 	float dist;
 	float ratio;
 	int style_index;
 	directlight_t* sky_used = NULL;
+	samplelight_t lights[MAX_SAMPLE_LIGHTS];
+	int numlights = 0;
 
 	for (i = 1; i < numleafs; i++)
 	{
@@ -1080,10 +1138,8 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 						continue;
 
 					// search back to see if we can hit a sky brush
-					VectorScale(l->normal, -10000, delta);
-					VectorAdd(pos, delta, delta);
-					if (TestLine_r(0, pos, delta) != CONTENTS_SKY)
-						continue; // occluded
+					VectorScale(l->normal, -10000, stop);
+					VectorAdd(pos, stop, stop);
 
 					VectorScale(l->intensity, dot, add);
 				}
@@ -1129,38 +1185,48 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 
 				if (VectorMaximum(add) > (l->style ? coring : 0))
 				{
-					if (l->type != emittype_t::skylight && TestLine_r(0, pos, l->origin) != CONTENTS_EMPTY)
-						continue; // occluded
+					// the occlusion test is done later with a batch of lights
+					samplelight_t* sl = &lights[numlights++];
 
+					sl->light = l;
+					VectorCopy(add, sl->add);
 
-					for (style_index = 0; style_index < MAXLIGHTMAPS; style_index++)
-						if (styles[style_index] == l->style || styles[style_index] == 255)
-							break;
-
-					if (style_index == MAXLIGHTMAPS)
+					if (l->type == emittype_t::skylight)
 					{
-						printf("WARNING: Too many direct light styles on a face(%f,%f,%f)\n",
-							pos[0], pos[1], pos[2]);
-						continue;
+						VectorCopy(stop, sl->stop);
+						sl->contents = CONTENTS_SKY;
+					}
+					else
+					{
+						VectorCopy(l->origin, sl->stop);
+						sl->contents = CONTENTS_EMPTY;
 					}
 
-					if (styles[style_index] == 255)
-						styles[style_index] = l->style;
-
-					VectorAdd(sample[style_index], add, sample[style_index]);
+					if (numlights == MAX_SAMPLE_LIGHTS)
+					{
+						AddSampleLights(pos, lights, numlights, sample, styles);
+						numlights = 0;
+					}
 				}
 			}
 		}
 	}
+
+	if (numlights > 0)
+		AddSampleLights(pos, lights, numlights, sample, styles);
+
 	if (sky_used && indirect_sun != 0.0)
 	{
 		vec3_t total;
 		int j;
 		vec3_t sky_intensity;
+		vec3_t stops[NUMVERTEXNORMALS];
+		float dots[NUMVERTEXNORMALS];
+		int results[NUMVERTEXNORMALS];
+		int numstops = 0;
 
 		VectorScale(sky_used->intensity, indirect_sun / (NUMVERTEXNORMALS * 2), sky_intensity);
 
-		total[0] = total[1] = total[2] = 0.0;
 		for (j = 0; j < NUMVERTEXNORMALS; j++)
 		{
 			// make sure the angle is okay
@@ -1169,12 +1235,21 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 				continue;
 
 			// search back to see if we can hit a sky brush
-			VectorScale(r_avertexnormals[j], -10000, delta);
-			VectorAdd(pos, delta, delta);
-			if (TestLine_r(0, pos, delta) != CONTENTS_SKY)
+			VectorScale(r_avertexnormals[j], -10000, stops[numstops]);
+			VectorAdd(pos, stops[numstops], stops[numstops]);
+			dots[numstops] = dot;
+			numstops++;
+		}
+
+		TestLines(0, pos, stops, numstops, results);
+
+		total[0] = total[1] = total[2] = 0.0;
+		for (j = 0; j < numstops; j++)
+		{
+			if (results[j] != CONTENTS_SKY)
 				continue; // occluded
 
-			VectorScale(sky_intensity, dot, add);
+			VectorScale(sky_intensity, dots[j], add);
 			VectorAdd(total, add, total);
 		}
 		if (VectorMaximum(total) > 0)
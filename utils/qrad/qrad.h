@@ -147,6 +147,7 @@ void PrecompLightmapOffsets();
 void FinalLightFace(int facenum);
 void PvsForOrigin(vec3_t org, byte* pvs);
 int TestLine_r(int node, vec3_t start, vec3_t stop);
+void TestLines(int node, vec3_t start, vec3_t* stops, int count, int* results);
 void CreateDirectLights(void);
 void DeleteDirectLights(void);
 int ProgressiveRefinement(void);
@@ -12,6 +12,12 @@
 
 #include <stdint.h>
 
+// The packet path has to round like the scalar one, so only use it when scalar float math is done with SSE2 too.
+#if defined(__SSE2_MATH__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRACE_SSE
+#include <emmintrin.h>
+#endif
+
 #include "cmdlib.h"
 #include "mathlib.h"
 #include "bspfile.h"
@@ -30,6 +36,9 @@ typedef struct tnode_s
 
 tnode_t *tnodes, *tnode_p;
 
+// deepest a line can go into the tree, which bounds the trace stacks
+#define MAX_TNODE_DEPTH 1024
+
 /*
 ==============
 MakeTnode
@@ -37,13 +46,16 @@ MakeTnode
 Converts the disk node structure into the efficient tracing structure
 ==============
 */
-void MakeTnode(int nodenum)
+void MakeTnode(int nodenum, int depth)
 {
 	tnode_t* t;
 	dplane_t* plane;
 	int i;
 	dnode_t* node;
 
+	if (depth >= MAX_TNODE_DEPTH)
+		Error("MakeTnode: tree deeper than %i nodes", MAX_TNODE_DEPTH);
+
 	t = tnode_p++;
 
 	node = dnodes + nodenum;
@@ -60,7 +72,7 @@ void MakeTnode(int nodenum)
 		else
 		{
 			t->children[i] = tnode_p - tnodes;
-			MakeTnode(node->children[i]);
+			MakeTnode(node->children[i], depth + 1);
 		}
 	}
 }
@@ -80,7 +92,7 @@ void MakeTnodes()
 	tnodes = (tnode_t*)(((intptr_t)tnodes + 31) & ~31);
 	tnode_p = tnodes;
 
-	MakeTnode(0);
+	MakeTnode(0, 0);
 }
 
 
@@ -119,61 +131,356 @@ int PartialHead(void)
 //==========================================================
 
 
+typedef struct
+{
+	int node;
+	vec3_t stop;
+} linestack_t;
+
+/*
+=============
+TestLine_r
+
+Returns the contents of the first solid or sky leaf the line passes through,
+or CONTENTS_EMPTY. The near side of each split is walked first and the far side
+is kept on a stack. The far side always starts where the near side ended, so
+only its end point needs to be stored.
+=============
+*/
 int TestLine_r(int node, vec3_t start, vec3_t stop)
 {
 	tnode_t* tnode;
 	float front, back;
-	vec3_t mid;
+	vec3_t p1, p2;
 	float frac;
 	int side;
-	int r;
+	linestack_t stack[MAX_TNODE_DEPTH];
+	linestack_t* stack_p;
+
+	VectorCopy(start, p1);
+	VectorCopy(stop, p2);
+	stack_p = stack;
+
+	while (1)
+	{
+		if (node < 0)
+		{
+			if (node == CONTENTS_SOLID)
+				return CONTENTS_SOLID;
+			if (node == CONTENTS_SKY)
+				return CONTENTS_SKY;
+
+			if (stack_p == stack)
+				return CONTENTS_EMPTY;
+
+			// go down the far side of the last split
+			stack_p--;
+			node = stack_p->node;
+			VectorCopy(p2, p1);
+			VectorCopy(stack_p->stop, p2);
+			continue;
+		}
+
+		tnode = &tnodes[node];
+		switch (tnode->type)
+		{
+		case PLANE_X:
+			front = p1[0] - tnode->dist;
+			back = p2[0] - tnode->dist;
+			break;
+		case PLANE_Y:
+			front = p1[1] - tnode->dist;
+			back = p2[1] - tnode->dist;
+			break;
+		case PLANE_Z:
+			front = p1[2] - tnode->dist;
+			back = p2[2] - tnode->dist;
+			break;
+		default:
+			front = (p1[0] * tnode->normal[0] + p1[1] * tnode->normal[1] + p1[2] * tnode->normal[2]) - tnode->dist;
+			back = (p2[0] * tnode->normal[0] + p2[1] * tnode->normal[1] + p2[2] * tnode->normal[2]) - tnode->dist;
+			break;
+		}
+
+		if (front >= -ON_EPSILON && back >= -ON_EPSILON)
+		{
+			node = tnode->children[0];
+			continue;
+		}
+
+		if (front < ON_EPSILON && back < ON_EPSILON)
+		{
+			node = tnode->children[1];
+			continue;
+		}
+
+		side = front < 0;
+
+		frac = front / (front - back);
+
+		stack_p->node = tnode->children[!side];
+		VectorCopy(p2, stack_p->stop);
+		stack_p++;
+
+		p2[0] = p1[0] + (p2[0] - p1[0]) * frac;
+		p2[1] = p1[1] + (p2[1] - p1[1]) * frac;
+		p2[2] = p1[2] + (p2[2] - p1[2]) * frac;
+
+		node = tnode->children[side];
+	}
+}
+
+#ifdef TRACE_SSE
+
+// One entry per lane of a packet, with the lanes' points stored per axis.
+typedef struct
+{
+	__m128 start[3];
+	__m128 stop[3];
+	int node;
+	int lanes;
+} packetstack_t;
+
+// The packet stack can grow by two entries per node. Lines still being traced when it
+// runs out are finished one at a time.
+#define MAX_PACKET_STACK 256
+
+static const __m128 lanemasks[16] = {
+#define LANE(i) (((i) & 1) ? -1 : 0), (((i) & 2) ? -1 : 0), (((i) & 4) ? -1 : 0), (((i) & 8) ? -1 : 0)
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(0))), _mm_castsi128_ps(_mm_setr_epi32(LANE(1))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(2))), _mm_castsi128_ps(_mm_setr_epi32(LANE(3))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(4))), _mm_castsi128_ps(_mm_setr_epi32(LANE(5))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(6))), _mm_castsi128_ps(_mm_setr_epi32(LANE(7))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(8))), _mm_castsi128_ps(_mm_setr_epi32(LANE(9))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(10))), _mm_castsi128_ps(_mm_setr_epi32(LANE(11))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(12))), _mm_castsi128_ps(_mm_setr_epi32(LANE(13))),
+	_mm_castsi128_ps(_mm_setr_epi32(LANE(14))), _mm_castsi128_ps(_mm_setr_epi32(LANE(15))),
+#undef LANE
+};
+
+static inline __m128 SelectLanes(int lanes, __m128 a, __m128 b)
+{
+	const __m128 mask = lanemasks[lanes];
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/*
+=============
+SmallestFloatAtLeast
+
+The scalar tests compare floats against the double ON_EPSILON. These give the same
+results when comparing against floats.
+=============
+*/
+static float SmallestFloatAtLeast(double value)
+{
+	float f = (float)value;
+
+	if ((double)f < value)
+		f = nextafterf(f, 1e30f);
+
+	while ((double)nextafterf(f, -1e30f) >= value)
+		f = nextafterf(f, -1e30f);
 
-	if (node == CONTENTS_SOLID)
-		return CONTENTS_SOLID;
-	if (node == CONTENTS_SKY)
-		return CONTENTS_SKY;
-	if (node < 0)
-		return CONTENTS_EMPTY;
+	return f;
+}
+
+/*
+=============
+TestLinePacket
+
+Traces 4 lines through the tree together. Each line splits and visits nodes in the
+same order and with the same arithmetic as TestLine_r, so the results are identical.
+Lanes that need different children are split into separate stack entries.
+=============
+*/
+static void TestLinePacket(int headnode, vec3_t start, vec3_t* stops, int* results)
+{
+	static const float negepsilon = SmallestFloatAtLeast(-ON_EPSILON);
+	static const float posepsilon = SmallestFloatAtLeast(ON_EPSILON);
+
+	packetstack_t stack[MAX_PACKET_STACK];
+	packetstack_t* stack_p = stack;
+	__m128 p1[3], p2[3];
+	int node = headnode;
+	int lanes = 15;
+	int alive = 15;
+	int i;
 
-	tnode = &tnodes[node];
-	switch (tnode->type)
+	for (i = 0; i < 4; i++)
+		results[i] = CONTENTS_EMPTY;
+
+	for (i = 0; i < 3; i++)
 	{
-	case PLANE_X:
-		front = start[0] - tnode->dist;
-		back = stop[0] - tnode->dist;
-		break;
-	case PLANE_Y:
-		front = start[1] - tnode->dist;
-		back = stop[1] - tnode->dist;
-		break;
-	case PLANE_Z:
-		front = start[2] - tnode->dist;
-		back = stop[2] - tnode->dist;
-		break;
-	default:
-		front = (start[0] * tnode->normal[0] + start[1] * tnode->normal[1] + start[2] * tnode->normal[2]) - tnode->dist;
-		back = (stop[0] * tnode->normal[0] + stop[1] * tnode->normal[1] + stop[2] * tnode->normal[2]) - tnode->dist;
-		break;
+		p1[i] = _mm_set1_ps(start[i]);
+		p2[i] = _mm_setr_ps(stops[0][i], stops[1][i], stops[2][i], stops[3][i]);
 	}
 
-	if (front >= -ON_EPSILON && back >= -ON_EPSILON)
-		return TestLine_r(tnode->children[0], start, stop);
+	const __m128 negeps = _mm_set1_ps(negepsilon);
+	const __m128 poseps = _mm_set1_ps(posepsilon);
+	const __m128 zero = _mm_setzero_ps();
 
-	if (front < ON_EPSILON && back < ON_EPSILON)
-		return TestLine_r(tnode->children[1], start, stop);
+	while (1)
+	{
+		if (node < 0)
+		{
+			if (node == CONTENTS_SOLID || node == CONTENTS_SKY)
+			{
+				for (i = 0; i < 4; i++)
+				{
+					if (lanes & (1 << i))
+						results[i] = node;
+				}
+
+				alive &= ~lanes;
+			}
+
+			// find the next entry with lanes that haven't hit anything yet
+			do
+			{
+				if (stack_p == stack)
+					return;
+				stack_p--;
+				lanes = stack_p->lanes & alive;
+			} while (!lanes);
+
+			node = stack_p->node;
+			for (i = 0; i < 3; i++)
+			{
+				p1[i] = stack_p->start[i];
+				p2[i] = stack_p->stop[i];
+			}
+			continue;
+		}
 
-	side = front < 0;
+		const tnode_t* tnode = &tnodes[node];
+		const __m128 dist = _mm_set1_ps(tnode->dist);
+		__m128 front, back;
 
-	frac = front / (front - back);
+		switch (tnode->type)
+		{
+		case PLANE_X:
+		case PLANE_Y:
+		case PLANE_Z:
+			front = _mm_sub_ps(p1[tnode->type], dist);
+			back = _mm_sub_ps(p2[tnode->type], dist);
+			break;
+		default:
+		{
+			const __m128 nx = _mm_set1_ps(tnode->normal[0]);
+			const __m128 ny = _mm_set1_ps(tnode->normal[1]);
+			const __m128 nz = _mm_set1_ps(tnode->normal[2]);
+			front = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p1[0], nx), _mm_mul_ps(p1[1], ny)), _mm_mul_ps(p1[2], nz)), dist);
+			back = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p2[0], nx), _mm_mul_ps(p2[1], ny)), _mm_mul_ps(p2[2], nz)), dist);
+			break;
+		}
+		}
+
+		const int frontonly = lanes & _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(front, negeps), _mm_cmpge_ps(back, negeps)));
+		const int backonly = lanes & ~frontonly & _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(front, poseps), _mm_cmplt_ps(back, poseps)));
 
-	mid[0] = start[0] + (stop[0] - start[0]) * frac;
-	mid[1] = start[1] + (stop[1] - start[1]) * frac;
-	mid[2] = start[2] + (stop[2] - start[2]) * frac;
+		if (frontonly == lanes)
+		{
+			node = tnode->children[0];
+			continue;
+		}
+
+		if (backonly == lanes)
+		{
+			node = tnode->children[1];
+			continue;
+		}
+
+		const int split = lanes & ~(frontonly | backonly);
+		const int backfirst = split & _mm_movemask_ps(_mm_cmplt_ps(front, zero));
+		const int frontfirst = split & ~backfirst;
+
+		if (stack_p + 2 > stack + MAX_PACKET_STACK)
+		{
+			// finish the lines that are still going one at a time
+			for (i = 0; i < 4; i++)
+			{
+				if (alive & (1 << i))
+					results[i] = TestLine_r(headnode, start, stops[i]);
+			}
+			return;
+		}
+
+		const __m128 frac = _mm_div_ps(front, _mm_sub_ps(front, back));
+		__m128 mid[3];
+
+		for (i = 0; i < 3; i++)
+			mid[i] = _mm_add_ps(p1[i], _mm_mul_ps(_mm_sub_ps(p2[i], p1[i]), frac));
+
+		// lanes that go to the back first come back to the front from the split point
+		if (backfirst)
+		{
+			stack_p->node = tnode->children[0];
+			stack_p->lanes = backfirst;
+			for (i = 0; i < 3; i++)
+			{
+				stack_p->start[i] = mid[i];
+				stack_p->stop[i] = p2[i];
+			}
+			stack_p++;
+		}
+
+		// lanes that go to the back, either first, only or after the front
+		stack_p->node = tnode->children[1];
+		stack_p->lanes = backonly | split;
+		for (i = 0; i < 3; i++)
+		{
+			stack_p->start[i] = SelectLanes(frontfirst, mid[i], p1[i]);
+			stack_p->stop[i] = SelectLanes(backfirst, mid[i], p2[i]);
+		}
+		stack_p++;
+
+		// lanes that go to the front first or only
+		lanes = frontonly | frontfirst;
+
+		if (lanes)
+		{
+			for (i = 0; i < 3; i++)
+				p2[i] = SelectLanes(frontfirst, mid[i], p2[i]);
+			node = tnode->children[0];
+		}
+		else
+		{
+			// nothing goes to the front first, so take the back entry that was just pushed
+			stack_p--;
+			lanes = stack_p->lanes;
+			node = stack_p->node;
+			for (i = 0; i < 3; i++)
+			{
+				p1[i] = stack_p->start[i];
+				p2[i] = stack_p->stop[i];
+			}
+		}
+	}
+}
+
+#endif
+
+/*
+=============
+TestLines
+
+Traces lines from a shared start point, returning the same contents
+TestLine_r would for each of them. Lines are traced 4 at a time when SSE
+is available.
+=============
+*/
+void TestLines(int node, vec3_t start, vec3_t* stops, int count, int* results)
+{
+	int i = 0;
+
+#ifdef TRACE_SSE
+	for (; i + 4 <= count; i += 4)
+		TestLinePacket(node, start, stops + i, results + i);
+#endif
 
-	r = TestLine_r(tnode->children[side], start, mid);
-	if (r != CONTENTS_EMPTY)
-		return r;
-	return TestLine_r(tnode->children[!side], mid, stop);
+	for (; i < count; i++)
+		results[i] = TestLine_r(node, start, stops[i]);
 }
 
 int TestLine(vec3_t start, vec3_t stop)
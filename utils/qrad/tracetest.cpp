@@ -0,0 +1,217 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ ****/
+
+// tracetest.c
+
+// Checks TestLine_r and TestLines against the original recursive line test
+// on randomly generated trees. Returns non-zero if any line gives a different result.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+
+#include "trace.cpp"
+
+#define TEST_MAX_TNODES 3000
+#define TEST_TREES 20
+#define TEST_PACKETS 50000
+
+/*
+==============
+ReferenceTestLine_r
+
+The recursive line test that TestLine_r replaced
+==============
+*/
+static int ReferenceTestLine_r(int node, vec3_t start, vec3_t stop)
+{
+	tnode_t* tnode;
+	float front, back;
+	vec3_t mid;
+	float frac;
+	int side;
+	int r;
+
+	if (node == CONTENTS_SOLID)
+		return CONTENTS_SOLID;
+	if (node == CONTENTS_SKY)
+		return CONTENTS_SKY;
+	if (node < 0)
+		return CONTENTS_EMPTY;
+
+	tnode = &tnodes[node];
+	switch (tnode->type)
+	{
+	case PLANE_X:
+		front = start[0] - tnode->dist;
+		back = stop[0] - tnode->dist;
+		break;
+	case PLANE_Y:
+		front = start[1] - tnode->dist;
+		back = stop[1] - tnode->dist;
+		break;
+	case PLANE_Z:
+		front = start[2] - tnode->dist;
+		back = stop[2] - tnode->dist;
+		break;
+	default:
+		front = (start[0] * tnode->normal[0] + start[1] * tnode->normal[1] + start[2] * tnode->normal[2]) - tnode->dist;
+		back = (stop[0] * tnode->normal[0] + stop[1] * tnode->normal[1] + stop[2] * tnode->normal[2]) - tnode->dist;
+		break;
+	}
+
+	if (front >= -ON_EPSILON && back >= -ON_EPSILON)
+		return ReferenceTestLine_r(tnode->children[0], start, stop);
+
+	if (front < ON_EPSILON && back < ON_EPSILON)
+		return ReferenceTestLine_r(tnode->children[1], start, stop);
+
+	side = front < 0;
+
+	frac = front / (front - back);
+
+	mid[0] = start[0] + (stop[0] - start[0]) * frac;
+	mid[1] = start[1] + (stop[1] - start[1]) * frac;
+	mid[2] = start[2] + (stop[2] - start[2]) * frac;
+
+	r = ReferenceTestLine_r(tnode->children[side], start, mid);
+	if (r != CONTENTS_EMPTY)
+		return r;
+	return ReferenceTestLine_r(tnode->children[!side], mid, stop);
+}
+
+static std::mt19937 rng(1234);
+static int numtesttnodes;
+
+static float RandomFloat(float low, float high)
+{
+	return std::uniform_real_distribution<float>(low, high)(rng);
+}
+
+// Snaps some coordinates to whole units so lines often start or end exactly on axial planes
+static float RandomCoord(float low, float high)
+{
+	if (rng() % 4 == 0)
+		return (float)(int)RandomFloat(low, high);
+	return RandomFloat(low, high);
+}
+
+/*
+==============
+BuildRandomTree
+
+Returns the node or leaf contents for a random subtree
+==============
+*/
+static int BuildRandomTree(int depth)
+{
+	static const int leafcontents[] = {CONTENTS_EMPTY, CONTENTS_EMPTY, CONTENTS_SOLID, CONTENTS_SKY, CONTENTS_WATER};
+	tnode_t* t;
+	int nodenum;
+	int type;
+	int i;
+	vec3_t normal;
+
+	if (numtesttnodes >= TEST_MAX_TNODES || depth > 30 || (depth > 3 && rng() % 4 == 0))
+		return leafcontents[rng() % 5];
+
+	nodenum = numtesttnodes++;
+	t = &tnodes[nodenum];
+
+	type = rng() % 5;
+	if (type < 3)
+	{
+		t->type = type;
+		VectorCopy(vec3_origin, t->normal);
+		t->normal[type] = 1;
+		t->dist = RandomCoord(-512, 512);
+	}
+	else
+	{
+		t->type = PLANE_ANYX + rng() % 3;
+		normal[0] = RandomFloat(-1, 1);
+		normal[1] = RandomFloat(-1, 1);
+		normal[2] = RandomFloat(-1, 1);
+		VectorNormalize(normal);
+		VectorCopy(normal, t->normal);
+		t->dist = RandomFloat(-300, 300);
+	}
+
+	for (i = 0; i < 2; i++)
+		t->children[i] = BuildRandomTree(depth + 1);
+
+	return nodenum;
+}
+
+int main(int argc, char** argv)
+{
+	int tree, packet;
+	int i, j;
+	vec3_t start;
+	vec3_t stops[4];
+	int results[4];
+	int reference, single;
+	long mismatches, total;
+
+	tnodes = reinterpret_cast<tnode_t*>(calloc(TEST_MAX_TNODES + 1, sizeof(tnode_t)));
+
+	mismatches = 0;
+	total = 0;
+
+	for (tree = 0; tree < TEST_TREES; tree++)
+	{
+		numtesttnodes = 0;
+		BuildRandomTree(0);
+
+		for (packet = 0; packet < TEST_PACKETS; packet++)
+		{
+			for (i = 0; i < 3; i++)
+				start[i] = RandomCoord(-600, 600);
+
+			// some lines end close to the first one, like neighbouring sample points do
+			for (j = 0; j < 4; j++)
+			{
+				for (i = 0; i < 3; i++)
+				{
+					if (j > 0 && rng() % 3 == 0)
+						stops[j][i] = stops[0][i] + RandomFloat(-2, 2);
+					else
+						stops[j][i] = RandomCoord(-600, 600);
+				}
+			}
+
+			TestLines(0, start, stops, 4, results);
+
+			for (j = 0; j < 4; j++)
+			{
+				reference = ReferenceTestLine_r(0, start, stops[j]);
+				single = TestLine_r(0, start, stops[j]);
+
+				total++;
+
+				if (reference != single || reference != results[j])
+				{
+					if (mismatches < 10)
+					{
+						printf("tree %i: (%f %f %f) to (%f %f %f): expected %i, got %i single, %i packet\n",
+							tree, start[0], start[1], start[2], stops[j][0], stops[j][1], stops[j][2],
+							reference, single, results[j]);
+					}
+					mismatches++;
+				}
+			}
+		}
+	}
+
+	printf("%li of %li lines mismatched\n", mismatches, total);
+
+	return mismatches != 0 ? 1 : 0;
+}
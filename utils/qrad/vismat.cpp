@@ -83,6 +83,8 @@ vec_t PatchPlaneDist(patch_t* patch)
 
 
 
+#define MAX_PATCH_TESTS 32
+
 /*
 ==============
 TestPatchToFace
@@ -99,6 +101,13 @@ void TestPatchToFace(unsigned patchnum, int facenum, int head, unsigned bitpos)
 
 	if (patch2 && DotProduct(patch->origin, patch2->normal) > PatchPlaneDist(patch2) + 1.01)
 	{
+		// lines are traced in batches since they all start at the same patch
+		unsigned tested[MAX_PATCH_TESTS];
+		vec3_t stops[MAX_PATCH_TESTS];
+		int results[MAX_PATCH_TESTS];
+		int count = 0;
+		int i;
+
 		// we need to do a real test
 		for (; patch2; patch2 = patch2->next)
 		{
@@ -108,11 +117,28 @@ void TestPatchToFace(unsigned patchnum, int facenum, int head, unsigned bitpos)
 			// if bit has not already been set
 			//  && v2 is not behind light plane
 			//  && v2 is visible from v1
-			if (m > patchnum && DotProduct(patch2->origin, patch->normal) > PatchPlaneDist(patch) + 1.01 && TestLine_r(head, patch->origin, patch2->origin) == CONTENTS_EMPTY)
+			if (m > patchnum && DotProduct(patch2->origin, patch->normal) > PatchPlaneDist(patch) + 1.01)
+			{
+				tested[count] = m;
+				VectorCopy(patch2->origin, stops[count]);
+				count++;
+			}
+
+			if (count == MAX_PATCH_TESTS || (!patch2->next && count > 0))
 			{
-				// patchnum can see patch m
-				int bitset = bitpos + m;
-				vismatrix[bitset >> 3] |= 1 << (bitset & 7);
+				TestLines(head, patch->origin, stops, count, results);
+
+				for (i = 0; i < count; i++)
+				{
+					if (results[i] == CONTENTS_EMPTY)
+					{
+						// patchnum can see patch m
+						int bitset = bitpos + tested[i];
+						vismatrix[bitset >> 3] |= 1 << (bitset & 7);
+					}
+				}
+
+				count = 0;
 			}
 		}
 	}
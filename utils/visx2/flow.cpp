@@ -403,6 +403,7 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 	long *test, *might, *vis, more;
 
 	c_chains++;
+	thread->c_chains++;
 
 	leaf = &leafs[leafnum];
 	//	CheckStack (leaf, thread);
@@ -539,9 +540,10 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 ===============
 PortalFlow
 
+Returns the number of RecursiveLeafFlow calls made
 ===============
 */
-void PortalFlow(portal_t* p)
+int PortalFlow(portal_t* p)
 {
 	threaddata_t data;
 	int i;
@@ -565,6 +567,8 @@ void PortalFlow(portal_t* p)
 	RecursiveLeafFlow(p->leaf, &data, &data.pstack_head);
 
 	p->status = vstatus_t::done;
+
+	return data.c_chains;
 }
 
 
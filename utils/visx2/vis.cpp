@@ -10,6 +10,10 @@
 
 // vis.c
 
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
 #include "vis.h"
 #include "threads.h"
 
@@ -37,6 +41,18 @@ int bitbytes; // (portalleafs+63)>>3
 int bitlongs;
 
 qboolean fastvis;
+qboolean showstats;
+
+portal_t** sortedportals; // [numportals*2] in the order they are handed to threads
+
+typedef struct
+{
+	double busytime; // seconds spent in PortalFlow
+	int numportals;
+	long long numchains; // RecursiveLeafFlow calls
+} threadstats_t;
+
+std::vector<threadstats_t> threadstats;
 
 //=============================================================================
 
@@ -97,39 +113,48 @@ GetNextPortal
 Returns the next portal for a thread to work on
 Returns the portals from the least complex, so the later ones can reuse
 the earlier information.
+
+The portals are sorted by SortPortals, and the thread work counter is the
+position in that list, so no lock is needed. Threads that finish early
+take the next portal from the shared list, which keeps them all busy
+until the last few portals are handed out.
 =============
 */
 portal_t* GetNextPortal(void)
 {
-	int j;
-	portal_t *p, *tp;
-	int min;
+	portal_t* p;
 	int i;
 
 	i = GetThreadWork(); // bump the pacifier
 	if (i == -1)
 		return NULL;
 
-	ThreadLock();
+	p = sortedportals[i];
+	p->status = vstatus_t::working;
 
-	min = 99999;
-	p = NULL;
+	return p;
+}
 
-	for (j = 0, tp = portals; j < numportals * 2; j++, tp++)
-	{
-		if (tp->nummightsee < min && tp->status == vstatus_t::none)
-		{
-			min = tp->nummightsee;
-			p = tp;
-		}
-	}
+/*
+==============
+SortPortals
 
-	if (p)
-		p->status = vstatus_t::working;
+Orders the portals by nummightsee, keeping portals with the same value in
+portal order. This is the order the old linear search in GetNextPortal
+picked them in.
+==============
+*/
+void SortPortals(void)
+{
+	int i;
 
-	ThreadUnlock();
+	sortedportals = reinterpret_cast<portal_t**>(malloc(numportals * 2 * sizeof(portal_t*)));
 
-	return p;
+	for (i = 0; i < numportals * 2; i++)
+		sortedportals[i] = &portals[i];
+
+	std::stable_sort(sortedportals, sortedportals + numportals * 2, [](const portal_t* a, const portal_t* b)
+		{ return a->nummightsee < b->nummightsee; });
 }
 
 /*
@@ -137,9 +162,10 @@ portal_t* GetNextPortal(void)
 LeafThread
 ==============
 */
-void LeafThread(int /*thread*/)
+void LeafThread(int thread)
 {
 	portal_t* p;
+	int chains;
 
 	do
 	{
@@ -147,12 +173,43 @@ void LeafThread(int /*thread*/)
 		if (!p)
 			break;
 
-		PortalFlow(p);
+		const auto start = std::chrono::steady_clock::now();
+
+		chains = PortalFlow(p);
+
+		threadstats_t& stats = threadstats[thread];
+		stats.busytime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stats.numportals++;
+		stats.numchains += chains;
 
 		qprintf("portal:%4i  mightsee:%4i  cansee:%4i\n", (int)(p - portals), p->nummightsee, p->numcansee);
 	} while (1);
 }
 
+/*
+==============
+PrintThreadStats
+==============
+*/
+void PrintThreadStats(double elapsed)
+{
+	int i;
+	long long totalchains = 0;
+
+	printf("thread  portals       chains    busy\n");
+
+	for (i = 0; i < (int)threadstats.size(); i++)
+	{
+		const threadstats_t& stats = threadstats[i];
+		printf("%6i  %7i  %11lli  %5.1fs (%3.0f%%)\n", i, stats.numportals, stats.numchains, stats.busytime,
+			elapsed > 0 ? 100 * stats.busytime / elapsed : 100.0);
+		totalchains += stats.numchains;
+	}
+
+	printf("RecursiveLeafFlow calls: %lli\n", totalchains);
+	printf("%5.1f seconds in CalcPortalVis\n", elapsed);
+}
+
 /*
 ===============
 CompressRow
@@ -279,8 +336,20 @@ void CalcPortalVis(void)
 
 	leafon = 0;
 
+	SortPortals();
+
+	threadstats.assign(std::max(numthreads, 1), threadstats_t{});
+
+	const auto start = std::chrono::steady_clock::now();
+
 	RunThreadsOn(numportals * 2, true, LeafThread);
 
+	if (showstats)
+		PrintThreadStats(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+	free(sortedportals);
+	sortedportals = NULL;
+
 	qprintf("portalcheck: %i  portaltest: %i  portalpass: %i\n", c_portalcheck, c_portaltest, c_portalpass);
 	qprintf("c_vistest: %i  c_mighttest: %i\n", c_vistest, c_mighttest);
 }
@@ -460,6 +529,10 @@ int main(int argc, char** argv)
 			printf("verbose = true\n");
 			verbose = true;
 		}
+		else if (!strcmp(argv[i], "-stats"))
+		{
+			showstats = true;
+		}
 		else if (argv[i][0] == '-')
 			Error("Unknown option \"%s\"", argv[i]);
 		else
@@ -467,7 +540,7 @@ int main(int argc, char** argv)
 	}
 
 	if (i != argc - 1)
-		Error("usage: vis [-threads #] [-level 0-4] [-fast] [-v] bspfile");
+		Error("usage: vis [-threads #] [-level 0-4] [-fast] [-v] [-stats] bspfile");
 
 	start = I_FloatTime();
 
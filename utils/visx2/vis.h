@@ -105,6 +105,7 @@ typedef struct
 				   //	byte		fullportal[MAX_PORTALS/8];		// bit string
 	portal_t* base;
 	pstack_t pstack_head;
+	int c_chains; // RecursiveLeafFlow calls for this portal
 } threaddata_t;
 
 
@@ -142,6 +143,6 @@ extern int bitlongs;
 void LeafFlow(int leafnum);
 void BasePortalVis(int threadnum);
 
-void PortalFlow(portal_t* p);
+int PortalFlow(portal_t* p);
 
 void CalcAmbientSounds(void);